@@ -0,0 +1,153 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#include <algorithm>
+#include "Benchmark.h"
+#include "Sockets/Ipv4.h"
+#include "Sockets/PlatformSocket.h"
+#include "Utils/Char.h"
+#if RT_PLATFORM == RT_PLATFORM_WINDOWS
+    #include <WS2tcpip.h>
+#else
+    #include <arpa/inet.h>
+#endif
+
+namespace Rt2::Sockets::Benchmark
+{
+    namespace
+    {
+        constexpr int Addresses = 0x400;
+
+        // The split and inet_pton parse the library used before Ipv4,
+        // kept here as the baseline.
+        uint32_t legacyParse(const String& inp)
+        {
+            StringArray sa;
+            Su::splitRejectEmpty(sa, inp, '.');
+            if (sa.size() != 4)
+                return 0;
+            for (const String& octet : sa)
+            {
+                if (octet.size() > 3 || Char::toInt32(octet) > 255)
+                    return 0;
+            }
+
+            char buf[33]{};
+            inet_pton(AF_INET, inp.c_str(), buf);
+            return *(uint32_t*)&buf[0];
+        }
+
+        String legacyFormat(const uint32_t inp)
+        {
+            in_addr addr4{};
+            addr4.s_addr = inp;
+
+            char buf[32];
+            inet_ntop(AF_INET, &addr4, buf, 32);
+            return {buf};
+        }
+
+        template <typename Op>
+        Json::Dictionary measure(const int passes, Op op)
+        {
+            uint64_t check = 0;
+
+            const auto start = Clock::now();
+            for (int i = 0; i < passes; ++i)
+                check += op();
+            const double sec = secondsSince(start);
+
+            const double count = double(passes) * Addresses;
+
+            Json::Dictionary result;
+            result.insert("seconds", sec);
+            result.insert("per_sec", sec > 0 ? count / sec : 0.0);
+            result.insert("ns_per_op", count > 0 ? sec * 1e9 / count : 0.0);
+            result.insert("check", (int64_t)(check & 0x7FFFFFFF));
+            return result;
+        }
+    }  // namespace
+
+    // Parse and format throughput of Ipv4 against the split/inet_pton
+    // and inet_ntop functions it replaced.
+    void addressParse(const Report& report, const Options& opts)
+    {
+        StringArray text;
+        uint32_t    binary[Addresses];
+        for (int i = 0; i < Addresses; ++i)
+        {
+            const Ipv4 addr((uint8_t)(10 + i % 3),
+                            (uint8_t)(i * 7),
+                            (uint8_t)(i * 13 + 1),
+                            (uint8_t)(i * 31 + 2));
+            text.push_back(addr.toString());
+            binary[i] = addr.network();
+        }
+
+        const int passes = std::max(1, opts.iterations / 10);
+
+        Json::Dictionary result;
+        result.insert("addresses", Addresses);
+        result.insert("passes", passes);
+        result.insert("parse_legacy",
+                      measure(passes,
+                              [&text]
+                              {
+                                  uint64_t sum = 0;
+                                  for (const String& s : text)
+                                      sum += legacyParse(s);
+                                  return sum;
+                              }));
+        result.insert("parse_ipv4",
+                      measure(passes,
+                              [&text]
+                              {
+                                  uint64_t sum = 0;
+                                  for (const String& s : text)
+                                  {
+                                      Ipv4 addr;
+                                      if (Ipv4::parse(s, addr))
+                                          sum += addr.network();
+                                  }
+                                  return sum;
+                              }));
+        result.insert("format_legacy",
+                      measure(passes,
+                              [&binary]
+                              {
+                                  uint64_t sum = 0;
+                                  for (const uint32_t v : binary)
+                                      sum += legacyFormat(v).size();
+                                  return sum;
+                              }));
+        result.insert("format_ipv4",
+                      measure(passes,
+                              [&binary]
+                              {
+                                  uint64_t sum = 0;
+                                  for (const uint32_t v : binary)
+                                      sum += Ipv4::fromNetwork(v).text().size;
+                                  return sum;
+                              }));
+        report.add("ipv4", result);
+    }
+
+}  // namespace Rt2::Sockets::Benchmark
@@ -0,0 +1,143 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#include "Benchmark.h"
+#include <algorithm>
+#include <cstdio>
+#include <ctime>
+#include <numeric>
+#include "Utils/Definitions.h"
+#if RT_PLATFORM != RT_PLATFORM_WINDOWS
+    #include <sys/resource.h>
+    #include <unistd.h>
+#endif
+
+namespace Rt2::Sockets::Benchmark
+{
+    LatencyRecorder::LatencyRecorder(const size_t reserve)
+    {
+        _samples.reserve(reserve);
+    }
+
+    void LatencyRecorder::record(const int64_t nanoseconds)
+    {
+        _samples.push_back(nanoseconds);
+        _sorted = false;
+    }
+
+    void LatencyRecorder::record(const Clock::time_point& start)
+    {
+        record(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+    }
+
+    int64_t LatencyRecorder::percentile(const double pct)
+    {
+        RT_GUARD_RET(!_samples.empty(), 0)
+        if (!_sorted)
+        {
+            std::sort(_samples.begin(), _samples.end());
+            _sorted = true;
+        }
+
+        const double rank = pct / 100.0 * double(_samples.size() - 1);
+        return _samples[Clamp<size_t>((size_t)(rank + 0.5), 0, _samples.size() - 1)];
+    }
+
+    double LatencyRecorder::mean() const
+    {
+        RT_GUARD_RET(!_samples.empty(), 0)
+        const double sum = std::accumulate(_samples.begin(), _samples.end(), 0.0);
+        return sum / double(_samples.size());
+    }
+
+    Json::Dictionary LatencyRecorder::toJson()
+    {
+        Json::Dictionary dict;
+        dict.insert("samples", (int64_t)_samples.size());
+        dict.insert("mean_ns", mean());
+        dict.insert("min_ns", percentile(0));
+        dict.insert("p50_ns", percentile(50));
+        dict.insert("p90_ns", percentile(90));
+        dict.insert("p99_ns", percentile(99));
+        dict.insert("p999_ns", percentile(99.9));
+        dict.insert("max_ns", percentile(100));
+        return dict;
+    }
+
+    void Report::add(const String& name, const Json::Dictionary& result) const
+    {
+        Json::Dictionary entry;
+        entry.insert("name", name);
+        entry.insert("result", result);
+        _scenarios.push(entry);
+    }
+
+    String Report::formatted() const
+    {
+        Json::Dictionary root;
+        root.insert("suite", String("SocketsBenchmark"));
+        root.insert("scenarios", _scenarios);
+        return root.formatted();
+    }
+
+    double secondsSince(const Clock::time_point& start)
+    {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    int64_t residentBytes()
+    {
+        int64_t bytes = 0;
+#if RT_PLATFORM != RT_PLATFORM_WINDOWS
+        if (FILE* fp = fopen("/proc/self/statm", "r"))
+        {
+            long size = 0, resident = 0;
+            if (fscanf(fp, "%ld %ld", &size, &resident) == 2)
+                bytes = (int64_t)resident * sysconf(_SC_PAGESIZE);
+            fclose(fp);
+        }
+#endif
+        return bytes;
+    }
+
+    double threadCpuSeconds()
+    {
+#if RT_PLATFORM != RT_PLATFORM_WINDOWS
+        timespec ts{};
+        if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) == 0)
+            return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+#endif
+        return (double)std::clock() / CLOCKS_PER_SEC;
+    }
+
+    void raiseDescriptorLimit(const int needed)
+    {
+#if RT_PLATFORM != RT_PLATFORM_WINDOWS
+        rlimit lim{};
+        if (getrlimit(RLIMIT_NOFILE, &lim) == 0 && lim.rlim_cur < (rlim_t)needed)
+        {
+            lim.rlim_cur = std::min<rlim_t>((rlim_t)needed, lim.rlim_max);
+            setrlimit(RLIMIT_NOFILE, &lim);
+        }
+#endif
+    }
+
+}  // namespace Rt2::Sockets::Benchmark
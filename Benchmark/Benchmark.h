@@ -0,0 +1,122 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#pragma once
+#include <chrono>
+#include <vector>
+#include "Utils/Json.h"
+#include "Utils/String.h"
+
+namespace Rt2::Sockets::Benchmark
+{
+    using Clock = std::chrono::steady_clock;
+
+    constexpr uint16_t Port = 8181;
+
+    struct Options
+    {
+        int connections{10000};
+        int iterations{20000};
+        int megabytes{256};
+        int idle{1000};
+        int messageSize{64};
+        int workers{8};
+        int subscribers{100};
+    };
+
+    class LatencyRecorder
+    {
+    private:
+        std::vector<int64_t> _samples;
+        bool                 _sorted{false};
+
+    public:
+        explicit LatencyRecorder(size_t reserve = 0);
+
+        void record(int64_t nanoseconds);
+
+        void record(const Clock::time_point& start);
+
+        size_t count() const;
+
+        int64_t percentile(double pct);
+
+        double mean() const;
+
+        Json::Dictionary toJson();
+    };
+
+    class Report
+    {
+    private:
+        Json::MixedArray _scenarios;
+
+    public:
+        Report() = default;
+
+        void add(const String& name, const Json::Dictionary& result) const;
+
+        String formatted() const;
+    };
+
+    double secondsSince(const Clock::time_point& start);
+
+    int64_t residentBytes();
+
+    // CPU time consumed by the calling thread.
+    double threadCpuSeconds();
+
+    void raiseDescriptorLimit(int needed);
+
+    void connectionRate(const Report& report, const Options& opts);
+
+    void bulkThroughput(const Report& report, const Options& opts);
+
+    void pingPong(const Report& report, const Options& opts);
+
+    void idleConnections(const Report& report, const Options& opts);
+
+    void headerScan(const Report& report, const Options& opts);
+
+    void httpLoad(const Report& report, const Options& opts);
+
+    void wsFanout(const Report& report, const Options& opts);
+
+    void zeroCopySend(const Report& report, const Options& opts);
+
+    void addressParse(const Report& report, const Options& opts);
+
+    void pipelined(const Report& report, const Options& opts);
+
+    void muxStreams(const Report& report, const Options& opts);
+
+    void sharedMemory(const Report& report, const Options& opts);
+
+    void memoryPipe(const Report& report, const Options& opts);
+
+    void busyPoll(const Report& report, const Options& opts);
+
+    inline size_t LatencyRecorder::count() const
+    {
+        return _samples.size();
+    }
+
+}  // namespace Rt2::Sockets::Benchmark
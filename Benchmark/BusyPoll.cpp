@@ -0,0 +1,112 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#include "Benchmark.h"
+#include "Sockets/BusyPoller.h"
+#include "Sockets/ClientSocket.h"
+#include "Sockets/ServerSocket.h"
+
+namespace Rt2::Sockets::Benchmark
+{
+    namespace
+    {
+        // Waits in Net::receive, or spins first when a poller is given.
+        bool readExactly(const PlatformSocket& sock, char* dest, const int size, BusyPoller* poller)
+        {
+            int total = 0;
+            while (total < size)
+            {
+                int          br = 0;
+                const Status st = poller
+                                      ? poller->receive(sock, dest + total, size - total, br)
+                                      : Net::receive(sock, dest + total, size - total, br, Default::SocketTimeOut);
+                if (st != OkStatus)
+                    return false;
+                total += br;
+            }
+            return true;
+        }
+
+        Json::Dictionary run(const bool busy, const Options& opts)
+        {
+            SocketConfig config;
+            config.profile = ProfileLowLatency;
+            if (busy)
+                config.busyPoll = Default::BusyPollBudget;
+
+            Json::Dictionary result;
+
+            ServerSocket ss("127.0.0.1", Port, config);
+            if (!ss.isValid())
+                return result;
+
+            const int size = opts.messageSize;
+            ss.connect(
+                [size, busy](const PlatformSocket& sock)
+                {
+                    BusyPoller poller;
+                    String     scratch((size_t)size, 0);
+                    while (readExactly(sock, scratch.data(), size, busy ? &poller : nullptr))
+                        Net::writeSocket(sock, scratch.data(), (size_t)size, Default::SocketTimeOut);
+                });
+
+            LatencyRecorder latency((size_t)opts.iterations);
+            BusyPoller      poller;
+
+            String message((size_t)size, 'p'), reply((size_t)size, 0);
+
+            const ClientSocket cs("127.0.0.1", Port, config);
+            const double       cpuStart = threadCpuSeconds();
+            const auto         start    = Clock::now();
+            for (int i = 0; i < opts.iterations; ++i)
+            {
+                const auto begin = Clock::now();
+                cs.write(message);
+                if (!readExactly(cs.socket(), reply.data(), size, busy ? &poller : nullptr))
+                    break;
+                latency.record(begin);
+            }
+            const double sec = secondsSince(start);
+            const double cpu = threadCpuSeconds() - cpuStart;
+            ss.stop();
+
+            result.insert("busy_poll", busy);
+            result.insert("so_busy_poll", cs.busyPoll());
+            result.insert("message_size", size);
+            result.insert("round_trips", (int64_t)latency.count());
+            result.insert("round_trips_per_sec", sec > 0 ? double(latency.count()) / sec : 0.0);
+            result.insert("client_cpu_seconds", cpu);
+            result.insert("spin_hits", (int64_t)poller.hits());
+            result.insert("spin_misses", (int64_t)poller.misses());
+            result.insert("latency", latency.toJson());
+            return result;
+        }
+    }  // namespace
+
+    // Echo round trips with the receive side waiting in select, then
+    // spinning first with BusyPoller and SO_BUSY_POLL set.
+    void busyPoll(const Report& report, const Options& opts)
+    {
+        report.add("busy-poll-off", run(false, opts));
+        report.add("busy-poll-on", run(true, opts));
+    }
+
+}  // namespace Rt2::Sockets::Benchmark
@@ -0,0 +1,81 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#include <atomic>
+#include "Benchmark.h"
+#include "Sockets/ServerSocket.h"
+#include "Thread/Thread.h"
+
+namespace Rt2::Sockets::Benchmark
+{
+    // Opens a burst of connections as fast as possible and measures
+    // how quickly the server accepts them.
+    void connectionRate(const Report& report, const Options& opts)
+    {
+        std::atomic<int> accepted{0};
+
+        ServerSocket ss("127.0.0.1", Port);
+        if (!ss.isValid())
+            return;
+
+        ss.connect([&accepted](const PlatformSocket&)
+                   { ++accepted; });
+
+        LatencyRecorder connectTime((size_t)opts.connections);
+
+        const auto start  = Clock::now();
+        int        failed = 0;
+        for (int i = 0; i < opts.connections; ++i)
+        {
+            const auto           begin = Clock::now();
+            const PlatformSocket sock  = Net::create(AddressFamilyINet, SocketStream, ProtocolIpTcp);
+            if (Net::connect(sock, "127.0.0.1", Port) != OkStatus)
+                ++failed;
+            else
+                connectTime.record(begin);
+
+            // The handshake is complete once connect returns, so the
+            // client side can be released while the server catches up.
+            Net::close(sock);
+        }
+
+        const int expected = opts.connections - failed;
+        while (accepted < expected)
+        {
+            if (Clock::now() - start > std::chrono::seconds(30))
+                break;
+            Thread::Thread::yield();
+        }
+
+        const double sec = secondsSince(start);
+        ss.stop();
+
+        Json::Dictionary result;
+        result.insert("connections", opts.connections);
+        result.insert("accepted", accepted.load());
+        result.insert("failed", failed);
+        result.insert("seconds", sec);
+        result.insert("accepts_per_sec", sec > 0 ? double(accepted) / sec : 0.0);
+        result.insert("connect_latency", connectTime.toJson());
+        report.add("connection-rate", result);
+    }
+
+}  // namespace Rt2::Sockets::Benchmark
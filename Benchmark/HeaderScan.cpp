@@ -0,0 +1,128 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#include <sstream>
+#include "Benchmark.h"
+#include "Sockets/Simd.h"
+
+namespace Rt2::Sockets::Benchmark
+{
+    namespace
+    {
+        const char* const Request =
+            "GET /api/v1/items?page=2&limit=50 HTTP/1.1\r\n"
+            "Host: localhost:8181\r\n"
+            "User-Agent: Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 (KHTML, like Gecko)\r\n"
+            "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,*/*;q=0.8\r\n"
+            "Accept-Language: en-US,en;q=0.5\r\n"
+            "Accept-Encoding: gzip, deflate, br\r\n"
+            "Cookie: session=6f1c3e2a9b7d4c5e8f0a1b2c3d4e5f60; theme=dark\r\n"
+            "Connection: keep-alive\r\n"
+            "Cache-Control: max-age=0\r\n"
+            "\r\n";
+
+        // Splits every line with std::getline, the way callers of the
+        // stream classes tokenize headers.
+        size_t scanStream(const String& corpus)
+        {
+            std::istringstream stream(corpus);
+
+            size_t lines = 0;
+            String line;
+            while (std::getline(stream, line))
+                ++lines;
+            return lines;
+        }
+
+        // Splits every request at the blank line, then each header at
+        // the line feed, using the active kernels.
+        size_t scanSimd(const String& corpus)
+        {
+            const char* pos = corpus.data();
+            const char* end = pos + corpus.size();
+
+            size_t lines = 0;
+            while (pos < end)
+            {
+                const char* head = Simd::find(pos, end, "\r\n\r\n");
+                if (head == end)
+                    break;
+                head += 2;
+
+                while (pos < head)
+                {
+                    pos = Simd::find(pos, head, '\n') + 1;
+                    ++lines;
+                }
+                pos += 2;
+                ++lines;
+            }
+            return lines;
+        }
+
+        template <typename Scan>
+        Json::Dictionary measure(const String& corpus, const int passes, Scan scan)
+        {
+            size_t lines = 0;
+
+            const auto   start = Clock::now();
+            for (int i = 0; i < passes; ++i)
+                lines += scan(corpus);
+            const double sec = secondsSince(start);
+
+            const double bytes = double(corpus.size()) * passes;
+
+            Json::Dictionary result;
+            result.insert("lines", (int64_t)lines);
+            result.insert("seconds", sec);
+            result.insert("mib_per_sec", sec > 0 ? bytes / sec / double(1 << 20) : 0.0);
+            result.insert("lines_per_sec", sec > 0 ? double(lines) / sec : 0.0);
+            return result;
+        }
+    }  // namespace
+
+    // Compares header tokenization throughput of std::getline against
+    // each delimiter-search kernel the processor supports.
+    void headerScan(const Report& report, const Options& opts)
+    {
+        String corpus;
+        while (corpus.size() < 0x400000)
+            corpus.append(Request);
+
+        const int passes = opts.megabytes > 0 ? opts.megabytes / 4 + 1 : 1;
+
+        Json::Dictionary result;
+        result.insert("corpus_bytes", (int64_t)corpus.size());
+        result.insert("passes", passes);
+        result.insert("istream", measure(corpus, passes, scanStream));
+
+        const Simd::Level active = Simd::level();
+        for (int lvl = Simd::Scalar; lvl <= Simd::supported(); ++lvl)
+        {
+            Simd::setLevel((Simd::Level)lvl);
+            result.insert(Simd::toString((Simd::Level)lvl), measure(corpus, passes, scanSimd));
+        }
+        Simd::setLevel(active);
+
+        report.add("header-scan", result);
+    }
+
+}  // namespace Rt2::Sockets::Benchmark
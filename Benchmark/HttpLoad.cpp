@@ -0,0 +1,160 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#include <thread>
+#include "Benchmark.h"
+#include "Sockets/ClientSocket.h"
+#include "Sockets/HttpServer.h"
+#include "Sockets/RecvBuffer.h"
+
+namespace Rt2::Sockets::Benchmark
+{
+    namespace
+    {
+        constexpr int PipelineDepth = 16;
+
+        const std::string_view Request =
+            "GET /plaintext HTTP/1.1\r\n"
+            "Host: 127.0.0.1\r\n"
+            "User-Agent: SocketsBenchmark\r\n"
+            "Accept: */*\r\n"
+            "\r\n";
+
+        bool readResponse(RecvBuffer& buf, const PlatformSocket& sock)
+        {
+            std::string_view head;
+            if (buf.readUntil(sock, "\r\n\r\n", head) != OkStatus)
+                return false;
+
+            constexpr std::string_view field = "Content-Length: ";
+
+            size_t length = 0;
+            if (const size_t pos = head.find(field); pos != std::string_view::npos)
+            {
+                for (size_t i = pos + field.size(); i < head.size() && head[i] >= '0' && head[i] <= '9'; ++i)
+                    length = length * 10 + (size_t)(head[i] - '0');
+            }
+
+            while (buf.size() < length)
+            {
+                if (buf.fill(sock) != OkStatus)
+                    return false;
+            }
+            buf.consume(length);
+            return true;
+        }
+
+        // Each worker keeps one connection open and sends depth
+        // requests per write, timing every batch.
+        Json::Dictionary load(const Options& opts, const int depth)
+        {
+            const int workers  = opts.workers > 0 ? opts.workers : 1;
+            const int requests = opts.iterations / depth * depth;
+
+            String batch;
+            for (int i = 0; i < depth; ++i)
+                batch.append(Request.data(), Request.size());
+
+            std::vector<std::vector<int64_t>> samples((size_t)workers);
+            std::vector<int>                  completed((size_t)workers, 0);
+            std::vector<std::thread>          threads;
+
+            SocketConfig config;
+            config.profile = ProfileLowLatency;
+
+            const auto start = Clock::now();
+            for (int w = 0; w < workers; ++w)
+            {
+                threads.emplace_back(
+                    [&, w]
+                    {
+                        const ClientSocket cs("127.0.0.1", Port, config);
+                        RecvBuffer         buf;
+
+                        samples[(size_t)w].reserve((size_t)(requests / depth));
+                        for (int i = 0; i < requests; i += depth)
+                        {
+                            const auto begin = Clock::now();
+                            Net::writeSocket(cs.socket(), batch.data(), batch.size(), Default::SocketTimeOut);
+                            for (int r = 0; r < depth; ++r)
+                            {
+                                if (!readResponse(buf, cs.socket()))
+                                    return;
+                                ++completed[(size_t)w];
+                            }
+                            samples[(size_t)w].push_back(
+                                std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - begin).count());
+                        }
+                    });
+            }
+            for (std::thread& th : threads)
+                th.join();
+            const double sec = secondsSince(start);
+
+            LatencyRecorder latency;
+            int64_t         total = 0;
+            for (int w = 0; w < workers; ++w)
+            {
+                total += completed[(size_t)w];
+                for (const int64_t ns : samples[(size_t)w])
+                    latency.record(ns);
+            }
+
+            Json::Dictionary result;
+            result.insert("connections", workers);
+            result.insert("pipeline_depth", depth);
+            result.insert("requests", total);
+            result.insert("seconds", sec);
+            result.insert("requests_per_sec", sec > 0 ? double(total) / sec : 0.0);
+            result.insert("batch_latency", latency.toJson());
+            return result;
+        }
+    }  // namespace
+
+    // Loopback load in the spirit of wrk: a fixed set of keep-alive
+    // connections hammering a plaintext endpoint, first one request at
+    // a time and then pipelined.
+    void httpLoad(const Report& report, const Options& opts)
+    {
+        SocketConfig config;
+        config.profile = ProfileLowLatency;
+
+        HttpServer server(
+            "127.0.0.1",
+            Port,
+            [](const HttpRequest&, HttpResponse& res)
+            {
+                res.setHeader("Content-Type", "text/plain");
+                res.setBody(std::string_view("Hello, World!"));
+            },
+            config);
+        if (!server.isValid())
+            return;
+
+        Json::Dictionary result;
+        result.insert("keep_alive", load(opts, 1));
+        result.insert("pipelined", load(opts, PipelineDepth));
+        server.stop();
+
+        report.add("http", result);
+    }
+
+}  // namespace Rt2::Sockets::Benchmark
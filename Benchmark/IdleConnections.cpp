@@ -0,0 +1,87 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#include <atomic>
+#include <memory>
+#include "Benchmark.h"
+#include "Sockets/ClientSocket.h"
+#include "Sockets/ServerSocket.h"
+#include "Thread/Thread.h"
+
+namespace Rt2::Sockets::Benchmark
+{
+    // Holds many idle connections open at once and reports how much
+    // resident memory each one costs the process, client and server
+    // side combined.
+    void idleConnections(const Report& report, const Options& opts)
+    {
+        raiseDescriptorLimit(2 * opts.idle + 64);
+
+        std::atomic<int>  waiting{0};
+        std::atomic<bool> release{false};
+
+        ServerSocket ss("127.0.0.1", Port);
+        if (!ss.isValid())
+            return;
+
+        ss.connect(
+            [&waiting, &release](const PlatformSocket&)
+            {
+                ++waiting;
+                while (!release)
+                    Thread::Thread::sleep(10);
+                --waiting;
+            });
+
+        const int64_t before = residentBytes();
+
+        std::vector<std::unique_ptr<ClientSocket>> clients;
+        clients.reserve((size_t)opts.idle);
+        for (int i = 0; i < opts.idle; ++i)
+        {
+            auto cs = std::make_unique<ClientSocket>("127.0.0.1", Port);
+            if (!cs->isValid())
+                break;
+            clients.push_back(std::move(cs));
+        }
+
+        const auto start = Clock::now();
+        while (waiting < (int)clients.size() && secondsSince(start) < 30)
+            Thread::Thread::sleep(10);
+
+        const int64_t after = residentBytes();
+        const int     open  = waiting.load();
+
+        release = true;
+        clients.clear();
+        while (waiting > 0 && secondsSince(start) < 60)
+            Thread::Thread::sleep(10);
+        ss.stop();
+
+        Json::Dictionary result;
+        result.insert("connections", open);
+        result.insert("rss_before", before);
+        result.insert("rss_after", after);
+        result.insert("bytes_per_connection", open > 0 ? double(after - before) / double(open) : 0.0);
+        report.add("idle-connections", result);
+    }
+
+}  // namespace Rt2::Sockets::Benchmark
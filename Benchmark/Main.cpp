@@ -0,0 +1,174 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#include <fstream>
+#include "Benchmark.h"
+#include "Sockets/Metrics.h"
+#include "Utils/Char.h"
+#include "Utils/Console.h"
+
+using namespace Rt2;
+using namespace Sockets::Benchmark;
+
+namespace
+{
+    void usage()
+    {
+        Console::println("SocketsBenchmark [options] [scenario ...]");
+        Console::println();
+        Console::println("Scenarios:");
+        Console::println("  connection-rate   accepts/sec under a connect burst");
+        Console::println("  bulk-throughput   loopback transfer, legacy vs autotuned buffers");
+        Console::println("  ping-pong         echo round-trip latency percentiles");
+        Console::println("  idle-connections  resident memory per idle connection");
+        Console::println("  header-scan       header tokenization, getline vs SIMD kernels");
+        Console::println("  http              keep-alive and pipelined HttpServer load");
+        Console::println("  ws-fanout         WebSocket publish to many subscribers");
+        Console::println("  zerocopy          sender CPU per GiB, copy vs MSG_ZEROCOPY");
+        Console::println("  ipv4              address parse/format, inet_pton/ntop vs Ipv4");
+        Console::println("  pipeline          framed requests per second by in-flight window");
+        Console::println("  mux-streams       resident memory per stream over one connection");
+        Console::println("  shm               same-host round trips and bulk, TCP vs Unix vs shared memory");
+        Console::println("  memory-pipe       Net round trips and bulk on the in-memory backend");
+        Console::println("  busy-poll         echo round-trip latency with busy polling off and on");
+        Console::println();
+        Console::println("Options:");
+        Console::println("  -o <file>         write the JSON report to a file");
+        Console::println("  -c <count>        connections for connection-rate");
+        Console::println("  -n <count>        iterations for ping-pong, ipv4, pipeline, shm, memory-pipe and busy-poll, requests per connection for http");
+        Console::println("  -m <MiB>          megabytes for bulk-throughput, header-scan, zerocopy, shm and memory-pipe");
+        Console::println("  -i <count>        connections for idle-connections, streams for mux-streams");
+        Console::println("  -s <bytes>        message size for ping-pong, pipeline, shm, memory-pipe and busy-poll");
+        Console::println("  -w <count>        connections for http");
+        Console::println("  -u <count>        subscribers for ws-fanout");
+        Console::println("  --metrics         enable library metrics and include them in the report");
+    }
+}  // namespace
+
+int main(int argc, char** argv)
+{
+    Options     opts;
+    String      output;
+    StringArray scenarios;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const String arg = argv[i];
+        const bool   more = i + 1 < argc;
+
+        if (arg == "-h" || arg == "--help")
+        {
+            usage();
+            return 0;
+        }
+        if (arg == "-o" && more)
+            output = argv[++i];
+        else if (arg == "-c" && more)
+            opts.connections = Char::toInt32(argv[++i]);
+        else if (arg == "-n" && more)
+            opts.iterations = Char::toInt32(argv[++i]);
+        else if (arg == "-m" && more)
+            opts.megabytes = Char::toInt32(argv[++i]);
+        else if (arg == "-i" && more)
+            opts.idle = Char::toInt32(argv[++i]);
+        else if (arg == "-s" && more)
+            opts.messageSize = Char::toInt32(argv[++i]);
+        else if (arg == "-w" && more)
+            opts.workers = Char::toInt32(argv[++i]);
+        else if (arg == "-u" && more)
+            opts.subscribers = Char::toInt32(argv[++i]);
+        else if (arg == "--metrics")
+            Sockets::Metrics::setEnabled(true);
+        else
+            scenarios.push_back(arg);
+    }
+
+    if (scenarios.empty())
+    {
+        scenarios = {
+            "connection-rate",
+            "bulk-throughput",
+            "ping-pong",
+            "idle-connections",
+            "header-scan",
+            "http",
+            "ws-fanout",
+            "zerocopy",
+            "ipv4",
+            "pipeline",
+            "mux-streams",
+            "shm",
+            "memory-pipe",
+            "busy-poll",
+        };
+    }
+
+    const Report report;
+    for (const String& name : scenarios)
+    {
+        if (name == "connection-rate")
+            connectionRate(report, opts);
+        else if (name == "bulk-throughput")
+            bulkThroughput(report, opts);
+        else if (name == "ping-pong")
+            pingPong(report, opts);
+        else if (name == "idle-connections")
+            idleConnections(report, opts);
+        else if (name == "header-scan")
+            headerScan(report, opts);
+        else if (name == "http")
+            httpLoad(report, opts);
+        else if (name == "ws-fanout")
+            wsFanout(report, opts);
+        else if (name == "zerocopy")
+            zeroCopySend(report, opts);
+        else if (name == "ipv4")
+            addressParse(report, opts);
+        else if (name == "pipeline")
+            pipelined(report, opts);
+        else if (name == "mux-streams")
+            muxStreams(report, opts);
+        else if (name == "shm")
+            sharedMemory(report, opts);
+        else if (name == "memory-pipe")
+            memoryPipe(report, opts);
+        else if (name == "busy-poll")
+            busyPoll(report, opts);
+        else
+        {
+            Console::println("unknown scenario ", name);
+            usage();
+            return 1;
+        }
+    }
+
+    if (Sockets::Metrics::enabled())
+        report.add("metrics", Sockets::Metrics::toJson());
+
+    if (output.empty())
+        Console::println(report.formatted());
+    else
+    {
+        std::ofstream fp(output);
+        fp << report.formatted() << std::endl;
+    }
+    return 0;
+}
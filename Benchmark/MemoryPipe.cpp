@@ -0,0 +1,143 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#include <algorithm>
+#include <thread>
+#include "Benchmark.h"
+#include "Sockets/MemoryBackend.h"
+
+namespace Rt2::Sockets::Benchmark
+{
+    namespace
+    {
+        bool readExactly(const PlatformSocket& sock, char* dest, const int size)
+        {
+            int total = 0;
+            while (total < size)
+            {
+                int br = 0;
+                if (Net::receive(sock, dest + total, size - total, br, Default::SocketTimeOut) != OkStatus)
+                    return false;
+                total += br;
+            }
+            return true;
+        }
+
+        void echo(const PlatformSocket& sock, const int size)
+        {
+            String scratch((size_t)size, 0);
+            while (readExactly(sock, scratch.data(), size))
+                Net::writeSocket(sock, scratch.data(), (size_t)size, Default::SocketTimeOut);
+            Net::close(sock);
+        }
+
+        // Reads until the writer closes, then answers with one byte.
+        void sink(const PlatformSocket& sock)
+        {
+            String scratch(0x10000, 0);
+            int    br = 0;
+            while (Net::receive(sock, scratch.data(), (int)scratch.size(), br, Default::SocketTimeOut) == OkStatus)
+                ;
+            Net::close(sock);
+        }
+
+        Json::Dictionary run(MemoryBackend& memory, const PipeConfig& config, const Options& opts)
+        {
+            Json::Dictionary result;
+            result.insert("latency_us", (int64_t)config.latency.count());
+            result.insert("bandwidth", (int64_t)config.bandwidth);
+
+            // round trips with the same handler ping-pong runs on TCP
+            PlatformSocket client, server;
+            memory.pair(client, server, config);
+            std::thread handler(echo, server, opts.messageSize);
+
+            LatencyRecorder latency((size_t)opts.iterations);
+
+            String message((size_t)opts.messageSize, 'p'), reply((size_t)opts.messageSize, 0);
+
+            auto start = Clock::now();
+            for (int i = 0; i < opts.iterations; ++i)
+            {
+                const auto begin = Clock::now();
+                Net::writeSocket(client, message.data(), message.size(), Default::SocketTimeOut);
+                if (!readExactly(client, reply.data(), opts.messageSize))
+                    break;
+                latency.record(begin);
+            }
+            double sec = secondsSince(start);
+            Net::close(client);
+            handler.join();
+
+            result.insert("round_trips", (int64_t)latency.count());
+            result.insert("round_trips_per_sec", sec > 0 ? double(latency.count()) / sec : 0.0);
+            result.insert("latency", latency.toJson());
+
+            // bulk transfer until the reader has seen the last byte
+            memory.pair(client, server, config);
+            handler = std::thread(sink, server);
+
+            const size_t total = (size_t)opts.megabytes << 20;
+            const String chunk(0x10000, 'b');
+
+            start       = Clock::now();
+            size_t sent = 0;
+            while (sent < total)
+            {
+                const size_t n  = std::min(chunk.size(), total - sent);
+                const int    bw = Net::writeSocket(client, chunk.data(), n, Default::SocketTimeOut);
+                if (bw <= 0)
+                    break;
+                sent += (size_t)bw;
+            }
+            Net::close(client);
+            handler.join();
+            sec = secondsSince(start);
+
+            result.insert("bytes", (int64_t)sent);
+            result.insert("mb_per_sec", sec > 0 ? double(sent) / double(1 << 20) / sec : 0.0);
+            return result;
+        }
+    }  // namespace
+
+    // Net's send and receive paths with the kernel taken out: once as
+    // fast as memory allows, and once through a modelled link to check
+    // that the measured latency and rate follow the model.
+    void memoryPipe(const Report& report, const Options& opts)
+    {
+        MemoryBackend memory;
+        Net::setBackend(&memory);
+
+        report.add("memory-pipe", run(memory, {}, opts));
+
+        PipeConfig link;
+        link.latency   = std::chrono::microseconds(50);
+        link.bandwidth = 100ull << 20;
+
+        Options modelled    = opts;
+        modelled.iterations = std::min(opts.iterations, 2000);
+        modelled.megabytes  = std::min(opts.megabytes, 64);
+        report.add("memory-pipe-modelled", run(memory, link, modelled));
+
+        Net::setBackend(nullptr);
+    }
+
+}  // namespace Rt2::Sockets::Benchmark
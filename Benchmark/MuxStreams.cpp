@@ -0,0 +1,112 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#include <atomic>
+#include "Benchmark.h"
+#include "Sockets/ClientSocket.h"
+#include "Sockets/Multiplexer.h"
+#include "Sockets/ServerSocket.h"
+#include "Thread/Thread.h"
+
+namespace Rt2::Sockets::Benchmark
+{
+    // The idle-connections measurement for streams over a single
+    // connection: opens as many streams, exchanges one message on each
+    // so both ends hold state, and reports resident memory per stream.
+    void muxStreams(const Report& report, const Options& opts)
+    {
+        std::atomic<int>  accepted{0};
+        std::atomic<bool> release{false};
+
+        ServerSocket ss("127.0.0.1", Port);
+        if (!ss.isValid())
+            return;
+
+        ss.connect(
+            [&accepted, &release, &opts](const PlatformSocket& sock)
+            {
+                Multiplexer mux(sock, false);
+                mux.setBacklog((size_t)opts.idle);
+
+                std::vector<MuxStreamPtr> held;
+                held.reserve((size_t)opts.idle);
+
+                while (!release && (int)held.size() < opts.idle)
+                {
+                    if (MuxStreamPtr stream = mux.accept(100))
+                    {
+                        char   c = 0;
+                        size_t n = 0;
+                        if (stream->receive(&c, 1, n) == OkStatus)
+                            stream->send({&c, 1});
+                        held.push_back(std::move(stream));
+                        ++accepted;
+                    }
+                }
+                while (!release)
+                    Thread::Thread::sleep(10);
+            });
+
+        const int64_t before = residentBytes();
+
+        const ClientSocket cs("127.0.0.1", Port);
+        Multiplexer        mux(cs.socket(), true);
+
+        std::vector<MuxStreamPtr> streams;
+        streams.reserve((size_t)opts.idle);
+
+        const auto start = Clock::now();
+        for (int i = 0; i < opts.idle; ++i)
+        {
+            MuxStreamPtr stream = mux.open();
+            if (!stream || stream->send("x") != OkStatus)
+                break;
+            streams.push_back(std::move(stream));
+        }
+
+        int open = 0;
+        for (const MuxStreamPtr& stream : streams)
+        {
+            char   c = 0;
+            size_t n = 0;
+            if (stream->receive(&c, 1, n) == OkStatus)
+                ++open;
+        }
+        const double sec = secondsSince(start);
+
+        const int64_t after = residentBytes();
+
+        release = true;
+        mux.close();
+        ss.stop();
+
+        Json::Dictionary result;
+        result.insert("streams", open);
+        result.insert("accepted", accepted.load());
+        result.insert("descriptors", 2);
+        result.insert("seconds", sec);
+        result.insert("rss_before", before);
+        result.insert("rss_after", after);
+        result.insert("bytes_per_stream", open > 0 ? double(after - before) / double(open) : 0.0);
+        report.add("mux-streams", result);
+    }
+
+}  // namespace Rt2::Sockets::Benchmark
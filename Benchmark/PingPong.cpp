@@ -0,0 +1,96 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#include "Benchmark.h"
+#include "Sockets/ClientSocket.h"
+#include "Sockets/ServerSocket.h"
+
+namespace Rt2::Sockets::Benchmark
+{
+    namespace
+    {
+        bool readExactly(const PlatformSocket& sock, char* dest, const int size)
+        {
+            int total = 0;
+            while (total < size)
+            {
+                int br = 0;
+                Net::readSocket(sock, dest + total, size - total, br, Default::SocketTimeOut);
+                if (br <= 0)
+                    return false;
+                total += br;
+            }
+            return true;
+        }
+    }  // namespace
+
+    // Measures round-trip latency of a small echoed message on one
+    // persistent connection.
+    void pingPong(const Report& report, const Options& opts)
+    {
+        SocketConfig config;
+        config.profile = ProfileLowLatency;
+
+        ServerSocket ss("127.0.0.1", Port, config);
+        if (!ss.isValid())
+            return;
+
+        const int size = opts.messageSize;
+        ss.connect(
+            [size](const PlatformSocket& sock)
+            {
+                String scratch;
+                scratch.resize((size_t)size + 1);
+                while (readExactly(sock, scratch.data(), size))
+                    Net::writeSocket(sock, scratch.data(), (size_t)size, Default::SocketTimeOut);
+            });
+
+        LatencyRecorder latency((size_t)opts.iterations);
+
+        String message, reply;
+        message.resize((size_t)size, 'p');
+        reply.resize((size_t)size + 1);
+
+        const auto start = Clock::now();
+        {
+            const ClientSocket cs("127.0.0.1", Port, config);
+            for (int i = 0; i < opts.iterations; ++i)
+            {
+                const auto begin = Clock::now();
+                cs.write(message);
+                if (!readExactly(cs.socket(), reply.data(), size))
+                    break;
+                latency.record(begin);
+            }
+        }
+        const double sec = secondsSince(start);
+        ss.stop();
+
+        Json::Dictionary result;
+        result.insert("message_size", size);
+        result.insert("round_trips", (int64_t)latency.count());
+        result.insert("seconds", sec);
+        result.insert("round_trips_per_sec", sec > 0 ? double(latency.count()) / sec : 0.0);
+        result.insert("latency", latency.toJson());
+        report.add("ping-pong", result);
+    }
+
+}  // namespace Rt2::Sockets::Benchmark
@@ -0,0 +1,131 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#include <atomic>
+#include "Benchmark.h"
+#include "Sockets/PipelinedClient.h"
+#include "Sockets/ServerSocket.h"
+#include "Thread/Thread.h"
+
+namespace Rt2::Sockets::Benchmark
+{
+    namespace
+    {
+        // Answers every frame that is buffered before reading again, so
+        // a full window goes back in one write.
+        void echoFrames(const PlatformSocket& sock)
+        {
+            RecvBuffer buffer;
+            String     out;
+            for (;;)
+            {
+                Frame  frame;
+                size_t used = 0;
+                while (FrameCodec::decode(buffer.data(), buffer.size(), frame, used) == FrameComplete)
+                {
+                    FrameCodec::encode(out, frame.id, frame.payload);
+                    buffer.consume(used);
+                }
+
+                if (!out.empty())
+                {
+                    const int bw = Net::writeSocket(sock, out.data(), out.size(), Default::SocketTimeOut);
+                    if (bw != (int)out.size())
+                        return;
+                    out.clear();
+                }
+
+                const Status st = buffer.fill(sock);
+                if (st != OkStatus && st != TimeoutStatus)
+                    return;
+            }
+        }
+
+        Json::Dictionary run(const size_t window, const Options& opts)
+        {
+            Json::Dictionary result;
+
+            SocketConfig config;
+            config.profile = ProfileLowLatency;
+
+            ServerSocket ss("127.0.0.1", Port, config);
+            if (!ss.isValid())
+                return result;
+            ss.connect(echoFrames);
+
+            PipelinedClient client;
+            if (client.connect("127.0.0.1", Port, config) != OkStatus)
+                return result;
+            client.setWindow(window);
+
+            String message;
+            message.resize((size_t)opts.messageSize, 'p');
+
+            LatencyRecorder  latency((size_t)opts.iterations);
+            std::atomic<int> done{0}, failed{0};
+
+            const auto start = Clock::now();
+            for (int i = 0; i < opts.iterations; ++i)
+            {
+                const auto begin = Clock::now();
+
+                const Status st = client.request(
+                    message,
+                    [&, begin](const Status status, std::string_view)
+                    {
+                        // the reader thread is the only caller
+                        if (status == OkStatus)
+                            latency.record(begin);
+                        else
+                            ++failed;
+                        ++done;
+                    });
+                if (st != OkStatus)
+                    break;
+            }
+
+            while (done + failed < opts.iterations && client.isOpen())
+                Thread::Thread::yield();
+            const double sec = secondsSince(start);
+
+            client.close();
+            ss.stop();
+
+            result.insert("window", (int64_t)window);
+            result.insert("message_size", opts.messageSize);
+            result.insert("requests", (int64_t)latency.count());
+            result.insert("failed", failed.load());
+            result.insert("seconds", sec);
+            result.insert("requests_per_sec", sec > 0 ? double(latency.count()) / sec : 0.0);
+            result.insert("latency", latency.toJson());
+            return result;
+        }
+    }  // namespace
+
+    // Request throughput on one connection as the number of requests
+    // in flight grows; a window of one is the synchronous baseline.
+    void pipelined(const Report& report, const Options& opts)
+    {
+        for (const size_t window : {1, 4, 16, 64, 256})
+            report.add(Su::join("pipeline-", window), run(window, opts));
+    }
+
+}  // namespace Rt2::Sockets::Benchmark
@@ -0,0 +1,203 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#include <algorithm>
+#include "Benchmark.h"
+#include "Sockets/ServerSocket.h"
+#include "Sockets/ShmChannel.h"
+#include "Thread/Thread.h"
+
+namespace Rt2::Sockets::Benchmark
+{
+    namespace
+    {
+        constexpr char Echo = 'e';
+        constexpr char Sink = 's';
+
+        const String LocalPath = "/tmp/Rt2.Benchmark.shm";
+
+        // The first byte picks the test: echo fixed size messages back
+        // until the client closes, or count bulk bytes and then answer
+        // with a single byte.
+        void serve(ShmChannel& channel, const size_t messageSize, const size_t bulkBytes)
+        {
+            char mode = 0;
+            if (size_t n = 0; channel.receive(&mode, 1, n, Default::SocketTimeOut) != OkStatus)
+                return;
+
+            if (mode == Echo)
+            {
+                String message;
+                while (channel.readExactly(message, messageSize, Default::SocketTimeOut))
+                {
+                    if (channel.write(message, Default::SocketTimeOut) != OkStatus)
+                        return;
+                }
+                return;
+            }
+
+            String buffer(0x10000, 0);
+            size_t total = 0;
+            while (total < bulkBytes)
+            {
+                size_t n = 0;
+                if (channel.receive(buffer.data(), buffer.size(), n, Default::SocketTimeOut) != OkStatus)
+                    return;
+                total += n;
+            }
+            channel.write(&Sink, sizeof Sink, Default::SocketTimeOut);
+        }
+
+        void roundTrips(Json::Dictionary& result, ShmChannel& channel, const Options& opts)
+        {
+            String message((size_t)opts.messageSize, 'p'), reply;
+
+            if (channel.write(&Echo, sizeof Echo) != OkStatus)
+                return;
+
+            LatencyRecorder latency((size_t)opts.iterations);
+
+            const auto start = Clock::now();
+            for (int i = 0; i < opts.iterations; ++i)
+            {
+                const auto begin = Clock::now();
+                if (channel.write(message) != OkStatus ||
+                    !channel.readExactly(reply, message.size()))
+                    break;
+                latency.record(begin);
+            }
+            const double sec = secondsSince(start);
+
+            result.insert("round_trips", (int64_t)latency.count());
+            result.insert("round_trips_per_sec", sec > 0 ? double(latency.count()) / sec : 0.0);
+            result.insert("latency", latency.toJson());
+        }
+
+        void bulk(Json::Dictionary& result, ShmChannel& channel, const Options& opts)
+        {
+            const size_t total = (size_t)opts.megabytes << 20;
+            const String chunk(0x10000, 'b');
+
+            if (channel.write(&Sink, sizeof Sink) != OkStatus)
+                return;
+
+            const auto start = Clock::now();
+            size_t     sent  = 0;
+            while (sent < total)
+            {
+                const size_t n = std::min(chunk.size(), total - sent);
+                if (channel.write(chunk.data(), n) != OkStatus)
+                    return;
+                sent += n;
+            }
+
+            String ack;
+            if (!channel.readExactly(ack, 1))
+                return;
+            const double sec = secondsSince(start);
+
+            result.insert("bytes", (int64_t)total);
+            result.insert("mb_per_sec", sec > 0 ? double(total) / double(1 << 20) / sec : 0.0);
+        }
+
+        // Runs both tests over two connections that connect makes.
+        template <typename Connect>
+        Json::Dictionary measure(const Connect& connect, const Options& opts)
+        {
+            Json::Dictionary result;
+
+            ShmChannel echo, sink;
+            if (connect(echo) != OkStatus)
+                return result;
+
+            result.insert("shared", echo.isShared());
+            roundTrips(result, echo, opts);
+            echo.close();
+
+            if (connect(sink) != OkStatus)
+                return result;
+            bulk(result, sink, opts);
+            return result;
+        }
+
+        Json::Dictionary overTcp(const Options& opts)
+        {
+            const size_t bulkBytes = (size_t)opts.megabytes << 20;
+
+            SocketConfig config;
+            config.profile = ProfileLowLatency;
+
+            ServerSocket ss("127.0.0.1", Port, config);
+            if (!ss.isValid())
+                return {};
+            ss.connect(
+                [&](const PlatformSocket& sock)
+                {
+                    // the server closes its own handle when this returns
+                    ShmChannel channel(Net::duplicate(sock));
+                    serve(channel, (size_t)opts.messageSize, bulkBytes);
+                });
+
+            // there is no listener at the path, so this stays on TCP
+            Json::Dictionary result = measure(
+                [](ShmChannel& channel)
+                { return channel.connect("127.0.0.1", Port, LocalPath, Default::SocketTimeOut); },
+                opts);
+            ss.stop();
+            return result;
+        }
+
+        Json::Dictionary overLocal(const bool shared, const Options& opts)
+        {
+            ShmListener listener(LocalPath);
+            if (!listener.isValid())
+                return {};
+            listener.setShared(shared);
+
+            Thread::StandardThread server(
+                [&]
+                {
+                    for (int i = 0; i < 2; ++i)
+                    {
+                        if (const ShmChannelPtr channel = listener.accept(Default::SocketTimeOut))
+                            serve(*channel, (size_t)opts.messageSize, (size_t)opts.megabytes << 20);
+                    }
+                });
+
+            Json::Dictionary result = measure(
+                [](ShmChannel& channel)
+                { return channel.connect(LocalPath, Default::SocketTimeOut); },
+                opts);
+            server.join();
+            return result;
+        }
+    }  // namespace
+
+    // Round trips and bulk transfer to a peer on the same host over TCP
+    // loopback, a Unix socket, and the shared-memory rings.
+    void sharedMemory(const Report& report, const Options& opts)
+    {
+        report.add("shm-tcp", overTcp(opts));
+        report.add("shm-unix", overLocal(false, opts));
+        report.add("shm-rings", overLocal(true, opts));
+    }
+
+}  // namespace Rt2::Sockets::Benchmark
@@ -0,0 +1,94 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#include <atomic>
+#include "Benchmark.h"
+#include "Sockets/ClientSocket.h"
+#include "Sockets/ServerSocket.h"
+#include "Thread/Thread.h"
+
+namespace Rt2::Sockets::Benchmark
+{
+    namespace
+    {
+        constexpr int BlockSize = 0x10000;
+
+        // Streams a fixed amount of data over loopback with the given
+        // configuration on both ends and measures the transfer rate.
+        Json::Dictionary transfer(const SocketConfig& config, const int megabytes)
+        {
+            std::atomic<int64_t> received{0};
+            std::atomic<bool>    finished{false};
+
+            Json::Dictionary result;
+
+            ServerSocket ss("127.0.0.1", Port, config);
+            if (!ss.isValid())
+                return result;
+
+            ss.connect(
+                [&received, &finished](const PlatformSocket& sock)
+                {
+                    String scratch;
+                    scratch.resize(BlockSize + 1);
+
+                    int br = 0;
+                    do
+                    {
+                        Net::readSocket(sock, scratch.data(), BlockSize, br, Default::SocketTimeOut);
+                        received += br;
+                    } while (br > 0);
+                    finished = true;
+                });
+
+            String block;
+            block.resize(BlockSize, 'x');
+
+            const int64_t total = (int64_t)megabytes * 0x100000;
+            const auto    start = Clock::now();
+            {
+                const ClientSocket cs("127.0.0.1", Port, config);
+                for (int64_t sent = 0; sent < total; sent += BlockSize)
+                    cs.write(block);
+            }
+
+            while (!finished)
+                Thread::Thread::yield();
+
+            const double sec = secondsSince(start);
+            ss.stop();
+
+            result.insert("send_buffer", config.sendBufferSize);
+            result.insert("receive_buffer", config.receiveBufferSize);
+            result.insert("bytes", received.load());
+            result.insert("seconds", sec);
+            result.insert("mib_per_sec", sec > 0 ? double(received) / double(0x100000) / sec : 0.0);
+            return result;
+        }
+    }  // namespace
+
+    void bulkThroughput(const Report& report, const Options& opts)
+    {
+        report.add("bulk-throughput-legacy", transfer(SocketConfig::legacy(), opts.megabytes));
+        report.add("bulk-throughput-autotuned", transfer(SocketConfig{}, opts.megabytes));
+    }
+
+}  // namespace Rt2::Sockets::Benchmark
@@ -0,0 +1,220 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include "Benchmark.h"
+#include "Sockets/WebSocket.h"
+
+namespace Rt2::Sockets::Benchmark
+{
+    namespace
+    {
+        constexpr int Modes  = 2;
+        constexpr int Rounds = 4;
+
+        // the warm-up pass is tagged past the measured modes
+        constexpr char WarmUp = Modes;
+
+        int64_t stamp()
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+        }
+    }  // namespace
+
+    // Publishes to many WebSocket subscribers, once encoding each frame
+    // a single time for everyone and once encoding it per subscriber.
+    // After a warm-up pass the two modes alternate over several rounds,
+    // so neither gains from running second. Every message carries its
+    // send time and mode, so subscribers measure delivery latency.
+    void wsFanout(const Report& report, const Options& opts)
+    {
+        const int subscribers = opts.subscribers > 0 ? opts.subscribers : 1;
+        const int batch       = opts.iterations / 20 / Rounds > 0 ? opts.iterations / 20 / Rounds : 1;
+        const int messages    = batch * Rounds;
+        const int size        = opts.messageSize > 9 ? opts.messageSize : 9;
+
+        raiseDescriptorLimit(subscribers * 2 + 64);
+
+        // Sessions live on the handlers' stacks. A handler removes its
+        // session under the lock before returning, and publishing holds
+        // the lock, so a subscriber that leaves early is never written to.
+        std::mutex              lock;
+        std::vector<WebSocket*> sessions;
+
+        HttpServer server(
+            "127.0.0.1",
+            Port,
+            [&](const HttpRequest& req, HttpResponse& res)
+            {
+                WebSocket::upgrade(
+                    req,
+                    res,
+                    [&](WebSocket& ws)
+                    {
+                        {
+                            std::lock_guard guard(lock);
+                            sessions.push_back(&ws);
+                        }
+
+                        WsMessage msg;
+                        Status    st;
+                        while ((st = ws.read(msg, Default::HttpPollSlice)) == OkStatus || st == TimeoutStatus)
+                            continue;
+
+                        std::lock_guard guard(lock);
+                        sessions.erase(std::find(sessions.begin(), sessions.end(), &ws));
+                    });
+            });
+        if (!server.isValid())
+            return;
+
+        // per subscriber, then per mode
+        std::vector<std::vector<int64_t>> samples((size_t)subscribers * Modes);
+        std::vector<std::thread>          threads;
+        std::atomic<int>                  received{0};
+
+        for (int s = 0; s < subscribers; ++s)
+        {
+            threads.emplace_back(
+                [&, s]
+                {
+                    WebSocketClient client;
+                    if (client.connect("127.0.0.1", Port) != OkStatus)
+                        return;
+
+                    for (int mode = 0; mode < Modes; ++mode)
+                        samples[(size_t)(s * Modes + mode)].reserve((size_t)messages);
+
+                    WsMessage msg;
+                    for (int n = 0; n < batch + messages * Modes; ++n)
+                    {
+                        if (client.session().read(msg) != OkStatus || msg.data.size() < 9)
+                            break;
+
+                        int64_t sent;
+                        memcpy(&sent, msg.data.data(), 8);
+
+                        const int mode = msg.data[8];
+                        if (mode < Modes)
+                        {
+                            samples[(size_t)(s * Modes + mode)].push_back(stamp() - sent);
+                            ++received;
+                        }
+                    }
+                    client.session().close();
+                });
+        }
+
+        // wait for every subscriber to finish the handshake
+        const auto wait = Clock::now();
+        for (;;)
+        {
+            {
+                std::lock_guard guard(lock);
+                if ((int)sessions.size() >= subscribers)
+                    break;
+            }
+            if (secondsSince(wait) > 10)
+                break;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        size_t targets;
+        {
+            std::lock_guard guard(lock);
+            targets = sessions.size();
+        }
+
+        String payload;
+        payload.resize((size_t)size, 'u');
+
+        const auto publish = [&](const char mode, const int count)
+        {
+            for (int i = 0; i < count; ++i)
+            {
+                const int64_t now = stamp();
+                memcpy(payload.data(), &now, 8);
+                payload[8] = mode;
+
+                std::lock_guard guard(lock);
+                if (mode == 0)
+                {
+                    String frame;
+                    WsCodec::encode(frame, WsBinary, payload);
+                    for (WebSocket* ws : sessions)
+                        ws->sendEncoded(frame);
+                }
+                else
+                {
+                    for (WebSocket* ws : sessions)
+                        ws->send(payload, WsBinary);
+                }
+            }
+        };
+
+        publish(WarmUp, batch);
+
+        double seconds[Modes] = {};
+        for (int round = 0; round < Rounds; ++round)
+        {
+            for (int i = 0; i < Modes; ++i)
+            {
+                const int  mode  = round % 2 ? Modes - 1 - i : i;
+                const auto start = Clock::now();
+                publish((char)mode, batch);
+                seconds[mode] += secondsSince(start);
+            }
+        }
+
+        for (std::thread& th : threads)
+            th.join();
+        server.stop();
+
+        Json::Dictionary result;
+        result.insert("subscribers", (int)targets);
+        result.insert("messages", messages);
+        result.insert("message_size", size);
+        result.insert("deliveries", received.load());
+
+        const char* names[Modes] = {"encode_once", "encode_per_subscriber"};
+        for (int mode = 0; mode < Modes; ++mode)
+        {
+            LatencyRecorder latency;
+            for (int s = 0; s < subscribers; ++s)
+                for (const int64_t lat : samples[(size_t)(s * Modes + mode)])
+                    latency.record(lat);
+
+            const double deliveries = double(messages) * double(targets);
+
+            Json::Dictionary part;
+            part.insert("publish_seconds", seconds[mode]);
+            part.insert("deliveries_per_sec", seconds[mode] > 0 ? deliveries / seconds[mode] : 0.0);
+            part.insert("latency", latency.toJson());
+            result.insert(names[mode], part);
+        }
+        report.add("ws-fanout", result);
+    }
+
+}  // namespace Rt2::Sockets::Benchmark
@@ -0,0 +1,124 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#include <atomic>
+#include "Benchmark.h"
+#include "Sockets/ClientSocket.h"
+#include "Sockets/ServerSocket.h"
+#include "Sockets/ZeroCopySender.h"
+#include "Thread/Thread.h"
+
+namespace Rt2::Sockets::Benchmark
+{
+    namespace
+    {
+        constexpr int ReadSize = 0x40000;
+
+        // Streams the payload in pooled blocks of the given size and
+        // measures CPU time on the sending thread only, since that is
+        // where the copy into the kernel is charged.
+        Json::Dictionary transfer(const bool   zeroCopy,
+                                  const size_t blockSize,
+                                  const int    megabytes)
+        {
+            std::atomic<int64_t> received{0};
+            std::atomic<bool>    finished{false};
+
+            Json::Dictionary result;
+
+            ServerSocket ss("127.0.0.1", Port);
+            if (!ss.isValid())
+                return result;
+
+            ss.connect(
+                [&received, &finished](const PlatformSocket& sock)
+                {
+                    String scratch;
+                    scratch.resize(ReadSize);
+
+                    int br = 0;
+                    do
+                    {
+                        Net::readSocket(sock, scratch.data(), ReadSize, br, Default::SocketTimeOut);
+                        received += br;
+                    } while (br > 0);
+                    finished = true;
+                });
+
+            const int64_t total = (int64_t)megabytes * 0x100000;
+
+            uint64_t zeroCopied = 0, deferred = 0;
+            bool     enabled    = false;
+
+            const double cpu   = threadCpuSeconds();
+            const auto   start = Clock::now();
+            {
+                const ClientSocket cs("127.0.0.1", Port);
+                ZeroCopySender     sender(cs.socket(),
+                                      zeroCopy ? Default::ZeroCopyThreshold : (size_t)-1);
+                enabled = sender.isEnabled();
+
+                for (int64_t sent = 0; sent < total; sent += (int64_t)blockSize)
+                {
+                    PoolBlock block = sender.acquire(blockSize);
+                    if (sender.send(block, blockSize) != OkStatus)
+                        break;
+                }
+                sender.flush();
+                zeroCopied = sender.zeroCopied();
+                deferred   = sender.deferredCopies();
+            }
+            const double cpuSec = threadCpuSeconds() - cpu;
+
+            while (!finished)
+                Thread::Thread::yield();
+
+            const double sec = secondsSince(start);
+            ss.stop();
+
+            const double gib = double(received) / double(0x40000000);
+
+            result.insert("zero_copy", zeroCopy && enabled);
+            result.insert("block_size", (int64_t)blockSize);
+            result.insert("bytes", received.load());
+            result.insert("seconds", sec);
+            result.insert("sender_cpu_seconds", cpuSec);
+            result.insert("cpu_seconds_per_gib", gib > 0 ? cpuSec / gib : 0.0);
+            result.insert("mib_per_sec", sec > 0 ? double(received) / double(0x100000) / sec : 0.0);
+            result.insert("zero_copy_sends", (int64_t)zeroCopied);
+
+            // loopback never keeps pages pinned; the kernel copies them
+            // when the data is queued to the receiver, so these numbers
+            // understate what a real NIC gains
+            result.insert("deferred_copies", (int64_t)deferred);
+            return result;
+        }
+    }  // namespace
+
+    void zeroCopySend(const Report& report, const Options& opts)
+    {
+        report.add("zerocopy-copy-16k", transfer(false, 0x4000, opts.megabytes));
+        report.add("zerocopy-copy-256k", transfer(false, 0x40000, opts.megabytes));
+        report.add("zerocopy-16k", transfer(true, 0x4000, opts.megabytes));
+        report.add("zerocopy-256k", transfer(true, 0x40000, opts.megabytes));
+    }
+
+}  // namespace Rt2::Sockets::Benchmark
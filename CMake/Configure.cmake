@@ -11,6 +11,7 @@ set_property(GLOBAL PROPERTY USE_FOLDERS ON)
 
 option(Sockets_BUILD_TEST          "Build the unit test program." ON)
 option(Sockets_AUTO_RUN_TEST       "Automatically run the test program." OFF)
+option(Sockets_BUILD_BENCHMARK     "Build the benchmark program." OFF)
 option(Sockets_USE_STATIC_RUNTIME  "Build with the MultiThreaded(Debug) runtime library." ON)
 
 if (Sockets_USE_STATIC_RUNTIME)
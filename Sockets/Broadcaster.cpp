@@ -0,0 +1,167 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#include "Sockets/Broadcaster.h"
+#include <vector>
+
+namespace Rt2::Sockets
+{
+    Broadcaster::Broadcaster(EventLoop&               loop,
+                             const size_t             queueLimit,
+                             const SlowConsumerPolicy policy) :
+        _loop(loop),
+        _limit(queueLimit),
+        _policy(policy)
+    {
+    }
+
+    Broadcaster::~Broadcaster()
+    {
+        for (const auto& [sock, sub] : _subscribers)
+        {
+            _loop.remove(sock);
+            Net::close(sock);
+        }
+        _subscribers.clear();
+    }
+
+    bool Broadcaster::subscribe(const PlatformSocket& sock)
+    {
+        const PlatformSocket own = Net::duplicate(sock);
+        RT_GUARD_RET(own != InvalidSocket, false)
+
+        Net::Utils::setBlocking(own, false);
+        _loop.post([this, own]
+                   { attach(own); });
+        return true;
+    }
+
+    void Broadcaster::publish(const SharedBuffer& buffer)
+    {
+        RT_GUARD_VOID(!buffer.empty())
+        _loop.post([this, buffer]
+                   { deliver(buffer); });
+    }
+
+    void Broadcaster::publish(String&& payload)
+    {
+        publish(SharedBuffer(std::move(payload)));
+    }
+
+    void Broadcaster::attach(const PlatformSocket sock)
+    {
+        // reads only watch for the peer going away
+        if (!_loop.add(sock, EventRead, [this, sock](const int events)
+                       { onEvent(sock, events); }))
+        {
+            Net::close(sock);
+            return;
+        }
+
+        Subscriber& sub = _subscribers[sock];
+        sub.queue       = std::make_unique<OutboundQueue>(sock);
+        sub.queue->setLimit(_limit);
+        ++_count;
+    }
+
+    void Broadcaster::detach(const PlatformSocket sock)
+    {
+        const auto it = _subscribers.find(sock);
+        RT_GUARD_VOID(it != _subscribers.end())
+
+        _loop.remove(sock);
+        Net::close(sock);
+        _subscribers.erase(it);
+        --_count;
+    }
+
+    void Broadcaster::deliver(const SharedBuffer& buffer)
+    {
+        std::vector<PlatformSocket> slow;
+        for (auto& [sock, sub] : _subscribers)
+        {
+            if (!sub.queue->push(buffer))
+            {
+                if (_policy == SlowConsumerDrop)
+                    ++_dropped;
+                else
+                    slow.push_back(sock);
+                continue;
+            }
+
+            // a queue that is already waiting on writability stays in order
+            if (!sub.armed && !flush(sub))
+                slow.push_back(sock);
+        }
+
+        for (const PlatformSocket sock : slow)
+        {
+            if (_policy == SlowConsumerDisconnect)
+                ++_disconnected;
+            detach(sock);
+        }
+    }
+
+    bool Broadcaster::flush(Subscriber& sub)
+    {
+        const Status st = sub.queue->flush();
+        if (st == ErrorStatus)
+            return false;
+
+        // only wait on writability while something is left over
+        const bool pending = st == TimeoutStatus;
+        if (pending != sub.armed)
+        {
+            _loop.modify(sub.queue->socket(), pending ? EventRead | EventWrite : EventRead);
+            sub.armed = pending;
+        }
+        return true;
+    }
+
+    void Broadcaster::onEvent(const PlatformSocket sock, const int events)
+    {
+        const auto it = _subscribers.find(sock);
+        RT_GUARD_VOID(it != _subscribers.end())
+
+        bool closed = (events & EventClosed) != 0;
+        if (!closed && events & EventRead)
+        {
+            // subscribers have nothing to say; discard until it would block
+            char scratch[256];
+            for (;;)
+            {
+                int          br = 0;
+                const Status st = Net::receive(sock, scratch, sizeof scratch, br, 0);
+                if (st == ClosedStatus || st == ErrorStatus)
+                    closed = true;
+                if (st != OkStatus)
+                    break;
+            }
+        }
+
+        if (!closed && events & EventWrite)
+            closed = !flush(it->second);
+
+        if (closed)
+            detach(sock);
+    }
+
+}  // namespace Rt2::Sockets
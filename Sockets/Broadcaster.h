@@ -0,0 +1,119 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#pragma once
+#include <atomic>
+#include <memory>
+#include <unordered_map>
+#include "Sockets/EventLoop.h"
+#include "Sockets/OutboundQueue.h"
+
+namespace Rt2::Sockets
+{
+    namespace Default
+    {
+        constexpr size_t BroadcastQueueLimit = 0x100000;
+    }  // namespace Default
+
+    enum SlowConsumerPolicy
+    {
+        SlowConsumerDrop,        // skip messages while the queue is full
+        SlowConsumerDisconnect,  // close the connection
+    };
+
+    // Publishes one SharedBuffer to every subscriber. Each subscriber's
+    // OutboundQueue holds a reference to the buffer rather than a copy,
+    // so a broadcast costs its payload once plus a small entry per
+    // subscriber. Queues drain from the event loop as sockets become
+    // writable.
+    //
+    // subscribe and publish are safe from any thread. The broadcaster
+    // itself must be destroyed on the loop thread or after the loop
+    // has stopped.
+    class Broadcaster
+    {
+    private:
+        struct Subscriber
+        {
+            std::unique_ptr<OutboundQueue> queue;
+            bool                           armed{false};
+        };
+
+        EventLoop&                                     _loop;
+        std::unordered_map<PlatformSocket, Subscriber> _subscribers;
+        const size_t                                   _limit;
+        const SlowConsumerPolicy                       _policy;
+        std::atomic<size_t>                            _count{0};
+        std::atomic<uint64_t>                          _dropped{0};
+        std::atomic<uint64_t>                          _disconnected{0};
+
+        void attach(PlatformSocket sock);
+
+        void detach(PlatformSocket sock);
+
+        void deliver(const SharedBuffer& buffer);
+
+        bool flush(Subscriber& sub);
+
+        void onEvent(PlatformSocket sock, int events);
+
+    public:
+        explicit Broadcaster(EventLoop&         loop,
+                             size_t             queueLimit = Default::BroadcastQueueLimit,
+                             SlowConsumerPolicy policy     = SlowConsumerDisconnect);
+        ~Broadcaster();
+
+        Broadcaster(const Broadcaster&)            = delete;
+        Broadcaster& operator=(const Broadcaster&) = delete;
+
+        // Takes its own handle to the socket, so the caller may close
+        // theirs; the broadcaster closes its handle on disconnect.
+        bool subscribe(const PlatformSocket& sock);
+
+        void publish(const SharedBuffer& buffer);
+
+        void publish(String&& payload);
+
+        size_t subscribers() const;
+
+        // Messages skipped under SlowConsumerDrop.
+        uint64_t dropped() const;
+
+        // Subscribers closed under SlowConsumerDisconnect.
+        uint64_t disconnected() const;
+    };
+
+    inline size_t Broadcaster::subscribers() const
+    {
+        return _count.load(std::memory_order_relaxed);
+    }
+
+    inline uint64_t Broadcaster::dropped() const
+    {
+        return _dropped.load(std::memory_order_relaxed);
+    }
+
+    inline uint64_t Broadcaster::disconnected() const
+    {
+        return _disconnected.load(std::memory_order_relaxed);
+    }
+
+}  // namespace Rt2::Sockets
@@ -0,0 +1,109 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#include "Sockets/BufferPool.h"
+
+namespace Rt2::Sockets
+{
+    namespace
+    {
+        size_t classIndex(const size_t size)
+        {
+            size_t idx = 0;
+            while ((BufferPool::MinBlock << idx) < size)
+                ++idx;
+            return idx;
+        }
+    }  // namespace
+
+    BufferPool::~BufferPool()
+    {
+        trim();
+    }
+
+    size_t BufferPool::classSize(const size_t minimum)
+    {
+        if (minimum > MaxBlock)
+            return minimum;
+        return MinBlock << classIndex(minimum);
+    }
+
+    PoolBlock BufferPool::acquire(const size_t minimum)
+    {
+        PoolBlock block;
+        block.capacity = classSize(minimum);
+
+        if (block.capacity <= MaxBlock)
+        {
+            std::lock_guard guard(_lock);
+
+            auto& list = _free[classIndex(block.capacity)];
+            if (!list.empty())
+            {
+                block.data = list.back();
+                list.pop_back();
+                return block;
+            }
+        }
+
+        block.data = new char[block.capacity];
+        return block;
+    }
+
+    void BufferPool::release(PoolBlock& block)
+    {
+        RT_GUARD_VOID(block.data)
+
+        if (block.capacity <= MaxBlock && block.capacity == classSize(block.capacity))
+        {
+            std::lock_guard guard(_lock);
+
+            if (auto& list = _free[classIndex(block.capacity)];
+                list.size() < MaxCached)
+            {
+                list.push_back(block.data);
+                block = {};
+                return;
+            }
+        }
+
+        delete[] block.data;
+        block = {};
+    }
+
+    void BufferPool::trim()
+    {
+        std::lock_guard guard(_lock);
+        for (auto& list : _free)
+        {
+            for (const char* data : list)
+                delete[] data;
+            list.clear();
+        }
+    }
+
+    BufferPool& BufferPool::global()
+    {
+        static BufferPool pool;
+        return pool;
+    }
+
+}  // namespace Rt2::Sockets
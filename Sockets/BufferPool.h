@@ -0,0 +1,69 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#pragma once
+#include <mutex>
+#include <vector>
+#include "Utils/Definitions.h"
+
+namespace Rt2::Sockets
+{
+    struct PoolBlock
+    {
+        char*  data{nullptr};
+        size_t capacity{0};
+    };
+
+    // Power of two size classes from 4 KiB to 1 MiB. Released blocks
+    // are cached per class up to a limit; anything larger than the last
+    // class goes straight back to the allocator.
+    class BufferPool
+    {
+    public:
+        static constexpr size_t MinBlockBits = 12;
+        static constexpr size_t MinBlock     = (size_t)1 << MinBlockBits;
+        static constexpr size_t Classes      = 9;
+        static constexpr size_t MaxBlock     = MinBlock << (Classes - 1);
+        static constexpr size_t MaxCached    = 0x40;
+
+    private:
+        std::mutex         _lock;
+        std::vector<char*> _free[Classes];
+
+    public:
+        BufferPool() = default;
+        ~BufferPool();
+
+        BufferPool(const BufferPool&)            = delete;
+        BufferPool& operator=(const BufferPool&) = delete;
+
+        PoolBlock acquire(size_t minimum);
+
+        void release(PoolBlock& block);
+
+        void trim();
+
+        static size_t classSize(size_t minimum);
+
+        static BufferPool& global();
+    };
+
+}  // namespace Rt2::Sockets
@@ -0,0 +1,107 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#include "Sockets/BusyPoller.h"
+#include <algorithm>
+#include <thread>
+
+namespace Rt2::Sockets
+{
+    namespace
+    {
+        // Gaps are capped at this many budgets so that one quiet spell
+        // does not turn spinning off for long once traffic resumes.
+        constexpr int64_t GapCap = 4;
+
+        void relax(const bool yield)
+        {
+            // on a single processor the sender cannot run while this
+            // thread spins, so it is handed the processor instead
+            if (yield)
+                std::this_thread::yield();
+#if defined(__x86_64__) || defined(__i386__)
+            else
+                __builtin_ia32_pause();
+#endif
+        }
+    }  // namespace
+
+    BusyPoller::BusyPoller(const int budget) :
+        _budget(std::max(budget, 0) * 1000ll),
+        _spin(_budget),
+        _yield(std::thread::hardware_concurrency() <= 1)
+    {
+    }
+
+    void BusyPoller::setBudget(const int microseconds)
+    {
+        _budget = std::max(microseconds, 0) * 1000ll;
+        if (_gap < 0)
+            _spin = _budget;
+        else
+            _spin = _gap <= _budget ? std::min(_budget, 2 * _gap) : 0;
+    }
+
+    void BusyPoller::arrived(const Clock::time_point& now)
+    {
+        if (_last != Clock::time_point{})
+        {
+            const int64_t sample = std::min(
+                (int64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(now - _last).count(),
+                _budget * GapCap);
+
+            // a moving average over roughly the last eight arrivals
+            _gap  = _gap < 0 ? sample : _gap + (sample - _gap) / 8;
+            _spin = _gap <= _budget ? std::min(_budget, 2 * _gap) : 0;
+        }
+        _last = now;
+    }
+
+    Status BusyPoller::receive(const PlatformSocket& sock,
+                               char*                 dest,
+                               const int             size,
+                               int&                  bytesRead,
+                               const int             timeout)
+    {
+        Status st = Net::receiveNow(sock, dest, size, bytesRead);
+        if (st == TimeoutStatus && _spin > 0)
+        {
+            const auto until = Clock::now() + std::chrono::nanoseconds(_spin);
+            do
+            {
+                relax(_yield);
+                st = Net::receiveNow(sock, dest, size, bytesRead);
+            } while (st == TimeoutStatus && Clock::now() < until);
+
+            if (st == TimeoutStatus)
+                ++_misses;
+            else
+                ++_hits;
+        }
+
+        if (st == TimeoutStatus && timeout != 0)
+            st = Net::receive(sock, dest, size, bytesRead, timeout);
+        if (st == OkStatus)
+            arrived(Clock::now());
+        return st;
+    }
+
+}  // namespace Rt2::Sockets
@@ -0,0 +1,93 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#pragma once
+#include <chrono>
+#include "Sockets/PlatformSocket.h"
+
+namespace Rt2::Sockets
+{
+    namespace Default
+    {
+        constexpr int BusyPollBudget = 50;  // microseconds
+    }  // namespace Default
+
+    // Receives by spinning on a non-blocking receive before falling
+    // back to Net's readiness wait, trading CPU for the wakeup latency
+    // of select. The spin follows the recent gaps between arrivals:
+    // while data keeps coming within the budget it covers twice the
+    // average gap, and once gaps grow past the budget it stops, since
+    // spinning would only burn CPU, until arrivals speed up again.
+    //
+    // One poller serves one socket on one thread; it takes no locks.
+    class BusyPoller
+    {
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        int64_t           _budget;   // nanoseconds
+        int64_t           _spin;     // nanoseconds, the current spin
+        int64_t           _gap{-1};  // nanoseconds, moving average
+        Clock::time_point _last{};
+        uint64_t          _hits{0};
+        uint64_t          _misses{0};
+        bool              _yield;
+
+        void arrived(const Clock::time_point& now);
+
+    public:
+        explicit BusyPoller(int budget = Default::BusyPollBudget);
+
+        Status receive(const PlatformSocket& sock,
+                       char*                 dest,
+                       int                   size,
+                       int&                  bytesRead,
+                       int                   timeout = Default::SocketTimeOut);
+
+        // The most a receive spins, in microseconds; zero never spins.
+        void setBudget(int microseconds);
+
+        // The spin the next receive will use, in nanoseconds.
+        int64_t spin() const;
+
+        // Receives that found data while spinning.
+        uint64_t hits() const;
+
+        // Spins that ran out and fell back to waiting.
+        uint64_t misses() const;
+    };
+
+    inline int64_t BusyPoller::spin() const
+    {
+        return _spin;
+    }
+
+    inline uint64_t BusyPoller::hits() const
+    {
+        return _hits;
+    }
+
+    inline uint64_t BusyPoller::misses() const
+    {
+        return _misses;
+    }
+
+}  // namespace Rt2::Sockets
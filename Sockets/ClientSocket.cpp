@@ -20,17 +20,17 @@
 -------------------------------------------------------------------------------
 */
 #include "Sockets/ClientSocket.h"
-#include "SocketStream.h"
 #include "Utils/Exception.h"
 #include "Utils/LogFile.h"
 #include "Utils/Streams/StreamBase.h"
 
 namespace Rt2::Sockets
 {
-    ClientSocket::ClientSocket(const String&  ipv4,
-                               const uint16_t port)
+    ClientSocket::ClientSocket(const String&       ipv4,
+                               const uint16_t      port,
+                               const SocketConfig& config)
     {
-        open(ipv4, port);
+        open(ipv4, port, config);
     }
 
     ClientSocket::ClientSocket() = default;
@@ -53,15 +53,44 @@ namespace Rt2::Sockets
         write(bs.string());
     }
 
+    InputSocketStream& ClientSocket::input() const
+    {
+        // Kept across calls so bytes that arrive past the end of one
+        // message are still there for the next read.
+        if (!_input)
+            _input = std::make_unique<InputSocketStream>(_sock);
+        return *_input;
+    }
+
     void ClientSocket::read(OStream& is) const
     {
         RT_GUARD_VOID(isValid())
-        InputSocketStream iss(_sock);
+        InputSocketStream& iss = input();
+        iss.resume();
         iss.copyTo(is);
     }
 
-    void ClientSocket::open(const String& ipv4, uint16_t port)
+    bool ClientSocket::read(String& dest, const MessageComplete& complete) const
+    {
+        RT_GUARD_RET(isValid(), false)
+        return input().readMessage(complete, dest);
+    }
+
+    bool ClientSocket::readExactly(String& dest, const size_t n) const
+    {
+        RT_GUARD_RET(isValid(), false)
+        return input().readExactly(n, dest);
+    }
+
+    bool ClientSocket::readUntil(String& dest, const String& delimiter) const
+    {
+        RT_GUARD_RET(isValid(), false)
+        return input().readUntil(delimiter, dest);
+    }
+
+    void ClientSocket::open(const String& ipv4, uint16_t port, const SocketConfig& config)
     {
+        _input.reset();
         try
         {
             String host;
@@ -92,11 +121,9 @@ namespace Rt2::Sockets
             if (!isValid())
                 throw Exception("failed to create socket");
 
-            setKeepAlive(true);
-            setMaxSendBuffer(Default::IoBufferSize);
-            setMaxReceiveBuffer(Default::IoBufferSize);
-            setSendTimeout(Default::SocketTimeOut);
-            setReceiveTimeout(Default::SocketTimeOut);
+            configure(config);
+            if (config.fastOpen > 0)
+                setFastOpenConnect(true);
 
             if (Net::connect(_sock, host, port) != OkStatus)
                 throw Exception("failed to connect to ", host, ':', port);
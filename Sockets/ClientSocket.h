@@ -20,14 +20,21 @@
 -------------------------------------------------------------------------------
 */
 #pragma once
+#include <memory>
 #include "Sockets/Socket.h"
+#include "Sockets/SocketStream.h"
 
 namespace Rt2::Sockets
 {
     class ClientSocket final : public Socket
     {
+    private:
+        mutable std::unique_ptr<InputSocketStream> _input;
+
+        InputSocketStream& input() const;
+
     public:
-        ClientSocket(const String& ipv4, uint16_t port);
+        ClientSocket(const String& ipv4, uint16_t port, const SocketConfig& config = {});
         ClientSocket();
         ~ClientSocket() override;
 
@@ -37,6 +44,12 @@ namespace Rt2::Sockets
 
         void read(OStream& is) const;
 
-        void open(const String& ipv4, uint16_t port);
+        bool read(String& dest, const MessageComplete& complete) const;
+
+        bool readExactly(String& dest, size_t n) const;
+
+        bool readUntil(String& dest, const String& delimiter) const;
+
+        void open(const String& ipv4, uint16_t port, const SocketConfig& config = {});
     };
 }  // namespace Rt2::Sockets
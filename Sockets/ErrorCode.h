@@ -0,0 +1,91 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#pragma once
+#include <cstdint>
+#include <functional>
+
+namespace Rt2::Sockets
+{
+    namespace Default
+    {
+        constexpr int ErrorLogRate = 10;  // sink calls per second
+    }  // namespace Default
+
+    enum NetOperation : uint8_t
+    {
+        OpNone,
+        OpStartup,
+        OpCreate,
+        OpClose,
+        OpDuplicate,
+        OpConnect,
+        OpBind,
+        OpListen,
+        OpAccept,
+        OpPoll,
+        OpRead,
+        OpWrite,
+        OpSetOption,
+        OpGetOption,
+        OpOperationCount,
+    };
+
+    // The system error (errno, or the WSA error on Windows) and the Net
+    // operation that raised it. Plain data, so recording one is a
+    // couple of stores and nothing else.
+    struct ErrorCode
+    {
+        int32_t      code{0};
+        NetOperation operation{OpNone};
+
+        constexpr bool ok() const;
+
+        constexpr explicit operator bool() const;
+
+        constexpr bool operator==(const ErrorCode& rhs) const;
+
+        constexpr bool operator!=(const ErrorCode& rhs) const;
+    };
+
+    using ErrorSink = std::function<void(const ErrorCode&)>;
+
+    constexpr bool ErrorCode::ok() const
+    {
+        return code == 0;
+    }
+
+    constexpr ErrorCode::operator bool() const
+    {
+        return code != 0;
+    }
+
+    constexpr bool ErrorCode::operator==(const ErrorCode& rhs) const
+    {
+        return code == rhs.code && operation == rhs.operation;
+    }
+
+    constexpr bool ErrorCode::operator!=(const ErrorCode& rhs) const
+    {
+        return !(*this == rhs);
+    }
+
+}  // namespace Rt2::Sockets
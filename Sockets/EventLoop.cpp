@@ -0,0 +1,328 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#include "Sockets/EventLoop.h"
+#if RT_PLATFORM != RT_PLATFORM_WINDOWS
+    #include <poll.h>
+    #include <unistd.h>
+    #if defined(__linux__)
+        #define SOCKETS_USE_EPOLL 1
+        #include <sys/epoll.h>
+        #include <sys/eventfd.h>
+    #endif
+#endif
+
+namespace Rt2::Sockets
+{
+    namespace
+    {
+#ifdef SOCKETS_USE_EPOLL
+        uint32_t toNative(const int events)
+        {
+            uint32_t ev = EPOLLRDHUP;
+            if (events & EventRead)
+                ev |= EPOLLIN;
+            if (events & EventWrite)
+                ev |= EPOLLOUT;
+            return ev;
+        }
+
+        int fromNative(const uint32_t ev)
+        {
+            int events = 0;
+            if (ev & EPOLLIN)
+                events |= EventRead;
+            if (ev & EPOLLOUT)
+                events |= EventWrite;
+            if (ev & (EPOLLHUP | EPOLLERR | EPOLLRDHUP))
+                events |= EventClosed;
+            return events;
+        }
+#else
+    #if RT_PLATFORM == RT_PLATFORM_WINDOWS
+        using PollEntry = WSAPOLLFD;
+    #else
+        using PollEntry = pollfd;
+    #endif
+
+        short toNative(const int events)
+        {
+            short ev = 0;
+            if (events & EventRead)
+                ev |= POLLIN;
+            if (events & EventWrite)
+                ev |= POLLOUT;
+            return ev;
+        }
+
+        int fromNative(const short ev)
+        {
+            int events = 0;
+            if (ev & POLLIN)
+                events |= EventRead;
+            if (ev & POLLOUT)
+                events |= EventWrite;
+            if (ev & (POLLHUP | POLLERR | POLLNVAL))
+                events |= EventClosed;
+            return events;
+        }
+#endif
+    }  // namespace
+
+    EventLoop::EventLoop()
+    {
+        Net::ensureInitialized();
+#ifdef SOCKETS_USE_EPOLL
+        _poller = epoll_create1(EPOLL_CLOEXEC);
+#endif
+        openWake();
+    }
+
+    EventLoop::~EventLoop()
+    {
+#ifdef SOCKETS_USE_EPOLL
+        if (_wake != InvalidSocket)
+            ::close(_wake);
+        if (_poller >= 0)
+            ::close(_poller);
+#else
+        if (_wake != InvalidSocket)
+            Net::close(_wake);
+#endif
+    }
+
+    void EventLoop::openWake()
+    {
+#ifdef SOCKETS_USE_EPOLL
+        _wake = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (_wake < 0 || _poller < 0)
+            return;
+
+        epoll_event ev{};
+        ev.events  = EPOLLIN;
+        ev.data.fd = _wake;
+        epoll_ctl(_poller, EPOLL_CTL_ADD, _wake, &ev);
+#else
+        // a UDP socket connected to itself wakes poll and WSAPoll alike
+        _wake = Net::create(AddressFamilyINet, SocketDatagram, ProtocolIpUdp);
+        if (_wake == InvalidSocket)
+            return;
+
+        SocketInputAddress addr{};
+        Net::Utils::constructInputAddress(addr, AddressFamilyINet, 0, "127.0.0.1");
+
+        socklen_t len = sizeof addr;
+        if (Net::bind(_wake, addr) != OkStatus ||
+            getsockname(_wake, (sockaddr*)&addr, &len) != 0 ||
+            ::connect(_wake, (sockaddr*)&addr, len) != 0)
+        {
+            Net::close(_wake);
+            _wake = InvalidSocket;
+            return;
+        }
+        Net::Utils::setBlocking(_wake, false);
+#endif
+    }
+
+    bool EventLoop::isValid() const
+    {
+#ifdef SOCKETS_USE_EPOLL
+        return _poller >= 0 && _wake != InvalidSocket;
+#else
+        return _wake != InvalidSocket;
+#endif
+    }
+
+    void EventLoop::wake()
+    {
+        // one pending wake-up is enough
+        if (_woken.exchange(true) || _wake == InvalidSocket)
+            return;
+#ifdef SOCKETS_USE_EPOLL
+        const uint64_t one = 1;
+        (void)!::write(_wake, &one, sizeof one);
+#else
+        const char one = 1;
+        send(_wake, &one, 1, 0);
+#endif
+    }
+
+    void EventLoop::drainWake() const
+    {
+#ifdef SOCKETS_USE_EPOLL
+        uint64_t count;
+        (void)!::read(_wake, &count, sizeof count);
+#else
+        char scratch[64];
+        while (recv(_wake, scratch, sizeof scratch, 0) > 0)
+            continue;
+#endif
+    }
+
+    bool EventLoop::add(const PlatformSocket& sock, const int events, const EventHandler& handler)
+    {
+        RT_GUARD_CHECK_RET(sock != InvalidSocket && handler, false)
+        RT_GUARD_RET(!contains(sock), false)
+
+#ifdef SOCKETS_USE_EPOLL
+        epoll_event ev{};
+        ev.events  = toNative(events);
+        ev.data.fd = sock;
+        if (epoll_ctl(_poller, EPOLL_CTL_ADD, sock, &ev) != 0)
+            return false;
+#endif
+        auto watch     = std::make_shared<Watch>();
+        watch->events  = events;
+        watch->handler = handler;
+        _watches.emplace(sock, std::move(watch));
+        return true;
+    }
+
+    bool EventLoop::modify(const PlatformSocket& sock, const int events)
+    {
+        const auto it = _watches.find(sock);
+        RT_GUARD_RET(it != _watches.end(), false)
+        if (it->second->events == events)
+            return true;
+
+#ifdef SOCKETS_USE_EPOLL
+        epoll_event ev{};
+        ev.events  = toNative(events);
+        ev.data.fd = sock;
+        if (epoll_ctl(_poller, EPOLL_CTL_MOD, sock, &ev) != 0)
+            return false;
+#endif
+        it->second->events = events;
+        return true;
+    }
+
+    void EventLoop::remove(const PlatformSocket& sock)
+    {
+        const auto it = _watches.find(sock);
+        RT_GUARD_VOID(it != _watches.end())
+
+#ifdef SOCKETS_USE_EPOLL
+        epoll_event ev{};
+        epoll_ctl(_poller, EPOLL_CTL_DEL, sock, &ev);
+#endif
+        _watches.erase(it);
+    }
+
+    void EventLoop::dispatch(const PlatformSocket sock, const int events)
+    {
+        const auto it = _watches.find(sock);
+        if (it == _watches.end() || events == 0)
+            return;
+
+        // the handler may remove its own watch
+        const WatchPtr watch = it->second;
+        watch->handler(events);
+    }
+
+    void EventLoop::runTasks()
+    {
+        std::vector<LoopTask> tasks;
+        {
+            std::lock_guard guard(_lock);
+            tasks.swap(_tasks);
+        }
+        for (const LoopTask& task : tasks)
+            task();
+    }
+
+    int EventLoop::poll(int timeout)
+    {
+        {
+            std::lock_guard guard(_lock);
+            if (!_tasks.empty())
+                timeout = 0;
+        }
+
+        int ran = 0;
+#ifdef SOCKETS_USE_EPOLL
+        epoll_event events[Default::LoopEvents];
+
+        const int n = epoll_wait(_poller, events, Default::LoopEvents, timeout);
+        for (int i = 0; i < n; ++i)
+        {
+            if (events[i].data.fd == _wake)
+            {
+                _woken = false;
+                drainWake();
+                continue;
+            }
+            dispatch(events[i].data.fd, fromNative(events[i].events));
+            ++ran;
+        }
+#else
+        std::vector<PollEntry> entries;
+        entries.reserve(_watches.size() + 1);
+        entries.push_back({_wake, POLLIN, 0});
+        for (const auto& [sock, watch] : _watches)
+            entries.push_back({sock, toNative(watch->events), 0});
+
+    #if RT_PLATFORM == RT_PLATFORM_WINDOWS
+        const int n = WSAPoll(entries.data(), (ULONG)entries.size(), timeout);
+    #else
+        const int n = ::poll(entries.data(), (nfds_t)entries.size(), timeout);
+    #endif
+        for (size_t i = 0; n > 0 && i < entries.size(); ++i)
+        {
+            if (entries[i].revents == 0)
+                continue;
+            if (i == 0)
+            {
+                _woken = false;
+                drainWake();
+                continue;
+            }
+            dispatch(entries[i].fd, fromNative(entries[i].revents));
+            ++ran;
+        }
+#endif
+        runTasks();
+        return ran;
+    }
+
+    void EventLoop::run()
+    {
+        _running = true;
+        while (_running)
+            poll();
+    }
+
+    void EventLoop::stop()
+    {
+        _running = false;
+        wake();
+    }
+
+    void EventLoop::post(const LoopTask& task)
+    {
+        RT_GUARD_VOID(task)
+        {
+            std::lock_guard guard(_lock);
+            _tasks.push_back(task);
+        }
+        wake();
+    }
+
+}  // namespace Rt2::Sockets
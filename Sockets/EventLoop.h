@@ -0,0 +1,124 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#pragma once
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "Sockets/PlatformSocket.h"
+
+namespace Rt2::Sockets
+{
+    namespace Default
+    {
+        constexpr int LoopEvents  = 0x40;
+        constexpr int LoopTimeOut = 100;
+    }  // namespace Default
+
+    enum EventMask
+    {
+        EventRead   = 0x01,
+        EventWrite  = 0x02,
+        EventClosed = 0x04,  // hang-up or error, reported with any mask
+    };
+
+    using EventHandler = std::function<void(int events)>;
+    using LoopTask     = std::function<void()>;
+
+    // Readiness loop over many sockets: epoll on Linux, poll or WSAPoll
+    // elsewhere. Watches are changed from the loop thread; post is the
+    // way in from any other thread and wakes a loop that is waiting.
+    class EventLoop
+    {
+    private:
+        struct Watch
+        {
+            int          events{0};
+            EventHandler handler;
+        };
+
+        using WatchPtr = std::shared_ptr<Watch>;
+
+        std::unordered_map<PlatformSocket, WatchPtr> _watches;
+        std::vector<LoopTask>                        _tasks;
+        std::mutex                                   _lock;
+        std::atomic<bool>                            _running{false};
+        std::atomic<bool>                            _woken{false};
+        int                                          _poller{-1};
+        PlatformSocket                               _wake{InvalidSocket};
+
+        void openWake();
+
+        void drainWake() const;
+
+        void runTasks();
+
+        void dispatch(PlatformSocket sock, int events);
+
+    public:
+        EventLoop();
+        ~EventLoop();
+
+        EventLoop(const EventLoop&)            = delete;
+        EventLoop& operator=(const EventLoop&) = delete;
+
+        bool isValid() const;
+
+        bool add(const PlatformSocket& sock, int events, const EventHandler& handler);
+
+        bool modify(const PlatformSocket& sock, int events);
+
+        void remove(const PlatformSocket& sock);
+
+        bool contains(const PlatformSocket& sock) const;
+
+        size_t size() const;
+
+        // Waits up to timeout milliseconds, runs the handlers of ready
+        // sockets and then any posted tasks. Returns the number of
+        // handlers run.
+        int poll(int timeout = Default::LoopTimeOut);
+
+        // Polls until stop is called.
+        void run();
+
+        void stop();
+
+        // Queues a task for the loop thread; safe from any thread.
+        void post(const LoopTask& task);
+
+        void wake();
+    };
+
+    inline bool EventLoop::contains(const PlatformSocket& sock) const
+    {
+        return _watches.find(sock) != _watches.end();
+    }
+
+    inline size_t EventLoop::size() const
+    {
+        return _watches.size();
+    }
+
+}  // namespace Rt2::Sockets
@@ -21,42 +21,149 @@
 */
 #include "Sockets/ExitSignal.h"
 #include <csignal>
-#include <iostream>
-#include "Utils/Console.h"
+#if RT_PLATFORM != RT_PLATFORM_WINDOWS
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <cerrno>
+#endif
 
 namespace Rt2::Sockets
 {
     ExitSignal*        ExitSignal::_signal   = nullptr;
     ExitSignal::Signal ExitSignal::_function = nullptr;
-    SignalHandler      ExitSignal::_prevInt  = nullptr;
-    SignalHandler      ExitSignal::_prevTerm = nullptr;
+#if RT_PLATFORM == RT_PLATFORM_WINDOWS
+    SignalHandler ExitSignal::_prevInt  = nullptr;
+    SignalHandler ExitSignal::_prevTerm = nullptr;
+#else
+    struct sigaction ExitSignal::_prevInt  = {};
+    struct sigaction ExitSignal::_prevTerm = {};
+#endif
+    std::atomic<bool> ExitSignal::_raised{false};
+    PlatformSocket    ExitSignal::_read  = InvalidSocket;
+    PlatformSocket    ExitSignal::_write = InvalidSocket;
+    std::mutex        ExitSignal::_lock;
+    int               ExitSignal::_users = 0;
 
     void ExitSignal::signalMethod(const int sig)
     {
-        if (_signal)
-            _signal->_signaled = true;
-        if (_function)
-            _function();
-
-        std::cin.clear();
-        std::cin.putback('\n');
+        _raised.store(true);
 
+        const char one = 1;
+#if RT_PLATFORM == RT_PLATFORM_WINDOWS
+        // Windows runs the handler on its own thread and resets it to
+        // the default afterwards, so sending and reinstalling are fine
+        if (_write != InvalidSocket)
+            send(_write, &one, 1, 0);
         (void)std::signal(sig, signalMethod);
+#else
+        (void)sig;
+
+        const int saved = errno;
+        if (_write != InvalidSocket)
+            (void)!::write(_write, &one, 1);
+        errno = saved;
+#endif
+    }
+
+    void ExitSignal::openPipe()
+    {
+#if RT_PLATFORM == RT_PLATFORM_WINDOWS
+        // a UDP socket connected to itself stands in for the pipe
+        const PlatformSocket sock = Net::create(AddressFamilyINet, SocketDatagram, ProtocolIpUdp);
+        if (sock == InvalidSocket)
+            return;
+
+        SocketInputAddress addr{};
+        Net::Utils::constructInputAddress(addr, AddressFamilyINet, 0, "127.0.0.1");
+
+        int len = sizeof addr;
+        if (Net::bind(sock, addr) != OkStatus ||
+            getsockname(sock, (sockaddr*)&addr, &len) != 0 ||
+            ::connect(sock, (sockaddr*)&addr, len) != 0)
+        {
+            Net::close(sock);
+            return;
+        }
+        Net::Utils::setBlocking(sock, false);
+        _read = _write = sock;
+#else
+        int fds[2];
+        if (pipe(fds) != 0)
+            return;
+
+        for (const int fd : fds)
+        {
+            fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+            fcntl(fd, F_SETFD, FD_CLOEXEC);
+        }
+        _read  = fds[0];
+        _write = fds[1];
+#endif
+    }
+
+    void ExitSignal::closePipe()
+    {
+        const PlatformSocket read  = _read;
+        const PlatformSocket write = _write;
+
+        _write = InvalidSocket;
+        _read  = InvalidSocket;
+#if RT_PLATFORM == RT_PLATFORM_WINDOWS
+        if (read != InvalidSocket)
+            Net::close(read);
+        (void)write;
+#else
+        if (write != InvalidSocket)
+            ::close(write);
+        if (read != InvalidSocket)
+            ::close(read);
+#endif
     }
 
     ExitSignal::ExitSignal()
     {
-        _signal   = this;
+        Net::ensureInitialized();
+
+        std::lock_guard lock(_lock);
+        _signal = this;
+        if (_users++ > 0)
+            return;
+
+        _raised = false;
+        openPipe();
+
+#if RT_PLATFORM == RT_PLATFORM_WINDOWS
         _prevInt  = std::signal(SIGINT, signalMethod);
         _prevTerm = std::signal(SIGTERM, signalMethod);
+#else
+        struct sigaction act = {};
+
+        act.sa_handler = signalMethod;
+        act.sa_flags   = SA_RESTART;
+        sigemptyset(&act.sa_mask);
+
+        sigaction(SIGINT, &act, &_prevInt);
+        sigaction(SIGTERM, &act, &_prevTerm);
+#endif
     }
 
     ExitSignal::~ExitSignal()
     {
-        _signal = nullptr;
+        std::lock_guard lock(_lock);
+        if (_signal == this)
+            _signal = nullptr;
+        if (--_users > 0)
+            return;
 
-        (void)std::signal(SIGINT, _prevInt);
-        (void)std::signal(SIGTERM, _prevTerm);
+        // restore before closing so no handler writes to a closed pipe
+#if RT_PLATFORM == RT_PLATFORM_WINDOWS
+        (void)std::signal(SIGINT, _prevInt ? _prevInt : SIG_DFL);
+        (void)std::signal(SIGTERM, _prevTerm ? _prevTerm : SIG_DFL);
+#else
+        sigaction(SIGINT, &_prevInt, nullptr);
+        sigaction(SIGTERM, &_prevTerm, nullptr);
+#endif
+        closePipe();
     }
 
     void ExitSignal::signal()
@@ -68,4 +175,31 @@ namespace Rt2::Sockets
     {
         _function = fn;
     }
+
+    bool ExitSignal::dispatch()
+    {
+        if (!_raised.load())
+            return false;
+
+        if (!_dispatched.exchange(true) && _function)
+            _function();
+        return true;
+    }
+
+    void ExitSignal::reset()
+    {
+        char scratch[16];
+#if RT_PLATFORM == RT_PLATFORM_WINDOWS
+        while (recv(_read, scratch, sizeof scratch, 0) > 0)
+        {
+        }
+#else
+        while (::read(_read, scratch, sizeof scratch) > 0)
+        {
+        }
+#endif
+        _raised     = false;
+        _dispatched = false;
+    }
+
 }  // namespace Rt2::Sockets
@@ -20,27 +20,61 @@
 -------------------------------------------------------------------------------
 */
 #pragma once
+#include <atomic>
+#include <csignal>
 #include <functional>
+#include <mutex>
+#include "Sockets/PlatformSocket.h"
 
 namespace Rt2::Sockets
 {
 
     typedef void (*SignalHandler)(int);
 
+    // Turns SIGINT and SIGTERM into a readable handle. The handler only
+    // sets a flag and writes one byte to a self-pipe, both of which are
+    // async-signal-safe; everything else happens on the thread that
+    // watches handle(), usually from an EventLoop. A self-pipe rather
+    // than signalfd, since signalfd needs the signals blocked in every
+    // thread before any are started.
+    //
+    // handle() stays readable from the first signal until reset, so any
+    // number of loops can watch it without stealing the wake-up from
+    // each other.
+    //
+    // A process has one set of handlers, so the pipe and the raised flag
+    // are shared by every instance. The first instance opens the pipe and
+    // installs the handlers, the last one restores the previous
+    // dispositions and closes it; reset on any instance clears the flag
+    // for all of them.
     class ExitSignal
     {
     private:
         using Signal = std::function<void()>;
 
     private:
-        static ExitSignal*   _signal;
+        static ExitSignal* _signal;
+#if RT_PLATFORM == RT_PLATFORM_WINDOWS
         static SignalHandler _prevInt;
         static SignalHandler _prevTerm;
-        static Signal        _function;
-        bool                 _signaled{false};
+#else
+        static struct sigaction _prevInt;
+        static struct sigaction _prevTerm;
+#endif
+        static Signal            _function;
+        static std::atomic<bool> _raised;
+        static PlatformSocket    _read;
+        static PlatformSocket    _write;
+        static std::mutex        _lock;
+        static int               _users;
+        std::atomic<bool>        _dispatched{false};
 
         static void signalMethod(int);
 
+        static void openPipe();
+
+        static void closePipe();
+
     public:
         explicit ExitSignal();
 
@@ -48,14 +82,27 @@ namespace Rt2::Sockets
 
         static void signal();
 
+        // Runs from dispatch, never inside the signal handler.
         static void bind(const Signal& fn);
 
         bool signaled() const;
+
+        PlatformSocket handle() const;
+
+        // Runs the bound function once per signal. Returns signaled().
+        bool dispatch();
+
+        void reset();
     };
 
     inline bool ExitSignal::signaled() const
     {
-        return _signaled;
+        return _raised.load();
+    }
+
+    inline PlatformSocket ExitSignal::handle() const
+    {
+        return _read;
     }
 
 }  // namespace Rt2::Sockets
@@ -0,0 +1,123 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#include "Sockets/Frame.h"
+
+namespace Rt2::Sockets
+{
+    namespace
+    {
+        uint32_t readBig32(const char* src)
+        {
+            return (uint32_t)(uint8_t)src[0] << 24 |
+                   (uint32_t)(uint8_t)src[1] << 16 |
+                   (uint32_t)(uint8_t)src[2] << 8 |
+                   (uint32_t)(uint8_t)src[3];
+        }
+
+        void writeBig32(char* dest, const uint32_t val)
+        {
+            dest[0] = (char)(val >> 24);
+            dest[1] = (char)(val >> 16);
+            dest[2] = (char)(val >> 8);
+            dest[3] = (char)val;
+        }
+    }  // namespace
+
+    void FrameCodec::header(char* dest, const uint32_t id, const size_t length)
+    {
+        writeBig32(dest, (uint32_t)length);
+        writeBig32(dest + 4, id);
+    }
+
+    void FrameCodec::encode(String& dest, const uint32_t id, const std::string_view payload)
+    {
+        char head[Default::FrameHeader];
+        header(head, id, payload.size());
+        dest.append(head, Default::FrameHeader);
+        dest.append(payload.data(), payload.size());
+    }
+
+    FrameDecodeStatus FrameCodec::decode(const char*  data,
+                                         const size_t size,
+                                         Frame&       dest,
+                                         size_t&      consumed,
+                                         const size_t maxPayload)
+    {
+        consumed = 0;
+        if (size < Default::FrameHeader)
+            return FrameIncomplete;
+
+        const size_t length = readBig32(data);
+        if (length > maxPayload)
+            return FrameTooLarge;
+        if (size - Default::FrameHeader < length)
+            return FrameIncomplete;
+
+        dest.id      = readBig32(data + 4);
+        dest.payload = {data + Default::FrameHeader, length};
+        consumed     = Default::FrameHeader + length;
+        return FrameComplete;
+    }
+
+    Status FrameCodec::read(const PlatformSocket& sock,
+                            RecvBuffer&           buffer,
+                            Frame&                dest,
+                            size_t&               consumed,
+                            const int             timeout,
+                            const size_t          maxPayload)
+    {
+        for (;;)
+        {
+            switch (decode(buffer.data(), buffer.size(), dest, consumed, maxPayload))
+            {
+            case FrameComplete:
+                return OkStatus;
+            case FrameTooLarge:
+                return ErrorStatus;
+            case FrameIncomplete:
+                break;
+            }
+
+            if (const Status st = buffer.fill(sock, timeout); st != OkStatus)
+                return st;
+        }
+    }
+
+    Status FrameCodec::write(const PlatformSocket&  sock,
+                             const uint32_t         id,
+                             const std::string_view payload,
+                             const int              timeout)
+    {
+        char head[Default::FrameHeader];
+        header(head, id, payload.size());
+
+        IoVector vec[2];
+        Net::Utils::makeVector(vec[0], head, Default::FrameHeader);
+        Net::Utils::makeVector(vec[1], payload.data(), payload.size());
+
+        const int total = (int)(Default::FrameHeader + payload.size());
+        return Net::writeVector(sock, vec, payload.empty() ? 1 : 2, timeout) == total
+                   ? OkStatus
+                   : ErrorStatus;
+    }
+
+}  // namespace Rt2::Sockets
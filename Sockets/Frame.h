@@ -0,0 +1,82 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#pragma once
+#include <string_view>
+#include "Sockets/RecvBuffer.h"
+
+namespace Rt2::Sockets
+{
+    namespace Default
+    {
+        constexpr size_t FrameHeader     = 8;
+        constexpr size_t FrameMaxPayload = 0x100000;
+    }  // namespace Default
+
+    enum FrameDecodeStatus
+    {
+        FrameIncomplete,
+        FrameComplete,
+        FrameTooLarge,
+    };
+
+    // A request or response tagged with the id that pairs them. The
+    // view points into the receive buffer and is valid until the next
+    // read from it.
+    struct Frame
+    {
+        uint32_t         id{0};
+        std::string_view payload;
+    };
+
+    // Length prefixed messages: a big endian payload length and a big
+    // endian correlation id, followed by the payload.
+    class FrameCodec
+    {
+    public:
+        // Writes the Default::FrameHeader bytes in front of a payload.
+        static void header(char* dest, uint32_t id, size_t length);
+
+        static void encode(String& dest, uint32_t id, std::string_view payload);
+
+        static FrameDecodeStatus decode(const char* data,
+                                        size_t      size,
+                                        Frame&      dest,
+                                        size_t&     consumed,
+                                        size_t      maxPayload = Default::FrameMaxPayload);
+
+        // Receives until a whole frame is buffered and points dest at
+        // it. The caller consumes it once it is done with the payload.
+        static Status read(const PlatformSocket& sock,
+                           RecvBuffer&           buffer,
+                           Frame&                dest,
+                           size_t&               consumed,
+                           int                   timeout    = Default::SocketTimeOut,
+                           size_t                maxPayload = Default::FrameMaxPayload);
+
+        // Writes the header and payload with one gather write.
+        static Status write(const PlatformSocket& sock,
+                            uint32_t              id,
+                            std::string_view      payload,
+                            int                   timeout = Default::SocketTimeOut);
+    };
+
+}  // namespace Rt2::Sockets
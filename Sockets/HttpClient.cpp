@@ -0,0 +1,407 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#include "Sockets/HttpClient.h"
+#include "Sockets/Simd.h"
+
+namespace Rt2::Sockets
+{
+    namespace
+    {
+        String originOf(const String& ipv4, const uint16_t port)
+        {
+            OutputStringStream oss;
+            oss << ipv4 << ':' << port;
+            return oss.str();
+        }
+
+        bool hasField(const std::vector<HttpField>& fields, const std::string_view name)
+        {
+            for (const HttpField& field : fields)
+            {
+                if (HttpParser::equals(field.name, name))
+                    return true;
+            }
+            return false;
+        }
+    }  // namespace
+
+    String HttpReply::header(const std::string_view name) const
+    {
+        for (const HttpField& field : headers)
+        {
+            if (HttpParser::equals(field.name, name))
+                return field.value;
+        }
+        return {};
+    }
+
+    HttpClient::Link::Link(const String&       ipv4,
+                           const uint16_t      port,
+                           const SocketConfig& config) :
+        socket(ipv4, port, config)
+    {
+    }
+
+    HttpClient::HttpClient(const SocketConfig& config) :
+        _config(config)
+    {
+    }
+
+    HttpClient::~HttpClient()
+    {
+        close();
+    }
+
+    HttpClient::LinkPtr HttpClient::checkout(const String& ipv4, const uint16_t port, bool& reused)
+    {
+        {
+            std::lock_guard guard(_lock);
+            if (const auto it = _idle.find(originOf(ipv4, port)); it != _idle.end())
+            {
+                std::vector<LinkPtr>& links = it->second;
+                while (!links.empty())
+                {
+                    LinkPtr link = std::move(links.back());
+                    links.pop_back();
+
+                    // An idle connection has nothing to read unless the
+                    // server closed it, so a readable one is dropped.
+                    if (!link->buffer.empty() || Net::poll(link->socket.socket(), 0, Read))
+                        continue;
+
+                    reused = true;
+                    return link;
+                }
+            }
+        }
+
+        reused = false;
+
+        auto link = std::make_unique<Link>(ipv4, port, _config);
+        if (!link->socket.isValid())
+            return nullptr;
+        return link;
+    }
+
+    void HttpClient::checkin(const String& ipv4, const uint16_t port, LinkPtr link)
+    {
+        std::lock_guard guard(_lock);
+
+        std::vector<LinkPtr>& links = _idle[originOf(ipv4, port)];
+        if (links.size() < _maxIdle)
+            links.push_back(std::move(link));
+    }
+
+    void HttpClient::serialize(String& dest, const HttpCall& call, const String& host)
+    {
+        OutputStringStream oss;
+        oss << call.method << ' ' << call.target << " HTTP/1.1\r\n";
+        if (!hasField(call.headers, "Host"))
+            oss << "Host: " << host << "\r\n";
+        for (const HttpField& field : call.headers)
+            oss << field.name << ": " << field.value << "\r\n";
+        if (!call.body.empty() || call.method == "POST" || call.method == "PUT")
+            oss << "Content-Length: " << call.body.size() << "\r\n";
+        oss << "\r\n";
+
+        dest.append(oss.str());
+        dest.append(call.body);
+    }
+
+    Status HttpClient::readHead(Link& link, HttpReply& reply) const
+    {
+        for (;;)
+        {
+            size_t           scanned = 0;
+            size_t           pos;
+            std::string_view view;
+            for (;;)
+            {
+                view = link.buffer.view();
+                pos  = Simd::find(view, "\r\n\r\n", scanned);
+                if (pos != std::string_view::npos)
+                    break;
+                if (view.size() > Default::HttpMaxHead)
+                    return ErrorStatus;
+                scanned = view.size() >= 3 ? view.size() - 3 : 0;
+
+                // closing before any byte is reported as ClosedStatus,
+                // which tells a stale pooled connection apart
+                if (const Status st = link.buffer.fill(link.socket.socket(), _timeout); st != OkStatus)
+                    return st == ClosedStatus && !view.empty() ? ErrorStatus : st;
+            }
+
+            HttpResponseHead head;
+            if (HttpParser::parseResponse(view.substr(0, pos + 4), head) != HttpComplete)
+                return ErrorStatus;
+
+            reply.status        = head.status;
+            reply.reason        = String(head.reason);
+            reply.contentLength = head.contentLength;
+            reply.hasLength     = head.hasLength;
+            reply.chunked       = head.chunked;
+            reply.keepAlive     = head.keepAlive;
+            reply.headers.clear();
+            reply.headers.reserve(head.headerCount);
+            for (size_t i = 0; i < head.headerCount; ++i)
+                reply.headers.push_back({String(head.headers[i].name), String(head.headers[i].value)});
+
+            link.buffer.consume(pos + 4);
+
+            // interim responses precede the real one
+            if (head.status < 100 || head.status >= 200 || head.status == 101)
+                return OkStatus;
+        }
+    }
+
+    Status HttpClient::stream(Link& link, size_t length, const HttpBodySink& sink) const
+    {
+        while (length > 0)
+        {
+            if (link.buffer.empty())
+            {
+                if (const Status st = link.buffer.fill(link.socket.socket(), _timeout); st != OkStatus)
+                    return st == ClosedStatus ? ErrorStatus : st;
+            }
+
+            const size_t n = length < link.buffer.size() ? length : link.buffer.size();
+            if (sink)
+                sink({link.buffer.data(), n});
+            link.buffer.consume(n);
+            length -= n;
+        }
+        return OkStatus;
+    }
+
+    Status HttpClient::readBody(Link&               link,
+                                const HttpCall&     call,
+                                HttpReply&          reply,
+                                const HttpBodySink& sink) const
+    {
+        if (call.method == "HEAD" || reply.status < 200 || reply.status == 204 || reply.status == 304)
+            return OkStatus;
+
+        const PlatformSocket& sock = link.socket.socket();
+        if (reply.chunked)
+        {
+            std::string_view line;
+            for (;;)
+            {
+                if (const Status st = link.buffer.readUntil(sock, "\r\n", line, _timeout); st != OkStatus)
+                    return st;
+
+                size_t size = 0;
+                if (!HttpParser::parseChunkSize(line, size))
+                    return ErrorStatus;
+                if (size == 0)
+                    break;
+
+                if (const Status st = stream(link, size, sink); st != OkStatus)
+                    return st;
+                if (link.buffer.readUntil(sock, "\r\n", line, _timeout) != OkStatus || !line.empty())
+                    return ErrorStatus;
+            }
+
+            // trailer fields are skipped
+            do
+            {
+                if (const Status st = link.buffer.readUntil(sock, "\r\n", line, _timeout); st != OkStatus)
+                    return st;
+            } while (!line.empty());
+            return OkStatus;
+        }
+
+        if (reply.hasLength)
+            return stream(link, reply.contentLength, sink);
+
+        // without framing the body ends when the server closes
+        reply.keepAlive = false;
+        for (;;)
+        {
+            if (!link.buffer.empty())
+            {
+                if (sink)
+                    sink(link.buffer.view());
+                link.buffer.consume(link.buffer.size());
+            }
+
+            const Status st = link.buffer.fill(sock, _timeout);
+            if (st == ClosedStatus)
+                return OkStatus;
+            if (st != OkStatus)
+                return st;
+        }
+    }
+
+    Status HttpClient::exchange(const String&                ipv4,
+                                const uint16_t               port,
+                                const std::vector<HttpCall>& calls,
+                                std::vector<HttpReply>&      replies,
+                                const HttpPipelineSink&      sink)
+    {
+        RT_GUARD_RET(!calls.empty(), ErrorStatus)
+
+        const String host = originOf(ipv4, port);
+
+        String out;
+        for (const HttpCall& call : calls)
+            serialize(out, call, host);
+
+        for (int attempt = 0; attempt < 2; ++attempt)
+        {
+            bool    reused = false;
+            LinkPtr link   = checkout(ipv4, port, reused);
+            if (!link)
+                return ErrorStatus;
+
+            replies.assign(calls.size(), {});
+
+            Status st = OkStatus;
+            if (Net::writeSocket(link->socket.socket(), out.data(), out.size(), _timeout) != (int)out.size())
+                st = ClosedStatus;
+
+            size_t done = 0;
+            while (st == OkStatus && done < calls.size())
+            {
+                HttpReply& reply = replies[done];
+
+                st = readHead(*link, reply);
+                if (st == OkStatus)
+                {
+                    st = readBody(*link,
+                                  calls[done],
+                                  reply,
+                                  [&sink, done](const std::string_view data)
+                                  {
+                                      if (sink)
+                                          sink(done, data);
+                                  });
+                }
+                if (st != OkStatus)
+                    break;
+
+                ++done;
+                if (!reply.keepAlive)
+                    break;
+            }
+
+            // the server may have dropped a pooled connection while it
+            // sat idle; nothing was answered yet, so try a fresh one
+            if (st == ClosedStatus && reused && done == 0)
+                continue;
+
+            if (st != OkStatus)
+                return st;
+            if (done < calls.size())
+                return ClosedStatus;
+
+            if (replies.back().keepAlive)
+                checkin(ipv4, port, std::move(link));
+            return OkStatus;
+        }
+        return ClosedStatus;
+    }
+
+    Status HttpClient::send(const String&       ipv4,
+                            const uint16_t      port,
+                            const HttpCall&     call,
+                            HttpReply&          reply,
+                            const HttpBodySink& sink)
+    {
+        std::vector<HttpReply> replies;
+
+        const Status st = exchange(ipv4,
+                                   port,
+                                   {call},
+                                   replies,
+                                   [&sink](size_t, const std::string_view data)
+                                   {
+                                       if (sink)
+                                           sink(data);
+                                   });
+        if (!replies.empty())
+            reply = std::move(replies.front());
+        return st;
+    }
+
+    Status HttpClient::send(const String&   ipv4,
+                            const uint16_t  port,
+                            const HttpCall& call,
+                            HttpReply&      reply,
+                            OStream&        body)
+    {
+        return send(ipv4,
+                    port,
+                    call,
+                    reply,
+                    [&body](const std::string_view data)
+                    { body.write(data.data(), (std::streamsize)data.size()); });
+    }
+
+    Status HttpClient::get(const String&       ipv4,
+                           const uint16_t      port,
+                           const String&       target,
+                           HttpReply&          reply,
+                           const HttpBodySink& sink)
+    {
+        HttpCall call;
+        call.target = target;
+        return send(ipv4, port, call, reply, sink);
+    }
+
+    Status HttpClient::pipeline(const String&                ipv4,
+                                const uint16_t               port,
+                                const std::vector<HttpCall>& calls,
+                                std::vector<HttpReply>&      replies,
+                                const HttpPipelineSink&      sink)
+    {
+        return exchange(ipv4, port, calls, replies, sink);
+    }
+
+    size_t HttpClient::idleConnections() const
+    {
+        std::lock_guard guard(_lock);
+
+        size_t count = 0;
+        for (const auto& [origin, links] : _idle)
+            count += links.size();
+        return count;
+    }
+
+    void HttpClient::setMaxIdle(const size_t count)
+    {
+        std::lock_guard guard(_lock);
+        _maxIdle = count;
+    }
+
+    void HttpClient::setTimeout(const int ms)
+    {
+        _timeout = ms;
+    }
+
+    void HttpClient::close()
+    {
+        std::lock_guard guard(_lock);
+        _idle.clear();
+    }
+
+}  // namespace Rt2::Sockets
@@ -0,0 +1,154 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#pragma once
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "Sockets/ClientSocket.h"
+#include "Sockets/HttpParser.h"
+#include "Sockets/RecvBuffer.h"
+
+namespace Rt2::Sockets
+{
+    namespace Default
+    {
+        constexpr size_t HttpMaxIdle = 0x08;
+    }
+
+    struct HttpField
+    {
+        String name;
+        String value;
+    };
+
+    struct HttpCall
+    {
+        String                 method{"GET"};
+        String                 target{"/"};
+        std::vector<HttpField> headers;
+        String                 body;
+    };
+
+    struct HttpReply
+    {
+        int                    status{0};
+        String                 reason;
+        std::vector<HttpField> headers;
+        size_t                 contentLength{0};
+        bool                   hasLength{false};
+        bool                   chunked{false};
+        bool                   keepAlive{true};
+
+        // Case-insensitive lookup; returns an empty string when missing.
+        String header(std::string_view name) const;
+    };
+
+    // Receives body bytes as they arrive. The view is only valid for
+    // the duration of the call.
+    using HttpBodySink     = std::function<void(std::string_view data)>;
+    using HttpPipelineSink = std::function<void(size_t index, std::string_view data)>;
+
+    // HTTP/1.1 client that keeps connections open per origin and hands
+    // response bodies to a sink as they are received, so a body is never
+    // held in memory as a whole.
+    class HttpClient
+    {
+    private:
+        struct Link
+        {
+            ClientSocket socket;
+            RecvBuffer   buffer;
+
+            Link(const String& ipv4, uint16_t port, const SocketConfig& config);
+        };
+
+        using LinkPtr = std::unique_ptr<Link>;
+
+        mutable std::mutex                               _lock;
+        std::unordered_map<String, std::vector<LinkPtr>> _idle;
+        SocketConfig                                     _config;
+        size_t                                           _maxIdle{Default::HttpMaxIdle};
+        int                                              _timeout{Default::SocketTimeOut};
+
+        LinkPtr checkout(const String& ipv4, uint16_t port, bool& reused);
+
+        void checkin(const String& ipv4, uint16_t port, LinkPtr link);
+
+        Status exchange(const String&                ipv4,
+                        uint16_t                     port,
+                        const std::vector<HttpCall>& calls,
+                        std::vector<HttpReply>&      replies,
+                        const HttpPipelineSink&      sink);
+
+        Status readHead(Link& link, HttpReply& reply) const;
+
+        Status readBody(Link&               link,
+                        const HttpCall&     call,
+                        HttpReply&          reply,
+                        const HttpBodySink& sink) const;
+
+        Status stream(Link& link, size_t length, const HttpBodySink& sink) const;
+
+        static void serialize(String& dest, const HttpCall& call, const String& host);
+
+    public:
+        explicit HttpClient(const SocketConfig& config = {});
+        ~HttpClient();
+
+        Status send(const String&       ipv4,
+                    uint16_t            port,
+                    const HttpCall&     call,
+                    HttpReply&          reply,
+                    const HttpBodySink& sink);
+
+        Status send(const String&   ipv4,
+                    uint16_t        port,
+                    const HttpCall& call,
+                    HttpReply&      reply,
+                    OStream&        body);
+
+        Status get(const String&       ipv4,
+                   uint16_t            port,
+                   const String&       target,
+                   HttpReply&          reply,
+                   const HttpBodySink& sink);
+
+        // Writes every call before reading any reply; the replies come
+        // back in order on the same connection.
+        Status pipeline(const String&                ipv4,
+                        uint16_t                     port,
+                        const std::vector<HttpCall>& calls,
+                        std::vector<HttpReply>&      replies,
+                        const HttpPipelineSink&      sink);
+
+        size_t idleConnections() const;
+
+        void setMaxIdle(size_t count);
+
+        void setTimeout(int ms);
+
+        void close();
+    };
+
+}  // namespace Rt2::Sockets
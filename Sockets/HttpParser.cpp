@@ -0,0 +1,461 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#include "Sockets/HttpParser.h"
+#include <cstring>
+#include "Sockets/Simd.h"
+
+namespace Rt2::Sockets
+{
+    namespace
+    {
+        constexpr std::string_view Crlf        = "\r\n";
+        constexpr size_t           MaxSizeLine = 0x400;
+
+        char lower(const char ch)
+        {
+            return ch >= 'A' && ch <= 'Z' ? (char)(ch - 'A' + 'a') : ch;
+        }
+
+        std::string_view trim(std::string_view value)
+        {
+            while (!value.empty() && (value.front() == ' ' || value.front() == '\t'))
+                value.remove_prefix(1);
+            while (!value.empty() && (value.back() == ' ' || value.back() == '\t'))
+                value.remove_suffix(1);
+            return value;
+        }
+
+        std::string_view lastToken(const std::string_view value)
+        {
+            const size_t comma = value.rfind(',');
+            return trim(comma == std::string_view::npos ? value : value.substr(comma + 1));
+        }
+
+        bool toSize(const std::string_view value, size_t& dest)
+        {
+            if (value.empty())
+                return false;
+
+            dest = 0;
+            for (const char ch : value)
+            {
+                if (ch < '0' || ch > '9')
+                    return false;
+                if (dest > (SIZE_MAX - 9) / 10)
+                    return false;
+                dest = dest * 10 + (size_t)(ch - '0');
+            }
+            return true;
+        }
+
+        int hexDigit(const char ch)
+        {
+            if (ch >= '0' && ch <= '9')
+                return ch - '0';
+            const char lc = lower(ch);
+            if (lc >= 'a' && lc <= 'f')
+                return lc - 'a' + 10;
+            return -1;
+        }
+
+        // Splits the CRLF terminated "name: value" lines in [cur, end).
+        HttpParseStatus parseFields(const char* cur,
+                                    const char* end,
+                                    HttpHeader* headers,
+                                    size_t&     count)
+        {
+            count = 0;
+            for (const char* eol; cur < end; cur = eol + 1)
+            {
+                eol = Simd::find(cur, end, '\n');
+                if (eol == end || eol == cur || eol[-1] != '\r')
+                    return HttpBadRequest;
+
+                const std::string_view field(cur, (size_t)(eol - 1 - cur));
+
+                // obsolete line folding is rejected, as RFC 7230 allows
+                if (field.empty() || field.front() == ' ' || field.front() == '\t')
+                    return HttpBadRequest;
+
+                const size_t colon = field.find(':');
+                if (colon == std::string_view::npos || colon == 0)
+                    return HttpBadRequest;
+
+                const std::string_view name = field.substr(0, colon);
+                if (name.back() == ' ' || name.back() == '\t')
+                    return HttpBadRequest;
+
+                if (count >= Default::HttpMaxHeaders)
+                    return HttpHeadTooLarge;
+
+                headers[count++] = {name, trim(field.substr(colon + 1))};
+            }
+            return HttpComplete;
+        }
+
+        std::string_view findHeader(const HttpHeader*      headers,
+                                    const size_t           count,
+                                    const std::string_view name)
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                if (HttpParser::equals(headers[i].name, name))
+                    return headers[i].value;
+            }
+            return {};
+        }
+
+        bool keepAliveFor(const int minor, const std::string_view connection)
+        {
+            if (HttpParser::hasToken(connection, "close"))
+                return false;
+            if (HttpParser::hasToken(connection, "keep-alive"))
+                return true;
+            return minor == 1;
+        }
+
+        void rebase(std::string_view& view, const char* from, const char* to)
+        {
+            if (!view.empty())
+                view = {to + (view.data() - from), view.size()};
+        }
+    }  // namespace
+
+    std::string_view HttpRequest::header(const std::string_view name) const
+    {
+        return findHeader(headers, headerCount, name);
+    }
+
+    std::string_view HttpResponseHead::header(const std::string_view name) const
+    {
+        return findHeader(headers, headerCount, name);
+    }
+
+    bool HttpParser::hasToken(std::string_view value, const std::string_view token)
+    {
+        while (!value.empty())
+        {
+            const size_t comma = value.find(',');
+            if (equals(trim(value.substr(0, comma)), token))
+                return true;
+            if (comma == std::string_view::npos)
+                break;
+            value.remove_prefix(comma + 1);
+        }
+        return false;
+    }
+
+    bool HttpParser::equals(const std::string_view a, const std::string_view b)
+    {
+        if (a.size() != b.size())
+            return false;
+        for (size_t i = 0; i < a.size(); ++i)
+        {
+            if (lower(a[i]) != lower(b[i]))
+                return false;
+        }
+        return true;
+    }
+
+    bool HttpParser::parseChunkSize(const std::string_view line, size_t& dest)
+    {
+        dest = 0;
+
+        size_t digits = 0;
+        for (const char ch : line)
+        {
+            const int hex = hexDigit(ch);
+            if (hex < 0)
+                break;
+            if (dest > (SIZE_MAX >> 4))
+                return false;
+            dest = dest * 16 + (size_t)hex;
+            ++digits;
+        }
+
+        // anything after the digits must be a chunk extension
+        if (digits == 0)
+            return false;
+        const std::string_view rest = trim(line.substr(digits));
+        return rest.empty() || rest.front() == ';';
+    }
+
+    HttpParseStatus HttpParser::parseResponse(const std::string_view head, HttpResponseHead& dest)
+    {
+        if (head.size() < 4 || head.substr(head.size() - 4) != "\r\n\r\n")
+            return HttpIncomplete;
+
+        const char* cur = head.data();
+        const char* end = cur + head.size() - 2;
+
+        // status-line = HTTP-version SP status-code SP [ reason-phrase ]
+        const char* eol = Simd::find(cur, end, '\n');
+        if (eol == cur || eol[-1] != '\r')
+            return HttpBadRequest;
+
+        const std::string_view line(cur, (size_t)(eol - 1 - cur));
+        if (line.size() < 12 || line[8] != ' ')
+            return HttpBadRequest;
+
+        const std::string_view version = line.substr(0, 8);
+        if (version == "HTTP/1.1")
+            dest.minor = 1;
+        else if (version == "HTTP/1.0")
+            dest.minor = 0;
+        else
+            return HttpBadRequest;
+
+        dest.status = 0;
+        for (size_t i = 9; i < 12; ++i)
+        {
+            if (line[i] < '0' || line[i] > '9')
+                return HttpBadRequest;
+            dest.status = dest.status * 10 + (line[i] - '0');
+        }
+        dest.reason = line.size() > 13 ? line.substr(13) : std::string_view{};
+
+        if (const HttpParseStatus st = parseFields(eol + 1, end, dest.headers, dest.headerCount);
+            st != HttpComplete)
+            return st;
+
+        dest.keepAlive     = keepAliveFor(dest.minor, dest.header("Connection"));
+        dest.chunked       = false;
+        dest.hasLength     = false;
+        dest.contentLength = 0;
+
+        // Transfer-Encoding overrides Content-Length, and any other
+        // coding is delimited by the close
+        if (const std::string_view te = dest.header("Transfer-Encoding"); !te.empty())
+        {
+            dest.chunked = equals(lastToken(te), "chunked");
+            if (!dest.chunked)
+                dest.keepAlive = false;
+        }
+        else if (const std::string_view cl = dest.header("Content-Length"); !cl.empty())
+        {
+            if (!toSize(cl, dest.contentLength))
+                return HttpBadRequest;
+            dest.hasLength = true;
+        }
+        return HttpComplete;
+    }
+
+    void HttpParser::reset()
+    {
+        _phase   = PhaseHead;
+        _base    = nullptr;
+        _scanned = 0;
+        _headEnd = 0;
+        _read    = 0;
+        _write   = 0;
+        _chunk   = 0;
+    }
+
+    HttpParseStatus HttpParser::parseHead(const char* data, const size_t size, HttpRequest& dest)
+    {
+        const std::string_view view(data, size);
+
+        const size_t pos = Simd::find(view, "\r\n\r\n", _scanned);
+        if (pos == std::string_view::npos)
+        {
+            if (size > Default::HttpMaxHead)
+                return HttpHeadTooLarge;
+
+            // resume where a partial terminator could begin
+            _scanned = size >= 3 ? size - 3 : 0;
+            return HttpIncomplete;
+        }
+        if (pos + 4 > Default::HttpMaxHead)
+            return HttpHeadTooLarge;
+
+        _headEnd = pos + 4;
+
+        const char* cur = data;
+        const char* end = data + pos + 2;
+
+        // request-line = method SP request-target SP HTTP-version
+        const char* eol = Simd::find(cur, end, '\n');
+        if (eol == cur || eol[-1] != '\r')
+            return HttpBadRequest;
+
+        const std::string_view line(cur, (size_t)(eol - 1 - cur));
+
+        const size_t sp1 = line.find(' ');
+        if (sp1 == std::string_view::npos || sp1 == 0)
+            return HttpBadRequest;
+        const size_t sp2 = line.find(' ', sp1 + 1);
+        if (sp2 == std::string_view::npos || sp2 == sp1 + 1)
+            return HttpBadRequest;
+
+        const std::string_view version = line.substr(sp2 + 1);
+        if (version == "HTTP/1.1")
+            dest.minor = 1;
+        else if (version == "HTTP/1.0")
+            dest.minor = 0;
+        else
+            return HttpBadRequest;
+
+        dest.method    = line.substr(0, sp1);
+        dest.target    = line.substr(sp1 + 1, sp2 - sp1 - 1);
+
+        if (const HttpParseStatus st = parseFields(eol + 1, end, dest.headers, dest.headerCount);
+            st != HttpComplete)
+            return st;
+
+        dest.keepAlive = keepAliveFor(dest.minor, dest.header("Connection"));
+
+        const std::string_view te = dest.header("Transfer-Encoding");
+        const std::string_view cl = dest.header("Content-Length");
+
+        dest.chunked       = false;
+        dest.contentLength = 0;
+        if (!te.empty())
+        {
+            // a request carrying both is a smuggling attempt
+            if (!cl.empty() || !equals(lastToken(te), "chunked"))
+                return HttpBadRequest;
+            dest.chunked = true;
+        }
+        else if (!cl.empty())
+        {
+            if (!toSize(cl, dest.contentLength))
+                return HttpBadRequest;
+            if (dest.contentLength > _maxBody)
+                return HttpBodyTooLarge;
+        }
+        return HttpComplete;
+    }
+
+    HttpParseStatus HttpParser::parseChunks(char* data, const size_t size)
+    {
+        for (;;)
+        {
+            switch (_phase)
+            {
+            case PhaseChunkSize:
+            {
+                const size_t eol = Simd::find(std::string_view(data, size), Crlf, _read);
+                if (eol == std::string_view::npos)
+                    return size - _read > MaxSizeLine ? HttpBadRequest : HttpIncomplete;
+
+                size_t len = 0;
+                if (!parseChunkSize({data + _read, eol - _read}, len))
+                    return HttpBadRequest;
+                if (len > _maxBody - (_write - _headEnd))
+                    return HttpBodyTooLarge;
+
+                _read  = eol + 2;
+                _chunk = len;
+                _phase = len > 0 ? PhaseChunkData : PhaseTrailer;
+                break;
+            }
+            case PhaseChunkData:
+                if (size - _read < _chunk + 2)
+                    return HttpIncomplete;
+                if (data[_read + _chunk] != '\r' || data[_read + _chunk + 1] != '\n')
+                    return HttpBadRequest;
+
+                // the decoded body never outruns the encoded one
+                memmove(data + _write, data + _read, _chunk);
+                _write += _chunk;
+                _read += _chunk + 2;
+                _phase = PhaseChunkSize;
+                break;
+            case PhaseTrailer:
+            {
+                const size_t eol = Simd::find(std::string_view(data, size), Crlf, _read);
+                if (eol == std::string_view::npos)
+                    return size - _read > Default::HttpMaxHead ? HttpHeadTooLarge : HttpIncomplete;
+
+                // trailer fields are skipped
+                const bool last = eol == _read;
+                _read           = eol + 2;
+                if (last)
+                {
+                    _phase = PhaseDone;
+                    return HttpComplete;
+                }
+                break;
+            }
+            default:
+                return HttpBadRequest;
+            }
+        }
+    }
+
+    HttpParseStatus HttpParser::parse(char* data, const size_t size, HttpRequest& dest)
+    {
+        RT_GUARD_RET(data, HttpIncomplete)
+
+        if (_phase == PhaseHead)
+        {
+            if (const HttpParseStatus st = parseHead(data, size, dest); st != HttpComplete)
+                return st;
+
+            _base = data;
+            _read = _write = _headEnd;
+            dest.body      = {};
+            if (dest.chunked)
+                _phase = PhaseChunkSize;
+            else if (dest.contentLength > 0)
+                _phase = PhaseBody;
+            else
+            {
+                _phase = PhaseDone;
+                return HttpComplete;
+            }
+        }
+        else if (_base != data)
+        {
+            // the buffer moved while waiting for the body
+            rebase(dest.method, _base, data);
+            rebase(dest.target, _base, data);
+            for (size_t i = 0; i < dest.headerCount; ++i)
+            {
+                rebase(dest.headers[i].name, _base, data);
+                rebase(dest.headers[i].value, _base, data);
+            }
+            _base = data;
+        }
+
+        switch (_phase)
+        {
+        case PhaseBody:
+            if (size - _headEnd < dest.contentLength)
+                return HttpIncomplete;
+            dest.body = {data + _headEnd, dest.contentLength};
+            _read     = _headEnd + dest.contentLength;
+            _phase    = PhaseDone;
+            return HttpComplete;
+        case PhaseDone:
+            return HttpComplete;
+        default:
+        {
+            const HttpParseStatus st = parseChunks(data, size);
+            if (st == HttpComplete)
+                dest.body = {data + _headEnd, _write - _headEnd};
+            return st;
+        }
+        }
+    }
+
+}  // namespace Rt2::Sockets
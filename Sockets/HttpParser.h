@@ -0,0 +1,160 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#pragma once
+#include <cstdint>
+#include <string_view>
+#include "Utils/Definitions.h"
+
+namespace Rt2::Sockets
+{
+    namespace Default
+    {
+        constexpr size_t HttpMaxHead    = 0x2000;
+        constexpr size_t HttpMaxHeaders = 0x20;
+        constexpr size_t HttpMaxBody    = 0x100000;
+    }  // namespace Default
+
+    enum HttpParseStatus
+    {
+        HttpIncomplete,
+        HttpComplete,
+        HttpBadRequest,
+        HttpHeadTooLarge,
+        HttpBodyTooLarge,
+    };
+
+    struct HttpHeader
+    {
+        std::string_view name;
+        std::string_view value;
+    };
+
+    // A parsed request. Every view points into the buffer that was
+    // handed to the parser and is only valid while it is.
+    struct HttpRequest
+    {
+        std::string_view method;
+        std::string_view target;
+        std::string_view body;
+        int              minor{1};
+        size_t           contentLength{0};
+        bool             keepAlive{true};
+        bool             chunked{false};
+        HttpHeader       headers[Default::HttpMaxHeaders];
+        size_t           headerCount{0};
+
+        // Case-insensitive lookup; returns an empty view when missing.
+        std::string_view header(std::string_view name) const;
+    };
+
+    // The status line and fields of a response head.
+    struct HttpResponseHead
+    {
+        std::string_view reason;
+        int              status{0};
+        int              minor{1};
+        size_t           contentLength{0};
+        bool             hasLength{false};
+        bool             keepAlive{true};
+        bool             chunked{false};
+        HttpHeader       headers[Default::HttpMaxHeaders];
+        size_t           headerCount{0};
+
+        std::string_view header(std::string_view name) const;
+    };
+
+    // Incremental HTTP/1.1 request parser. It allocates nothing: the
+    // request is described by views into the caller's buffer, and a
+    // chunked body is decoded in place behind the head. State is kept
+    // as offsets from the start of the request, so the same request
+    // can be passed again once more bytes arrive, even if the buffer
+    // has moved in between.
+    class HttpParser
+    {
+    private:
+        enum Phase
+        {
+            PhaseHead,
+            PhaseBody,
+            PhaseChunkSize,
+            PhaseChunkData,
+            PhaseTrailer,
+            PhaseDone,
+        };
+
+        Phase       _phase{PhaseHead};
+        const char* _base{nullptr};
+        size_t      _scanned{0};
+        size_t      _headEnd{0};
+        size_t      _read{0};
+        size_t      _write{0};
+        size_t      _chunk{0};
+        size_t      _maxBody{Default::HttpMaxBody};
+
+        HttpParseStatus parseHead(const char* data, size_t size, HttpRequest& dest);
+
+        HttpParseStatus parseChunks(char* data, size_t size);
+
+    public:
+        HttpParser() = default;
+
+        // Parses the request at the front of [data, data + size).
+        HttpParseStatus parse(char* data, size_t size, HttpRequest& dest);
+
+        // Bytes the complete request occupied in the buffer.
+        size_t consumed() const;
+
+        // True once the head is parsed and the body is still arriving.
+        bool awaitingBody() const;
+
+        void reset();
+
+        void setMaxBody(size_t bytes);
+
+        // Parses a complete response head, terminator included.
+        static HttpParseStatus parseResponse(std::string_view head, HttpResponseHead& dest);
+
+        // Reads the hex size from a chunk-size line, extensions allowed.
+        static bool parseChunkSize(std::string_view line, size_t& dest);
+
+        // Tests a comma separated header value for a token.
+        static bool hasToken(std::string_view value, std::string_view token);
+
+        static bool equals(std::string_view a, std::string_view b);
+    };
+
+    inline size_t HttpParser::consumed() const
+    {
+        return _phase == PhaseDone ? _read : 0;
+    }
+
+    inline bool HttpParser::awaitingBody() const
+    {
+        return _phase != PhaseHead && _phase != PhaseDone;
+    }
+
+    inline void HttpParser::setMaxBody(const size_t bytes)
+    {
+        _maxBody = bytes;
+    }
+
+}  // namespace Rt2::Sockets
@@ -0,0 +1,302 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#include "Sockets/HttpServer.h"
+#include <cstdio>
+#include <cstring>
+#include "Sockets/RecvBuffer.h"
+
+namespace Rt2::Sockets
+{
+    HttpResponse::HttpResponse(const bool keepAlive) :
+        _keepAlive(keepAlive)
+    {
+    }
+
+    void HttpResponse::setStatus(const int code)
+    {
+        _status = code >= 100 && code <= 999 ? code : 500;
+    }
+
+    bool HttpResponse::setHeader(const std::string_view name, const std::string_view value)
+    {
+        const size_t need = name.size() + value.size() + 4;
+        RT_GUARD_RET(!name.empty() && _fieldSize + need <= Default::HttpMaxFields, false)
+
+        char* dest = _fields + _fieldSize;
+        memcpy(dest, name.data(), name.size());
+        dest += name.size();
+        *dest++ = ':';
+        *dest++ = ' ';
+        memcpy(dest, value.data(), value.size());
+        dest += value.size();
+        *dest++ = '\r';
+        *dest++ = '\n';
+        _fieldSize += need;
+        return true;
+    }
+
+    void HttpResponse::setBody(const std::string_view body)
+    {
+        _owned.clear();
+        _body = body;
+    }
+
+    void HttpResponse::setBody(String&& body)
+    {
+        _owned = std::move(body);
+        _body  = _owned;
+    }
+
+    void HttpResponse::upgrade(const HttpUpgrade& takeover)
+    {
+        _upgrade = takeover;
+        setStatus(101);
+        setBody(std::string_view{});
+    }
+
+    bool HttpResponse::write(const PlatformSocket& sock,
+                             const bool            omitBody,
+                             const int             timeout) const
+    {
+        char status[64];
+        char framing[64];
+
+        const int statusLen = snprintf(status, sizeof status, "HTTP/1.1 %d %s\r\n", _status, reason(_status));
+        // informational, empty and not-modified responses carry no length
+        const bool  bodyless = _status < 200 || _status == 204 || _status == 304;
+        const char* close    = _keepAlive || _status < 200 ? "" : "Connection: close\r\n";
+
+        int framingLen;
+        if (bodyless)
+            framingLen = snprintf(framing, sizeof framing, "%s\r\n", close);
+        else
+        {
+            framingLen = snprintf(framing,
+                                  sizeof framing,
+                                  "Content-Length: %zu\r\n%s\r\n",
+                                  _body.size(),
+                                  close);
+        }
+        if (statusLen <= 0 || framingLen <= 0)
+            return false;
+
+        IoVector vec[4];
+        int      count = 0;
+        Net::Utils::makeVector(vec[count++], status, (size_t)statusLen);
+        if (_fieldSize > 0)
+            Net::Utils::makeVector(vec[count++], _fields, _fieldSize);
+        Net::Utils::makeVector(vec[count++], framing, (size_t)framingLen);
+        if (!omitBody && !bodyless && !_body.empty())
+            Net::Utils::makeVector(vec[count++], _body.data(), _body.size());
+
+        size_t total = 0;
+        for (int i = 0; i < count; ++i)
+            total += Net::Utils::vectorSize(vec[i]);
+        return Net::writeVector(sock, vec, count, timeout) == (int)total;
+    }
+
+    const char* HttpResponse::reason(const int code)
+    {
+        switch (code)
+        {
+        case 100:
+            return "Continue";
+        case 101:
+            return "Switching Protocols";
+        case 200:
+            return "OK";
+        case 201:
+            return "Created";
+        case 204:
+            return "No Content";
+        case 301:
+            return "Moved Permanently";
+        case 302:
+            return "Found";
+        case 304:
+            return "Not Modified";
+        case 400:
+            return "Bad Request";
+        case 403:
+            return "Forbidden";
+        case 404:
+            return "Not Found";
+        case 405:
+            return "Method Not Allowed";
+        case 413:
+            return "Content Too Large";
+        case 417:
+            return "Expectation Failed";
+        case 426:
+            return "Upgrade Required";
+        case 431:
+            return "Request Header Fields Too Large";
+        case 500:
+            return "Internal Server Error";
+        case 501:
+            return "Not Implemented";
+        case 503:
+            return "Service Unavailable";
+        default:
+            return "Unknown";
+        }
+    }
+
+    HttpServer::HttpServer(const String&       ipv4,
+                           const uint16_t      port,
+                           HttpHandler         handler,
+                           const SocketConfig& config) :
+        _handler(std::move(handler)),
+        _server(ipv4, port, config)
+    {
+        _server.connect([this](const PlatformSocket& sock)
+                        { serve(sock); });
+    }
+
+    HttpServer::~HttpServer()
+    {
+        stop();
+    }
+
+    bool HttpServer::isValid() const
+    {
+        return _server.isValid();
+    }
+
+    void HttpServer::run()
+    {
+        _server.run();
+    }
+
+    void HttpServer::stop()
+    {
+        _stopping = true;
+        _server.stop();
+    }
+
+    void HttpServer::setMaxBody(const size_t bytes)
+    {
+        _maxBody = bytes;
+    }
+
+    void HttpServer::setKeepAliveTimeout(const int ms)
+    {
+        _keepAlive = ms;
+    }
+
+    void HttpServer::serve(const PlatformSocket& sock)
+    {
+        RecvBuffer  buffer;
+        HttpParser  parser;
+        HttpRequest request;
+
+        parser.setMaxBody(_maxBody);
+
+        int  idle     = 0;
+        bool expected = false;
+        while (!_stopping)
+        {
+            const HttpParseStatus st = parser.parse(buffer.data(), buffer.size(), request);
+            if (!expected && (st == HttpComplete || parser.awaitingBody()))
+            {
+                // answer Expect once per request, before reading the body
+                expected = true;
+
+                const std::string_view expect = request.header("Expect");
+                if (!expect.empty() && request.minor > 0)
+                {
+                    if (!HttpParser::equals(expect, "100-continue"))
+                    {
+                        HttpResponse error(false);
+                        error.setStatus(417);
+                        error.write(sock);
+                        break;
+                    }
+                    if (st == HttpIncomplete)
+                    {
+                        HttpResponse interim(true);
+                        interim.setStatus(100);
+                        if (!interim.write(sock))
+                            break;
+                    }
+                }
+            }
+
+            if (st == HttpIncomplete)
+            {
+                // wait in short slices so stop is noticed promptly
+                const Status rs = buffer.fill(sock, Default::HttpPollSlice);
+                if (rs == TimeoutStatus)
+                {
+                    idle += Default::HttpPollSlice;
+                    if (idle >= _keepAlive)
+                        break;
+                    continue;
+                }
+                if (rs != OkStatus)
+                    break;
+                idle = 0;
+                continue;
+            }
+
+            if (st != HttpComplete)
+            {
+                HttpResponse error(false);
+                if (st == HttpHeadTooLarge)
+                    error.setStatus(431);
+                else if (st == HttpBodyTooLarge)
+                    error.setStatus(413);
+                else
+                    error.setStatus(400);
+                error.write(sock);
+                break;
+            }
+
+            HttpResponse response(request.keepAlive);
+            try
+            {
+                _handler(request, response);
+            }
+            catch (...)
+            {
+                response = HttpResponse(false);
+                response.setStatus(500);
+            }
+
+            if (!response.write(sock, request.method == "HEAD"))
+                break;
+
+            buffer.consume(parser.consumed());
+            parser.reset();
+            expected = false;
+
+            if (response.upgrade())
+            {
+                response.upgrade()(sock, buffer);
+                break;
+            }
+            if (!response.keepAlive())
+                break;
+        }
+    }
+
+}  // namespace Rt2::Sockets
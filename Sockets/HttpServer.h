@@ -0,0 +1,152 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#pragma once
+#include <atomic>
+#include <functional>
+#include "Sockets/HttpParser.h"
+#include "Sockets/ServerSocket.h"
+
+namespace Rt2::Sockets
+{
+    namespace Default
+    {
+        constexpr size_t HttpMaxFields = 0x800;
+        constexpr int    HttpKeepAlive = 5000;
+        constexpr int    HttpPollSlice = 100;
+    }  // namespace Default
+
+    class RecvBuffer;
+
+    // Takes over the connection after a 101 response. The buffer holds
+    // whatever the client sent after the upgrade request.
+    using HttpUpgrade = std::function<void(const PlatformSocket& sock, RecvBuffer& buffer)>;
+
+    // Response under construction by a handler. Header fields are
+    // packed into a fixed block, and write sends the status line,
+    // fields, framing headers and body with one vectored write.
+    class HttpResponse
+    {
+    private:
+        int              _status{200};
+        char             _fields[Default::HttpMaxFields]{};
+        size_t           _fieldSize{0};
+        std::string_view _body;
+        String           _owned;
+        HttpUpgrade      _upgrade;
+        bool             _keepAlive{true};
+
+    public:
+        explicit HttpResponse(bool keepAlive = true);
+
+        void setStatus(int code);
+
+        int status() const;
+
+        // Appends a field; returns false when the block is full.
+        bool setHeader(std::string_view name, std::string_view value);
+
+        // The view must stay valid until the handler returns.
+        void setBody(std::string_view body);
+
+        void setBody(String&& body);
+
+        std::string_view body() const;
+
+        void setKeepAlive(bool val);
+
+        bool keepAlive() const;
+
+        // Switches protocols: the server sends this response as a 101
+        // and then hands the connection to the callback.
+        void upgrade(const HttpUpgrade& takeover);
+
+        const HttpUpgrade& upgrade() const;
+
+        bool write(const PlatformSocket& sock,
+                   bool                  omitBody = false,
+                   int                   timeout  = Default::SocketTimeOut) const;
+
+        static const char* reason(int code);
+    };
+
+    using HttpHandler = std::function<void(const HttpRequest& request, HttpResponse& response)>;
+
+    // HTTP/1.1 endpoint on top of ServerSocket. Each connection is kept
+    // open between requests, and pipelined requests are answered in
+    // order straight from the receive buffer.
+    class HttpServer
+    {
+    private:
+        const HttpHandler   _handler;
+        std::atomic<bool>   _stopping{false};
+        std::atomic<size_t> _maxBody{Default::HttpMaxBody};
+        std::atomic<int>    _keepAlive{Default::HttpKeepAlive};
+        ServerSocket        _server;
+
+        void serve(const PlatformSocket& sock);
+
+    public:
+        HttpServer(const String&       ipv4,
+                   uint16_t            port,
+                   HttpHandler         handler,
+                   const SocketConfig& config = {});
+        ~HttpServer();
+
+        bool isValid() const;
+
+        // Blocks until stop is called.
+        void run();
+
+        void stop();
+
+        void setMaxBody(size_t bytes);
+
+        // Milliseconds an idle connection is kept open.
+        void setKeepAliveTimeout(int ms);
+    };
+
+    inline int HttpResponse::status() const
+    {
+        return _status;
+    }
+
+    inline std::string_view HttpResponse::body() const
+    {
+        return _body;
+    }
+
+    inline bool HttpResponse::keepAlive() const
+    {
+        return _keepAlive;
+    }
+
+    inline void HttpResponse::setKeepAlive(const bool val)
+    {
+        _keepAlive = val;
+    }
+
+    inline const HttpUpgrade& HttpResponse::upgrade() const
+    {
+        return _upgrade;
+    }
+
+}  // namespace Rt2::Sockets
@@ -0,0 +1,237 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#pragma once
+#include <cstdint>
+#include <string_view>
+#include "Utils/String.h"
+
+namespace Rt2::Sockets
+{
+    // Dotted quad text with its terminator; "255.255.255.255" is the
+    // longest form.
+    struct Ipv4Text
+    {
+        char    data[16]{};
+        uint8_t size{0};
+
+        constexpr std::string_view view() const;
+
+        const char* c_str() const;
+    };
+
+    // An IPv4 address as a value. Parsing and formatting run in a
+    // single pass over fixed buffers and are constexpr, so literals can
+    // be checked at compile time:
+    //
+    //     constexpr Ipv4 loopback = Ipv4::literal("127.0.0.1");
+    //
+    // The accepted syntax is inet_pton's: four decimal octets, no
+    // leading zeros and nothing else around them.
+    class Ipv4
+    {
+    private:
+        uint32_t _host{0};  // host byte order
+
+        static constexpr uint32_t swap(uint32_t v);
+
+    public:
+        constexpr Ipv4() = default;
+
+        constexpr Ipv4(uint8_t a, uint8_t b, uint8_t c, uint8_t d);
+
+        static constexpr Ipv4 fromHost(uint32_t value);
+
+        static constexpr Ipv4 fromNetwork(uint32_t value);
+
+        static constexpr bool parse(std::string_view text, Ipv4& dest);
+
+        static constexpr bool isValid(std::string_view text);
+
+        // Parses text that is known to be valid. Invalid text fails to
+        // compile in a constant expression and throws otherwise.
+        static constexpr Ipv4 literal(std::string_view text);
+
+        constexpr uint32_t host() const;
+
+        // The value for sin_addr.s_addr.
+        constexpr uint32_t network() const;
+
+        constexpr uint8_t octet(int i) const;
+
+        constexpr size_t format(char* dest) const;
+
+        constexpr Ipv4Text text() const;
+
+        String toString() const;
+
+        constexpr bool operator==(const Ipv4& rhs) const;
+
+        constexpr bool operator!=(const Ipv4& rhs) const;
+    };
+
+    constexpr std::string_view Ipv4Text::view() const
+    {
+        return {data, size};
+    }
+
+    inline const char* Ipv4Text::c_str() const
+    {
+        return data;
+    }
+
+    constexpr uint32_t Ipv4::swap(const uint32_t v)
+    {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        return v;
+#else
+        return v >> 24 | (v >> 8 & 0xFF00) | (v << 8 & 0xFF0000) | v << 24;
+#endif
+    }
+
+    constexpr Ipv4::Ipv4(const uint8_t a, const uint8_t b, const uint8_t c, const uint8_t d) :
+        _host((uint32_t)a << 24 | (uint32_t)b << 16 | (uint32_t)c << 8 | d)
+    {
+    }
+
+    constexpr Ipv4 Ipv4::fromHost(const uint32_t value)
+    {
+        Ipv4 addr;
+        addr._host = value;
+        return addr;
+    }
+
+    constexpr Ipv4 Ipv4::fromNetwork(const uint32_t value)
+    {
+        return fromHost(swap(value));
+    }
+
+    constexpr bool Ipv4::parse(const std::string_view text, Ipv4& dest)
+    {
+        if (text.size() < 7 || text.size() > 15)
+            return false;
+
+        uint32_t value  = 0;
+        uint32_t octet  = 0;
+        int      digits = 0;
+        int      dots   = 0;
+        for (const char ch : text)
+        {
+            if (ch >= '0' && ch <= '9')
+            {
+                if (digits > 0 && octet == 0)
+                    return false;  // leading zero
+
+                octet = octet * 10 + (uint32_t)(ch - '0');
+                if (++digits > 3 || octet > 255)
+                    return false;
+            }
+            else if (ch == '.')
+            {
+                if (digits == 0 || ++dots > 3)
+                    return false;
+
+                value  = value << 8 | octet;
+                octet  = 0;
+                digits = 0;
+            }
+            else
+                return false;
+        }
+
+        if (digits == 0 || dots != 3)
+            return false;
+
+        dest._host = value << 8 | octet;
+        return true;
+    }
+
+    constexpr bool Ipv4::isValid(const std::string_view text)
+    {
+        Ipv4 unused;
+        return parse(text, unused);
+    }
+
+    constexpr Ipv4 Ipv4::literal(const std::string_view text)
+    {
+        Ipv4 addr;
+        if (!parse(text, addr))
+            throw "invalid IPv4 literal";
+        return addr;
+    }
+
+    constexpr uint32_t Ipv4::host() const
+    {
+        return _host;
+    }
+
+    constexpr uint32_t Ipv4::network() const
+    {
+        return swap(_host);
+    }
+
+    constexpr uint8_t Ipv4::octet(const int i) const
+    {
+        return (uint8_t)(_host >> (24 - 8 * i));
+    }
+
+    constexpr size_t Ipv4::format(char* dest) const
+    {
+        size_t len = 0;
+        for (int i = 0; i < 4; ++i)
+        {
+            const uint8_t v = octet(i);
+            if (v >= 100)
+                dest[len++] = (char)('0' + v / 100);
+            if (v >= 10)
+                dest[len++] = (char)('0' + v / 10 % 10);
+            dest[len++] = (char)('0' + v % 10);
+            if (i < 3)
+                dest[len++] = '.';
+        }
+        dest[len] = 0;
+        return len;
+    }
+
+    constexpr Ipv4Text Ipv4::text() const
+    {
+        Ipv4Text out;
+        out.size = (uint8_t)format(out.data);
+        return out;
+    }
+
+    inline String Ipv4::toString() const
+    {
+        const Ipv4Text out = text();
+        return {out.data, out.size};
+    }
+
+    constexpr bool Ipv4::operator==(const Ipv4& rhs) const
+    {
+        return _host == rhs._host;
+    }
+
+    constexpr bool Ipv4::operator!=(const Ipv4& rhs) const
+    {
+        return _host != rhs._host;
+    }
+
+}  // namespace Rt2::Sockets
@@ -0,0 +1,170 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#include "Sockets/ListenerHandoff.h"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include "Thread/Thread.h"
+#include "Utils/Char.h"
+#if RT_PLATFORM != RT_PLATFORM_WINDOWS
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+namespace Rt2::Sockets
+{
+#if RT_PLATFORM != RT_PLATFORM_WINDOWS
+    namespace
+    {
+        using Clock = std::chrono::steady_clock;
+
+        constexpr int  ListenFdsStart = 3;  // SD_LISTEN_FDS_START
+        constexpr char Receipt        = 'R';
+
+        int remaining(const Clock::time_point& end)
+        {
+            const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+                end - Clock::now());
+            return std::max(0, (int)left.count());
+        }
+
+        PlatformSocket unixSocket()
+        {
+            const PlatformSocket sock = Net::create(AddressFamilyUnix, SocketStream);
+            if (sock != InvalidSocket)
+                Net::Utils::setCloseOnExec(sock, true);
+            return sock;
+        }
+    }  // namespace
+#endif
+
+    int ListenerHandoff::inherit(std::vector<PlatformSocket>& dest)
+    {
+#if RT_PLATFORM == RT_PLATFORM_WINDOWS
+        (void)dest;
+        return 0;
+#else
+        const char* pid = getenv("LISTEN_PID");
+        const char* fds = getenv("LISTEN_FDS");
+        if (!pid || !fds || Char::toInt32(pid) != (int)getpid())
+            return 0;
+
+        const int count = Char::toInt32(fds);
+        for (int i = 0; i < count; ++i)
+        {
+            const int fd = ListenFdsStart + i;
+            Net::Utils::setCloseOnExec(fd, true);
+            dest.push_back(fd);
+        }
+
+        unsetenv("LISTEN_PID");
+        unsetenv("LISTEN_FDS");
+        unsetenv("LISTEN_FDNAMES");
+        return count > 0 ? count : 0;
+#endif
+    }
+
+    bool ListenerHandoff::offer(const String&         path,
+                                const PlatformSocket& listener,
+                                const int             timeout)
+    {
+#if RT_PLATFORM == RT_PLATFORM_WINDOWS
+        (void)path;
+        (void)listener;
+        (void)timeout;
+        return false;
+#else
+        RT_GUARD_CHECK_RET(listener != InvalidSocket, false)
+
+        const PlatformSocket control = unixSocket();
+        if (control == InvalidSocket)
+            return false;
+
+        // a stale path from an earlier run would fail the bind
+        unlink(path.c_str());
+
+        bool handed = false;
+        if (Net::bindLocal(control, path) == OkStatus && Net::listen(control, 1) == OkStatus)
+        {
+            const auto end = Clock::now() + std::chrono::milliseconds(timeout);
+            if (Net::poll(control, remaining(end), Read))
+            {
+                const PlatformSocket peer = Net::accept(control);
+                if (peer != InvalidSocket)
+                {
+                    char ack = 0;
+                    int  br  = 0;
+                    handed   = Net::sendHandle(peer, listener) == OkStatus &&
+                             Net::receive(peer, &ack, 1, br, remaining(end)) == OkStatus &&
+                             ack == Receipt;
+                    Net::close(peer);
+                }
+            }
+        }
+
+        Net::close(control);
+        unlink(path.c_str());
+        return handed;
+#endif
+    }
+
+    PlatformSocket ListenerHandoff::take(const String& path, const int timeout)
+    {
+#if RT_PLATFORM == RT_PLATFORM_WINDOWS
+        (void)path;
+        (void)timeout;
+        return InvalidSocket;
+#else
+        const auto end = Clock::now() + std::chrono::milliseconds(timeout);
+
+        PlatformSocket channel = InvalidSocket;
+        do
+        {
+            channel = unixSocket();
+            if (channel == InvalidSocket)
+                return InvalidSocket;
+            if (Net::connectLocal(channel, path) == OkStatus)
+                break;
+
+            Net::close(channel);
+            channel = InvalidSocket;
+            Thread::Thread::sleep(10);
+        } while (remaining(end) > 0);
+
+        if (channel == InvalidSocket)
+            return InvalidSocket;
+
+        PlatformSocket listener = InvalidSocket;
+        if (Net::receiveHandle(channel, listener, remaining(end)) == OkStatus)
+        {
+            if (Net::writeSocket(channel, &Receipt, 1, remaining(end)) != 1)
+            {
+                Net::close(listener);
+                listener = InvalidSocket;
+            }
+        }
+        Net::close(channel);
+        return listener;
+#endif
+    }
+
+}  // namespace Rt2::Sockets
@@ -0,0 +1,65 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#pragma once
+#include <vector>
+#include "Sockets/PlatformSocket.h"
+
+namespace Rt2::Sockets
+{
+    namespace Default
+    {
+        constexpr int HandoffTimeOut = 5000;
+    }  // namespace Default
+
+    // Ways for a new process to obtain a listener that is already bound,
+    // so a restart never has a window in which connections are refused.
+    // The kernel keeps one accept queue per listener, so anything that
+    // arrives during the switch waits there for whichever process
+    // accepts next.
+    //
+    //     old process                     new process
+    //     server.handOff(path)     <-->   ServerSocket server(ListenerHandoff::take(path))
+    //     run() returns, drains           accepts
+    //
+    // Descriptor passing needs AF_UNIX with SCM_RIGHTS; on Windows every
+    // function here reports failure.
+    class ListenerHandoff
+    {
+    public:
+        // systemd socket activation: collects the descriptors named by
+        // LISTEN_FDS when LISTEN_PID is this process, and clears the
+        // variables so children do not inherit them. Returns the count.
+        static int inherit(std::vector<PlatformSocket>& dest);
+
+        // Old process: waits on a Unix socket at path for the new
+        // process, passes it the listener and waits for its receipt.
+        static bool offer(const String&         path,
+                          const PlatformSocket& listener,
+                          int                   timeout = Default::HandoffTimeOut);
+
+        // New process: connects to path, retrying until the old process
+        // is ready, and returns the listener it passes over.
+        static PlatformSocket take(const String& path,
+                                   int           timeout = Default::HandoffTimeOut);
+    };
+
+}  // namespace Rt2::Sockets
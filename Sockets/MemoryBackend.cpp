@@ -0,0 +1,403 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#include "Sockets/MemoryBackend.h"
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <thread>
+
+namespace Rt2::Sockets
+{
+    namespace
+    {
+        using Clock = std::chrono::steady_clock;
+
+        // Reports a failure the way the system would, so that Net's
+        // wouldBlock and error recording see the usual codes.
+        int64_t fail(const int code)
+        {
+#if RT_PLATFORM == RT_PLATFORM_WINDOWS
+            WSASetLastError(code);
+#else
+            errno = code;
+#endif
+            return -1;
+        }
+
+#if RT_PLATFORM == RT_PLATFORM_WINDOWS
+        constexpr int WouldBlock = WSAEWOULDBLOCK;
+        constexpr int Broken     = WSAESHUTDOWN;
+        constexpr int BadHandle  = WSAENOTSOCK;
+#else
+        constexpr int WouldBlock = EWOULDBLOCK;
+        constexpr int Broken     = EPIPE;
+        constexpr int BadHandle  = EBADF;
+#endif
+
+        // Bytes become readable in the order they were written, each
+        // write at its own time.
+        struct Arrival
+        {
+            uint64_t          end;
+            Clock::time_point due;
+        };
+
+        // One direction. Positions count every byte ever written or
+        // read; bytes holds [read, written).
+        struct Pipe
+        {
+            String              bytes;
+            size_t              head{0};
+            uint64_t            written{0};
+            uint64_t            read{0};
+            uint64_t            visible{0};
+            std::deque<Arrival> arrivals;
+            Clock::time_point   wireFree{};
+            bool                writerClosed{false};
+            bool                readerClosed{false};
+
+            void arrive(const Clock::time_point& now)
+            {
+                while (!arrivals.empty() && arrivals.front().due <= now)
+                {
+                    visible = arrivals.front().end;
+                    arrivals.pop_front();
+                }
+            }
+
+            size_t readable() const
+            {
+                return (size_t)(visible - read);
+            }
+
+            bool finished() const
+            {
+                return writerClosed && read == written;
+            }
+
+            void consume(const size_t n)
+            {
+                read += n;
+                head += n;
+                if (head == bytes.size())
+                {
+                    bytes.clear();
+                    head = 0;
+                }
+                else if (head > bytes.size() / 2)
+                {
+                    bytes.erase(0, head);
+                    head = 0;
+                }
+            }
+        };
+    }  // namespace
+
+    struct MemoryBackend::Link
+    {
+        std::mutex              lock;
+        std::condition_variable changed;
+        PipeConfig              config;
+        Pipe                    pipes[2];  // pipes[i] is read by side i
+
+        bool timed() const
+        {
+            return config.latency.count() > 0 || config.bandwidth > 0;
+        }
+
+        size_t room(const Pipe& pipe) const
+        {
+            const size_t held = (size_t)(pipe.written - pipe.read);
+            return held < config.capacity ? config.capacity - held : 0;
+        }
+
+        void published(Pipe& pipe, const size_t n)
+        {
+            pipe.written += n;
+            if (!timed())
+            {
+                pipe.visible = pipe.written;
+                return;
+            }
+
+            const auto now   = Clock::now();
+            auto       start = std::max(now, pipe.wireFree);
+            if (config.bandwidth > 0)
+                start += std::chrono::nanoseconds((int64_t)(n * 1000000000ull / config.bandwidth));
+            pipe.wireFree = start;
+            pipe.arrivals.push_back({pipe.written, start + config.latency});
+        }
+    };
+
+    MemoryBackend::MemoryBackend(NetBackend& next) :
+        _next(next)
+    {
+    }
+
+    MemoryBackend::~MemoryBackend()
+    {
+        if (&Net::backend() == this)
+            Net::setBackend(nullptr);
+    }
+
+    void MemoryBackend::pair(PlatformSocket& a, PlatformSocket& b, const PipeConfig& config)
+    {
+        const auto link = std::make_shared<Link>();
+        link->config    = config;
+        if (link->config.capacity == 0)
+            link->config.capacity = Default::PipeCapacity;
+
+        std::lock_guard guard(_lock);
+        a = _handle++;
+        b = _handle++;
+        _endpoints[a] = {link, 0};
+        _endpoints[b] = {link, 1};
+    }
+
+    size_t MemoryBackend::endpoints() const
+    {
+        std::lock_guard guard(_lock);
+        return _endpoints.size();
+    }
+
+    bool MemoryBackend::find(const PlatformSocket& sock, Endpoint& dest) const
+    {
+        std::lock_guard guard(_lock);
+
+        const auto it = _endpoints.find(sock);
+        if (it == _endpoints.end())
+            return false;
+        dest = it->second;
+        return true;
+    }
+
+    int64_t MemoryBackend::send(const PlatformSocket& sock, const char* src, const size_t size)
+    {
+        if (!owns(sock))
+            return _next.send(sock, src, size);
+
+        IoVector vec;
+        Net::Utils::makeVector(vec, src, size);
+        return sendVector(sock, &vec, 1);
+    }
+
+    int64_t MemoryBackend::sendVector(const PlatformSocket& sock, IoVector* vectors, const int count)
+    {
+        if (!owns(sock))
+            return _next.sendVector(sock, vectors, count);
+
+        Endpoint end;
+        if (!find(sock, end))
+            return fail(BadHandle);
+
+        Link& link = *end.link;
+        Pipe& pipe = link.pipes[1 - end.side];
+
+        std::unique_lock guard(link.lock);
+        if (pipe.readerClosed || pipe.writerClosed)
+            return fail(Broken);
+
+        size_t room = link.room(pipe);
+        if (room == 0)
+            return fail(WouldBlock);
+
+        size_t sent = 0;
+        for (int i = 0; i < count && room > 0; ++i)
+        {
+            const size_t n = std::min(Net::Utils::vectorSize(vectors[i]), room);
+            pipe.bytes.append(Net::Utils::vectorBase(vectors[i]), n);
+            sent += n;
+            room -= n;
+        }
+
+        link.published(pipe, sent);
+
+        // a waiter woken while the lock is still held would only block
+        // on it again
+        guard.unlock();
+        link.changed.notify_all();
+        return (int64_t)sent;
+    }
+
+    int64_t MemoryBackend::receive(const PlatformSocket& sock, char* dest, const size_t size)
+    {
+        if (!owns(sock))
+            return _next.receive(sock, dest, size);
+
+        IoVector vec;
+        Net::Utils::makeVector(vec, dest, size);
+        return receiveVector(sock, &vec, 1);
+    }
+
+    int64_t MemoryBackend::receiveVector(const PlatformSocket& sock, IoVector* vectors, const int count)
+    {
+        if (!owns(sock))
+            return _next.receiveVector(sock, vectors, count);
+
+        Endpoint end;
+        if (!find(sock, end))
+            return fail(BadHandle);
+
+        Link& link = *end.link;
+        Pipe& pipe = link.pipes[end.side];
+
+        std::unique_lock guard(link.lock);
+        if (link.timed())
+            pipe.arrive(Clock::now());
+
+        size_t available = pipe.readable();
+        if (available == 0)
+            return pipe.finished() ? 0 : fail(WouldBlock);
+
+        size_t received = 0;
+        for (int i = 0; i < count && available > 0; ++i)
+        {
+            const size_t n = std::min(Net::Utils::vectorSize(vectors[i]), available);
+            memcpy(Net::Utils::vectorBase(vectors[i]), pipe.bytes.data() + pipe.head, n);
+            pipe.consume(n);
+            received += n;
+            available -= n;
+        }
+
+        guard.unlock();
+        link.changed.notify_all();
+        return (int64_t)received;
+    }
+
+    int64_t MemoryBackend::receiveNow(const PlatformSocket& sock, char* dest, const size_t size)
+    {
+        // memory handles never block a receive
+        if (!owns(sock))
+            return _next.receiveNow(sock, dest, size);
+        return receive(sock, dest, size);
+    }
+
+    int64_t MemoryBackend::receiveStamped(const PlatformSocket& sock,
+                                          char*                 dest,
+                                          const size_t          size,
+                                          const bool            peek,
+                                          RecvTimestamp&        stamp)
+    {
+        if (!owns(sock))
+            return _next.receiveStamped(sock, dest, size, peek, stamp);
+
+        stamp = {};
+        if (!peek)
+            return receive(sock, dest, size);
+
+        Endpoint end;
+        if (!find(sock, end))
+            return fail(BadHandle);
+
+        Link& link = *end.link;
+        Pipe& pipe = link.pipes[end.side];
+
+        std::lock_guard guard(link.lock);
+        if (link.timed())
+            pipe.arrive(Clock::now());
+
+        const size_t n = std::min(size, pipe.readable());
+        if (n == 0)
+            return pipe.finished() ? 0 : fail(WouldBlock);
+        memcpy(dest, pipe.bytes.data() + pipe.head, n);
+        return (int64_t)n;
+    }
+
+    int MemoryBackend::poll(const PlatformSocket& sock, const int timeout, const int mode)
+    {
+        if (!owns(sock))
+            return _next.poll(sock, timeout, mode);
+
+        Endpoint end;
+        if (!find(sock, end))
+            return (int)fail(BadHandle);
+
+        Link& link = *end.link;
+        Pipe& in   = link.pipes[end.side];
+        Pipe& out  = link.pipes[1 - end.side];
+
+        const auto deadline = Clock::now() + std::chrono::milliseconds(std::max(timeout, 0));
+
+        std::unique_lock guard(link.lock);
+        for (;;)
+        {
+            const auto now = Clock::now();
+            if (link.timed())
+                in.arrive(now);
+
+            // like a socket, the end of the stream is readable and a
+            // closed peer is writable, so the next call reports it
+            const bool readable = in.readable() > 0 || in.finished();
+            const bool writable = link.room(out) > 0 || out.readerClosed;
+            if ((mode & Read && readable) || (mode & Write && writable))
+                return 1;
+            if (timeout == 0 || (timeout > 0 && now >= deadline))
+                return 0;
+
+            auto wake = timeout > 0 ? deadline : Clock::time_point::max();
+            if (mode & Read && !in.arrivals.empty())
+                wake = std::min(wake, in.arrivals.front().due);
+
+            if (wake == Clock::time_point::max())
+                link.changed.wait(guard);
+            else if (wake - now > Default::PipeSpinWindow)
+                link.changed.wait_until(guard, wake - Default::PipeSpinWindow);
+            else
+            {
+                // a sleep this short would overshoot by the timer
+                // slack, which is larger than many modelled latencies
+                guard.unlock();
+                std::this_thread::yield();
+                guard.lock();
+            }
+        }
+    }
+
+    int MemoryBackend::close(const PlatformSocket& sock)
+    {
+        if (!owns(sock))
+            return _next.close(sock);
+
+        Endpoint end;
+        {
+            std::lock_guard guard(_lock);
+
+            const auto it = _endpoints.find(sock);
+            if (it == _endpoints.end())
+                return (int)fail(BadHandle);
+            end = std::move(it->second);
+            _endpoints.erase(it);
+        }
+
+        Link& link = *end.link;
+
+        {
+            std::lock_guard guard(link.lock);
+            link.pipes[1 - end.side].writerClosed = true;
+            link.pipes[end.side].readerClosed     = true;
+        }
+        link.changed.notify_all();
+        return 0;
+    }
+
+}  // namespace Rt2::Sockets
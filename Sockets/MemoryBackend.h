@@ -0,0 +1,129 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#pragma once
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include "Sockets/NetBackend.h"
+
+namespace Rt2::Sockets
+{
+    namespace Default
+    {
+        constexpr size_t PipeCapacity = 0x40000;
+
+        // Arrivals closer than this are waited for by yielding rather
+        // than sleeping.
+        constexpr std::chrono::microseconds PipeSpinWindow{200};
+
+        // Memory handles are numbered from here so they cannot be
+        // mistaken for descriptors the system hands out.
+        constexpr PlatformSocket MemoryHandleBase = 0x40000000;
+    }  // namespace Default
+
+    struct PipeConfig
+    {
+        // Time from a write to its bytes becoming readable.
+        std::chrono::microseconds latency{0};
+
+        // Bytes per second each direction carries; zero is unlimited.
+        // Writes queue behind each other, so a large one delays the
+        // writes that follow it.
+        uint64_t bandwidth{0};
+
+        // Bytes a direction holds before writes would block, counting
+        // bytes still in flight, like a socket's send buffer.
+        size_t capacity{Default::PipeCapacity};
+    };
+
+    // Connected pairs of in-memory handles. While installed with
+    // Net::setBackend, every Net call that moves data on one of its
+    // handles stays in the process, so streams, framing and handlers
+    // run without the kernel. Handles it did not create go to next.
+    //
+    // Only the calls NetBackend covers work on these handles; options,
+    // zero copy, handle passing and EventLoop still need real sockets.
+    class MemoryBackend final : public NetBackend
+    {
+    private:
+        struct Link;
+
+        struct Endpoint
+        {
+            std::shared_ptr<Link> link;
+            int                   side{0};
+        };
+
+        NetBackend&                                  _next;
+        mutable std::mutex                           _lock;
+        std::unordered_map<PlatformSocket, Endpoint> _endpoints;
+        PlatformSocket                               _handle{Default::MemoryHandleBase};
+
+        bool find(const PlatformSocket& sock, Endpoint& dest) const;
+
+    public:
+        explicit MemoryBackend(NetBackend& next = SystemBackend::instance());
+
+        // Uninstalls itself if it is still Net's backend.
+        ~MemoryBackend() override;
+
+        MemoryBackend(const MemoryBackend&)            = delete;
+        MemoryBackend& operator=(const MemoryBackend&) = delete;
+
+        // Creates two connected handles; what one sends the other
+        // receives. Each end is closed with Net::close.
+        void pair(PlatformSocket& a, PlatformSocket& b, const PipeConfig& config = {});
+
+        static bool owns(const PlatformSocket& sock);
+
+        // Ends that are open.
+        size_t endpoints() const;
+
+        int64_t send(const PlatformSocket& sock, const char* src, size_t size) override;
+
+        int64_t sendVector(const PlatformSocket& sock, IoVector* vectors, int count) override;
+
+        int64_t receive(const PlatformSocket& sock, char* dest, size_t size) override;
+
+        int64_t receiveVector(const PlatformSocket& sock, IoVector* vectors, int count) override;
+
+        int64_t receiveNow(const PlatformSocket& sock, char* dest, size_t size) override;
+
+        // Memory handles carry no stamps; stamp is always left zero.
+        int64_t receiveStamped(const PlatformSocket& sock,
+                               char*                 dest,
+                               size_t                size,
+                               bool                  peek,
+                               RecvTimestamp&        stamp) override;
+
+        int poll(const PlatformSocket& sock, int timeout, int mode) override;
+
+        int close(const PlatformSocket& sock) override;
+    };
+
+    inline bool MemoryBackend::owns(const PlatformSocket& sock)
+    {
+        return sock != InvalidSocket && sock >= Default::MemoryHandleBase;
+    }
+
+}  // namespace Rt2::Sockets
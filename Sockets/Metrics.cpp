@@ -0,0 +1,340 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#include "Sockets/Metrics.h"
+#include "Utils/TextStreamWriter.h"
+#if defined(_MSC_VER)
+    #include <intrin.h>
+#endif
+
+namespace Rt2::Sockets
+{
+    std::atomic<bool> Metrics::_enabled{false};
+
+    namespace
+    {
+        // Each thread writes only to its own block, so updates are plain
+        // relaxed load/store pairs with no locked instructions. Blocks are
+        // never freed; when a thread exits its block is handed to the next
+        // new thread, which keeps accumulating on top of it. Since every
+        // value is a running total, reuse does not need a reset.
+        struct ThreadBlock
+        {
+            std::atomic<uint64_t> counters[CounterMax];
+            std::atomic<uint64_t> buckets[HistogramMax][Histogram::BucketCount];
+            std::atomic<uint64_t> count[HistogramMax];
+            std::atomic<uint64_t> sum[HistogramMax];
+            std::atomic<uint64_t> max[HistogramMax];
+            std::atomic<bool>     inUse{true};
+            ThreadBlock*          next{nullptr};
+        };
+
+        std::atomic<ThreadBlock*> Blocks{nullptr};
+
+        void bump(std::atomic<uint64_t>& value, const uint64_t amount)
+        {
+            value.store(value.load(std::memory_order_relaxed) + amount,
+                        std::memory_order_relaxed);
+        }
+
+        ThreadBlock* acquireBlock()
+        {
+            for (ThreadBlock* block = Blocks.load(std::memory_order_acquire);
+                 block;
+                 block = block->next)
+            {
+                bool expected = false;
+                if (block->inUse.compare_exchange_strong(expected, true, std::memory_order_acquire))
+                    return block;
+            }
+
+            const auto block = new ThreadBlock();
+            block->next      = Blocks.load(std::memory_order_relaxed);
+            while (!Blocks.compare_exchange_weak(block->next,
+                                                 block,
+                                                 std::memory_order_release,
+                                                 std::memory_order_relaxed))
+            {
+            }
+            return block;
+        }
+
+        class BlockOwner
+        {
+        private:
+            ThreadBlock* _block{nullptr};
+
+        public:
+            ~BlockOwner()
+            {
+                if (_block)
+                    _block->inUse.store(false, std::memory_order_release);
+            }
+
+            ThreadBlock& block()
+            {
+                if (!_block)
+                    _block = acquireBlock();
+                return *_block;
+            }
+        };
+
+        thread_local BlockOwner Owner;
+
+        uint64_t countLeadingZeros(const uint64_t v)
+        {
+#if defined(_MSC_VER)
+            unsigned long idx = 0;
+            _BitScanReverse64(&idx, v);
+            return 63 - idx;
+#else
+            return (uint64_t)__builtin_clzll(v);
+#endif
+        }
+    }  // namespace
+
+    size_t Histogram::index(const uint64_t nanoseconds)
+    {
+        const uint64_t units = nanoseconds >> UnitBits;
+        if (units < SubBuckets)
+            return (size_t)units;
+
+        const int    msb   = 63 - (int)countLeadingZeros(units);
+        const int    shift = msb - SubBits;
+        const size_t group = (size_t)shift + 1;
+        if (group >= Groups)
+            return BucketCount - 1;
+        return group * SubBuckets + (size_t)((units >> shift) - SubBuckets);
+    }
+
+    uint64_t Histogram::lowerBound(const size_t idx)
+    {
+        const size_t group = idx / SubBuckets;
+        const size_t sub   = idx % SubBuckets;
+        if (group == 0)
+            return (uint64_t)sub << UnitBits;
+        return (uint64_t)(SubBuckets + sub) << (group - 1 + UnitBits);
+    }
+
+    uint64_t Histogram::upperBound(const size_t idx)
+    {
+        if (idx + 1 >= BucketCount)
+            return UINT64_MAX;
+        return lowerBound(idx + 1) - 1;
+    }
+
+    void Histogram::merge(const Histogram& other)
+    {
+        for (size_t i = 0; i < BucketCount; ++i)
+            buckets[i] += other.buckets[i];
+        count += other.count;
+        sum += other.sum;
+        if (other.max > max)
+            max = other.max;
+    }
+
+    uint64_t Histogram::percentile(const double pct) const
+    {
+        RT_GUARD_RET(count > 0, 0)
+
+        const auto rank = (uint64_t)(pct / 100.0 * double(count) + 0.5);
+        uint64_t   seen = 0;
+        for (size_t i = 0; i < BucketCount; ++i)
+        {
+            seen += buckets[i];
+            if (seen >= rank && seen > 0)
+            {
+                const uint64_t upper = upperBound(i);
+                return upper < max ? upper : max;
+            }
+        }
+        return max;
+    }
+
+    double Histogram::mean() const
+    {
+        RT_GUARD_RET(count > 0, 0)
+        return double(sum) / double(count);
+    }
+
+    Json::Dictionary Histogram::toJson() const
+    {
+        Json::Dictionary dict;
+        dict.insert("count", (int64_t)count);
+        dict.insert("mean_ns", mean());
+        dict.insert("p50_ns", (int64_t)percentile(50));
+        dict.insert("p90_ns", (int64_t)percentile(90));
+        dict.insert("p99_ns", (int64_t)percentile(99));
+        dict.insert("p999_ns", (int64_t)percentile(99.9));
+        dict.insert("max_ns", (int64_t)max);
+        return dict;
+    }
+
+    void Metrics::setEnabled(const bool val)
+    {
+        _enabled.store(val, std::memory_order_relaxed);
+    }
+
+    void Metrics::add(const MetricCounter counter, const uint64_t value)
+    {
+        bump(Owner.block().counters[counter], value);
+    }
+
+    void Metrics::sample(const MetricHistogram histogram, const uint64_t nanoseconds)
+    {
+        ThreadBlock& block = Owner.block();
+
+        bump(block.buckets[histogram][Histogram::index(nanoseconds)], 1);
+        bump(block.count[histogram], 1);
+        bump(block.sum[histogram], nanoseconds);
+        if (block.max[histogram].load(std::memory_order_relaxed) < nanoseconds)
+            block.max[histogram].store(nanoseconds, std::memory_order_relaxed);
+    }
+
+    MetricsSnapshot Metrics::snapshot()
+    {
+        MetricsSnapshot snap;
+        for (const ThreadBlock* block = Blocks.load(std::memory_order_acquire);
+             block;
+             block = block->next)
+        {
+            for (int c = 0; c < CounterMax; ++c)
+                snap.counters[c] += block->counters[c].load(std::memory_order_relaxed);
+
+            for (int h = 0; h < HistogramMax; ++h)
+            {
+                Histogram& dest = snap.histograms[h];
+                for (size_t i = 0; i < Histogram::BucketCount; ++i)
+                    dest.buckets[i] += block->buckets[h][i].load(std::memory_order_relaxed);
+
+                dest.count += block->count[h].load(std::memory_order_relaxed);
+                dest.sum += block->sum[h].load(std::memory_order_relaxed);
+
+                const uint64_t max = block->max[h].load(std::memory_order_relaxed);
+                if (max > dest.max)
+                    dest.max = max;
+            }
+        }
+        return snap;
+    }
+
+    Json::Dictionary Metrics::toJson()
+    {
+        const MetricsSnapshot snap = snapshot();
+
+        const Json::Dictionary counters;
+        for (int c = 0; c < CounterMax; ++c)
+            counters.insert(toString((MetricCounter)c), (int64_t)snap.counters[c]);
+
+        const Json::Dictionary histograms;
+        for (int h = 0; h < HistogramMax; ++h)
+            histograms.insert(toString((MetricHistogram)h), snap.histograms[h].toJson());
+
+        Json::Dictionary dict;
+        dict.insert("enabled", enabled());
+        dict.insert("counters", counters);
+        dict.insert("histograms", histograms);
+        return dict;
+    }
+
+    void Metrics::toPrometheus(OStream& out)
+    {
+        const MetricsSnapshot snap = snapshot();
+
+        for (int c = 0; c < CounterMax; ++c)
+        {
+            const String name = toString((MetricCounter)c);
+            Ts::println(out, "# TYPE sockets_", name, "_total counter");
+            Ts::println(out, "sockets_", name, "_total ", snap.counters[c]);
+        }
+
+        for (int h = 0; h < HistogramMax; ++h)
+        {
+            const String     name = toString((MetricHistogram)h);
+            const Histogram& hist = snap.histograms[h];
+
+            Ts::println(out, "# TYPE sockets_", name, "_seconds summary");
+            for (const double q : {0.5, 0.9, 0.99, 0.999})
+            {
+                Ts::println(out,
+                            "sockets_",
+                            name,
+                            "_seconds{quantile=\"",
+                            q,
+                            "\"} ",
+                            double(hist.percentile(q * 100.0)) * 1e-9);
+            }
+            Ts::println(out, "sockets_", name, "_seconds_sum ", double(hist.sum) * 1e-9);
+            Ts::println(out, "sockets_", name, "_seconds_count ", hist.count);
+        }
+    }
+
+    String Metrics::toString(const MetricCounter counter)
+    {
+        switch (counter)
+        {
+        case CounterAccepts:
+            return "accepts";
+        case CounterReads:
+            return "reads";
+        case CounterWrites:
+            return "writes";
+        case CounterBytesIn:
+            return "bytes_in";
+        case CounterBytesOut:
+            return "bytes_out";
+        case CounterShortWrites:
+            return "short_writes";
+        case CounterPollWakeups:
+            return "poll_wakeups";
+        case CounterTimeouts:
+            return "timeouts";
+        case CounterErrors:
+            return "errors";
+        default:
+            return "unknown";
+        }
+    }
+
+    String Metrics::toString(const MetricHistogram histogram)
+    {
+        switch (histogram)
+        {
+        case HistogramAccept:
+            return "accept";
+        case HistogramRead:
+            return "read";
+        case HistogramWrite:
+            return "write";
+        case HistogramPoll:
+            return "poll";
+        case HistogramKernelQueue:
+            return "kernel_queue";
+        case HistogramAcceptToFirstByte:
+            return "accept_to_first_byte";
+        case HistogramFirstByteToHandler:
+            return "first_byte_to_handler";
+        default:
+            return "unknown";
+        }
+    }
+
+}  // namespace Rt2::Sockets
@@ -0,0 +1,172 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#pragma once
+#include <atomic>
+#include <chrono>
+#include "Utils/Json.h"
+#include "Utils/String.h"
+
+namespace Rt2::Sockets
+{
+    enum MetricCounter
+    {
+        CounterAccepts,
+        CounterReads,
+        CounterWrites,
+        CounterBytesIn,
+        CounterBytesOut,
+        CounterShortWrites,
+        CounterPollWakeups,
+        CounterTimeouts,
+        CounterErrors,
+        CounterMax,
+    };
+
+    enum MetricHistogram
+    {
+        HistogramAccept,
+        HistogramRead,
+        HistogramWrite,
+        HistogramPoll,
+        HistogramKernelQueue,         // kernel receive timestamp to the read
+        HistogramAcceptToFirstByte,   // accept to the first byte's arrival
+        HistogramFirstByteToHandler,  // first byte's arrival to the handler's read
+        HistogramMax,
+    };
+
+    // Log-linear latency buckets in the style of an HDR histogram.
+    // Values are nanoseconds. They are stored in 64 ns units, with 16
+    // linear sub-buckets per power of two, which keeps the relative
+    // error near 6% up to about a minute.
+    class Histogram
+    {
+    public:
+        static constexpr int    UnitBits    = 6;
+        static constexpr int    SubBits     = 4;
+        static constexpr size_t SubBuckets  = (size_t)1 << SubBits;
+        static constexpr size_t Groups      = 28;
+        static constexpr size_t BucketCount = Groups * SubBuckets;
+
+        uint64_t buckets[BucketCount]{};
+        uint64_t count{0};
+        uint64_t sum{0};
+        uint64_t max{0};
+
+        static size_t index(uint64_t nanoseconds);
+
+        static uint64_t lowerBound(size_t idx);
+
+        static uint64_t upperBound(size_t idx);
+
+        void merge(const Histogram& other);
+
+        uint64_t percentile(double pct) const;
+
+        double mean() const;
+
+        Json::Dictionary toJson() const;
+    };
+
+    struct MetricsSnapshot
+    {
+        uint64_t  counters[CounterMax]{};
+        Histogram histograms[HistogramMax]{};
+    };
+
+    class Metrics
+    {
+    public:
+        using Tick = int64_t;
+
+    private:
+        static std::atomic<bool> _enabled;
+
+        static void add(MetricCounter counter, uint64_t value);
+
+        static void sample(MetricHistogram histogram, uint64_t nanoseconds);
+
+    public:
+        static bool enabled();
+
+        static void setEnabled(bool val);
+
+        static void count(MetricCounter counter, uint64_t value = 1);
+
+        // Returns zero when metrics are disabled, so the matching
+        // record call can skip the clock read.
+        static Tick start();
+
+        static void record(MetricHistogram histogram, Tick start);
+
+        // Records a duration measured elsewhere; negative ones count
+        // as zero.
+        static void observe(MetricHistogram histogram, int64_t nanoseconds);
+
+        static Tick now();
+
+        static MetricsSnapshot snapshot();
+
+        static Json::Dictionary toJson();
+
+        static void toPrometheus(OStream& out);
+
+        static String toString(MetricCounter counter);
+
+        static String toString(MetricHistogram histogram);
+    };
+
+    inline bool Metrics::enabled()
+    {
+        return _enabled.load(std::memory_order_relaxed);
+    }
+
+    inline void Metrics::count(const MetricCounter counter, const uint64_t value)
+    {
+        if (enabled())
+            add(counter, value);
+    }
+
+    inline Metrics::Tick Metrics::start()
+    {
+        return enabled() ? now() : 0;
+    }
+
+    inline void Metrics::record(const MetricHistogram histogram, const Tick start)
+    {
+        if (start != 0)
+            sample(histogram, (uint64_t)(now() - start));
+    }
+
+    inline void Metrics::observe(const MetricHistogram histogram, const int64_t nanoseconds)
+    {
+        if (enabled())
+            sample(histogram, nanoseconds > 0 ? (uint64_t)nanoseconds : 0);
+    }
+
+    inline Metrics::Tick Metrics::now()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    }
+
+}  // namespace Rt2::Sockets
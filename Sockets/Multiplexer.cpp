@@ -0,0 +1,590 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#include "Sockets/Multiplexer.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace Rt2::Sockets
+{
+    namespace
+    {
+        using Clock = std::chrono::steady_clock;
+
+        uint32_t readBig32(const char* src)
+        {
+            return (uint32_t)(uint8_t)src[0] << 24 |
+                   (uint32_t)(uint8_t)src[1] << 16 |
+                   (uint32_t)(uint8_t)src[2] << 8 |
+                   (uint32_t)(uint8_t)src[3];
+        }
+
+        void writeBig32(char* dest, const uint32_t val)
+        {
+            dest[0] = (char)(val >> 24);
+            dest[1] = (char)(val >> 16);
+            dest[2] = (char)(val >> 8);
+            dest[3] = (char)val;
+        }
+
+        Clock::time_point deadline(const int timeout)
+        {
+            return Clock::now() + std::chrono::milliseconds(timeout);
+        }
+    }  // namespace
+
+    void MuxCodec::header(char* dest, const MuxFrameType type, const uint32_t stream, const size_t length)
+    {
+        writeBig32(dest, (uint32_t)length);
+        dest[4] = (char)type;
+        writeBig32(dest + 5, stream);
+    }
+
+    void MuxCodec::encode(String&                dest,
+                          const MuxFrameType     type,
+                          const uint32_t         stream,
+                          const std::string_view payload)
+    {
+        char head[Default::MuxHeader];
+        header(head, type, stream, payload.size());
+        dest.append(head, Default::MuxHeader);
+        dest.append(payload.data(), payload.size());
+    }
+
+    FrameDecodeStatus MuxCodec::decode(const char*  data,
+                                       const size_t size,
+                                       MuxFrame&    dest,
+                                       size_t&      consumed,
+                                       const size_t maxPayload)
+    {
+        consumed = 0;
+        if (size < Default::MuxHeader)
+            return FrameIncomplete;
+
+        const size_t length = readBig32(data);
+        if (length > maxPayload || (uint8_t)data[4] > MuxReset)
+            return FrameTooLarge;
+        if (size - Default::MuxHeader < length)
+            return FrameIncomplete;
+
+        dest.type    = (MuxFrameType)data[4];
+        dest.stream  = readBig32(data + 5);
+        dest.payload = {data + Default::MuxHeader, length};
+        consumed     = Default::MuxHeader + length;
+        return FrameComplete;
+    }
+
+    MuxStream::StreamBuffer::StreamBuffer(MuxStream& stream) :
+        _stream(stream)
+    {
+    }
+
+    MuxStream::StreamBuffer::int_type MuxStream::StreamBuffer::underflow()
+    {
+        // allocated on first read, since most streams are small
+        if (_get.empty())
+            _get.resize(Default::MuxGetArea);
+
+        size_t n = 0;
+        if (_stream.receive(_get.data(), _get.size(), n, _stream._timeout) != OkStatus)
+            return traits_type::eof();
+        setg(_get.data(), _get.data(), _get.data() + n);
+        return traits_type::to_int_type(*gptr());
+    }
+
+    MuxStream::StreamBuffer::int_type MuxStream::StreamBuffer::overflow(const int_type ch)
+    {
+        if (traits_type::eq_int_type(ch, traits_type::eof()))
+            return traits_type::not_eof(ch);
+
+        const char c = traits_type::to_char_type(ch);
+        if (_stream.send({&c, 1}, _stream._timeout) != OkStatus)
+            return traits_type::eof();
+        return ch;
+    }
+
+    std::streamsize MuxStream::StreamBuffer::xsputn(const char* ptr, const std::streamsize count)
+    {
+        if (!ptr || _stream.send({ptr, (size_t)count}, _stream._timeout) != OkStatus)
+            return 0;
+        return count;
+    }
+
+    MuxStream::MuxStream(Multiplexer* mux, const uint32_t id) :
+        std::iostream(&_buffer),
+        _mux(mux),
+        _id(id),
+        _buffer(*this)
+    {
+    }
+
+    MuxStream::~MuxStream() = default;
+
+    Status MuxStream::send(const std::string_view data, const int timeout)
+    {
+        const auto end = deadline(timeout);
+
+        std::unique_lock lock(_mux->_lock);
+
+        size_t offset = 0;
+        while (offset < data.size())
+        {
+            // a full window queued locally is all the peer could take
+            if (!_writable.wait_until(lock,
+                                      end,
+                                      [this]
+                                      {
+                                          return _reset || _finQueued || !_mux->_open ||
+                                                 _out.size() - _sent < Default::MuxWindow;
+                                      }))
+                return TimeoutStatus;
+
+            if (_reset || !_mux->_open)
+                return ErrorStatus;
+            if (_finQueued)
+                return ClosedStatus;
+
+            const size_t room = Default::MuxWindow - (_out.size() - _sent);
+            const size_t n    = std::min(data.size() - offset, room);
+            _out.append(data.data() + offset, n);
+            offset += n;
+
+            _mux->schedule(shared_from_this());
+        }
+        return OkStatus;
+    }
+
+    Status MuxStream::receive(char* dest, const size_t size, size_t& received, const int timeout)
+    {
+        received = 0;
+        RT_GUARD_RET(dest && size > 0, ErrorStatus)
+
+        std::unique_lock lock(_mux->_lock);
+        if (!_readable.wait_until(lock,
+                                  deadline(timeout),
+                                  [this]
+                                  {
+                                      return _in.size() > _read || _finReceived ||
+                                             _reset || !_mux->_open;
+                                  }))
+            return TimeoutStatus;
+
+        if (_in.size() > _read)
+        {
+            received = std::min(size, _in.size() - _read);
+            memcpy(dest, _in.data() + _read, received);
+            _read += received;
+
+            if (_read == _in.size())
+            {
+                _in.clear();
+                _read = 0;
+            }
+            else if (_read >= Default::MuxChunk)
+            {
+                _in.erase(0, _read);
+                _read = 0;
+            }
+
+            // hand the space back once half the window has been read,
+            // so a steady reader never stalls the sender
+            _unacked += received;
+            if (_unacked >= Default::MuxWindow / 2 && !_reset && !_finReceived)
+            {
+                char inc[4];
+                writeBig32(inc, (uint32_t)_unacked);
+                _mux->control(MuxWindowUpdate, _id, {inc, 4});
+                _unacked = 0;
+            }
+            return OkStatus;
+        }
+
+        if (_finReceived)
+            return ClosedStatus;
+        return ErrorStatus;
+    }
+
+    void MuxStream::close()
+    {
+        std::lock_guard lock(_mux->_lock);
+        if (_finQueued || _reset)
+            return;
+        _finQueued = true;
+        _writable.notify_all();
+        _mux->schedule(shared_from_this());
+    }
+
+    void MuxStream::reset()
+    {
+        std::lock_guard lock(_mux->_lock);
+        if (_reset)
+            return;
+
+        _reset = true;
+        _out.clear();
+        _sent = 0;
+        if (_mux->_open)
+            _mux->control(MuxReset, _id);
+        _mux->release(*this);
+
+        _readable.notify_all();
+        _writable.notify_all();
+    }
+
+    bool MuxStream::isClosed() const
+    {
+        std::lock_guard lock(_mux->_lock);
+        return _in.size() == _read && (_finReceived || _reset || !_mux->_open);
+    }
+
+    bool MuxStream::readExactly(const size_t n, String& dest)
+    {
+        dest.resize(n);
+        const auto got = (size_t)rdbuf()->sgetn(dest.data(), (std::streamsize)n);
+        dest.resize(got);
+        return got == n;
+    }
+
+    bool MuxStream::readUntil(const String& delimiter, String& dest)
+    {
+        RT_GUARD_RET(!delimiter.empty(), false)
+
+        dest.clear();
+        for (;;)
+        {
+            const int_type ch = rdbuf()->sbumpc();
+            if (traits_type::eq_int_type(ch, traits_type::eof()))
+                return false;
+
+            dest.push_back(traits_type::to_char_type(ch));
+            if (dest.size() >= delimiter.size() &&
+                dest.compare(dest.size() - delimiter.size(), delimiter.size(), delimiter) == 0)
+            {
+                dest.resize(dest.size() - delimiter.size());
+                return true;
+            }
+        }
+    }
+
+    String MuxStream::string()
+    {
+        String dest;
+
+        char            scratch[Default::MuxGetArea];
+        std::streamsize n;
+        while ((n = rdbuf()->sgetn(scratch, sizeof scratch)) > 0)
+            dest.append(scratch, (size_t)n);
+        return dest;
+    }
+
+    Multiplexer::Multiplexer(const PlatformSocket& sock, const bool initiator) :
+        _sock(sock),
+        _next(initiator ? 1 : 2)
+    {
+        RT_GUARD_CHECK_VOID(_sock != InvalidSocket)
+
+        _open = true;
+        start();
+        _writer = Thread::StandardThread([this]
+                                         { writeLoop(); });
+    }
+
+    Multiplexer::~Multiplexer()
+    {
+        close();
+    }
+
+    MuxStreamPtr Multiplexer::open()
+    {
+        std::lock_guard lock(_lock);
+        if (!_open)
+            return nullptr;
+
+        const uint32_t id = _next;
+        _next += 2;
+
+        auto stream = std::make_shared<MuxStream>(this, id);
+        _streams.emplace(id, stream);
+        control(MuxOpen, id);
+        return stream;
+    }
+
+    MuxStreamPtr Multiplexer::accept(const int timeout)
+    {
+        std::unique_lock lock(_lock);
+        _accepted.wait_until(lock,
+                             deadline(timeout),
+                             [this]
+                             { return !_pending.empty() || !_open; });
+        if (_pending.empty())
+            return nullptr;
+
+        MuxStreamPtr stream = std::move(_pending.front());
+        _pending.pop_front();
+        return stream;
+    }
+
+    void Multiplexer::update()
+    {
+        while (isRunning() && _open)
+        {
+            MuxFrame frame;
+            size_t   used = 0;
+
+            FrameDecodeStatus ds;
+            while ((ds = MuxCodec::decode(_buffer.data(), _buffer.size(), frame, used)) == FrameComplete)
+            {
+                {
+                    std::lock_guard lock(_lock);
+                    dispatch(frame);
+                }
+                _buffer.consume(used);
+            }
+
+            if (ds == FrameTooLarge)
+            {
+                fail();
+                break;
+            }
+
+            const Status st = _buffer.fill(_sock, Default::MuxTick);
+            if (st != OkStatus && st != TimeoutStatus)
+            {
+                fail();
+                break;
+            }
+        }
+    }
+
+    void Multiplexer::dispatch(const MuxFrame& frame)
+    {
+        const auto it = _streams.find(frame.stream);
+
+        if (frame.type == MuxOpen)
+        {
+            // the peer opens ids of the other parity
+            if (it != _streams.end() || (frame.stream & 1) == (_next & 1))
+                return;
+
+            if (_pending.size() >= _backlog)
+            {
+                control(MuxReset, frame.stream);
+                return;
+            }
+
+            auto stream = std::make_shared<MuxStream>(this, frame.stream);
+            _streams.emplace(frame.stream, stream);
+            _pending.push_back(std::move(stream));
+            _accepted.notify_one();
+            return;
+        }
+
+        // frames can still arrive for a stream reset from this side
+        if (it == _streams.end())
+            return;
+
+        const MuxStreamPtr stream = it->second;
+        switch (frame.type)
+        {
+        case MuxData:
+            if (stream->_in.size() - stream->_read + frame.payload.size() > Default::MuxWindow)
+            {
+                // more than the window allows
+                stream->_reset = true;
+                control(MuxReset, stream->_id);
+                release(*stream);
+            }
+            else
+                stream->_in.append(frame.payload.data(), frame.payload.size());
+            stream->_readable.notify_all();
+            break;
+        case MuxWindowUpdate:
+            if (frame.payload.size() == 4)
+            {
+                stream->_credit += readBig32(frame.payload.data());
+                if (isSendable(*stream))
+                    schedule(stream);
+            }
+            break;
+        case MuxFin:
+            stream->_finReceived = true;
+            if (stream->_finSent)
+                release(*stream);
+            stream->_readable.notify_all();
+            break;
+        case MuxReset:
+            stream->_reset = true;
+            stream->_out.clear();
+            stream->_sent = 0;
+            release(*stream);
+            stream->_readable.notify_all();
+            stream->_writable.notify_all();
+            break;
+        case MuxOpen:
+            break;
+        }
+    }
+
+    void Multiplexer::writeLoop()
+    {
+        String batch;
+
+        std::unique_lock lock(_lock);
+        for (;;)
+        {
+            _work.wait(lock,
+                       [this]
+                       { return !_control.empty() || !_ready.empty() || !_open; });
+            if (_control.empty() && _ready.empty())
+                break;
+
+            batch.clear();
+            batch.swap(_control);
+
+            // one chunk per stream per turn, in the order they became
+            // ready, so every stream with credit makes progress
+            while (!_ready.empty() && batch.size() < Default::MuxBatch)
+            {
+                const MuxStreamPtr stream = std::move(_ready.front());
+                _ready.pop_front();
+
+                MuxStream& st = *stream;
+                st._scheduled = false;
+                if (st._reset)
+                    continue;
+
+                const size_t n = std::min({st._out.size() - st._sent, st._credit, Default::MuxChunk});
+                if (n > 0)
+                {
+                    MuxCodec::encode(batch, MuxData, st._id, {st._out.data() + st._sent, n});
+                    st._sent += n;
+                    st._credit -= n;
+
+                    if (st._sent == st._out.size())
+                    {
+                        st._out.clear();
+                        st._sent = 0;
+                    }
+                    st._writable.notify_all();
+                }
+
+                if (st._finQueued && !st._finSent && st._out.empty())
+                {
+                    MuxCodec::encode(batch, MuxFin, st._id);
+                    st._finSent = true;
+                    if (st._finReceived)
+                        release(st);
+                }
+
+                if (isSendable(st))
+                    schedule(stream);
+            }
+
+            lock.unlock();
+            const int bw = Net::writeSocket(_sock, batch.data(), batch.size(), Default::SocketTimeOut);
+            if (bw != (int)batch.size())
+            {
+                fail();
+                return;
+            }
+            lock.lock();
+        }
+    }
+
+    void Multiplexer::schedule(const MuxStreamPtr& stream)
+    {
+        if (stream->_scheduled || !isSendable(*stream))
+            return;
+
+        stream->_scheduled = true;
+        _ready.push_back(stream);
+        _work.notify_one();
+    }
+
+    void Multiplexer::control(const MuxFrameType type, const uint32_t stream, const std::string_view payload)
+    {
+        MuxCodec::encode(_control, type, stream, payload);
+        _work.notify_one();
+    }
+
+    void Multiplexer::release(const MuxStream& stream)
+    {
+        _streams.erase(stream._id);
+    }
+
+    bool Multiplexer::isSendable(const MuxStream& stream) const
+    {
+        if (stream._reset)
+            return false;
+        if (stream._out.size() > stream._sent)
+            return stream._credit > 0;
+        return stream._finQueued && !stream._finSent;
+    }
+
+    void Multiplexer::fail()
+    {
+        std::lock_guard lock(_lock);
+        _open = false;
+
+        for (const auto& [id, stream] : _streams)
+        {
+            stream->_reset = true;
+            stream->_readable.notify_all();
+            stream->_writable.notify_all();
+        }
+        _streams.clear();
+        _pending.clear();
+        _ready.clear();
+        _control.clear();
+
+        _accepted.notify_all();
+        _work.notify_all();
+    }
+
+    void Multiplexer::close()
+    {
+        {
+            std::lock_guard lock(_lock);
+            _open = false;
+        }
+        _work.notify_all();
+
+        // the writer sends what is already queued before it returns
+        if (_writer.joinable())
+            _writer.join();
+        stop();
+        fail();
+    }
+
+    size_t Multiplexer::streams() const
+    {
+        std::lock_guard lock(_lock);
+        return _streams.size();
+    }
+
+    void Multiplexer::setBacklog(const size_t streams)
+    {
+        std::lock_guard lock(_lock);
+        _backlog = streams;
+    }
+
+}  // namespace Rt2::Sockets
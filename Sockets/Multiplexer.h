@@ -0,0 +1,284 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include "Sockets/Frame.h"
+#include "Thread/Runner.h"
+
+namespace Rt2::Sockets
+{
+    namespace Default
+    {
+        constexpr size_t MuxHeader  = 9;
+        constexpr size_t MuxWindow  = 0x40000;
+        constexpr size_t MuxChunk   = 0x4000;
+        constexpr size_t MuxBatch   = 0x10000;
+        constexpr size_t MuxBacklog = 0x400;
+        constexpr size_t MuxGetArea = 0x1000;
+        constexpr int    MuxTick    = 20;
+    }  // namespace Default
+
+    enum MuxFrameType
+    {
+        MuxOpen,
+        MuxData,
+        MuxWindowUpdate,
+        MuxFin,
+        MuxReset,
+    };
+
+    struct MuxFrame
+    {
+        MuxFrameType     type{MuxData};
+        uint32_t         stream{0};
+        std::string_view payload;
+    };
+
+    // A big endian payload length, the frame type and a big endian
+    // stream id, followed by the payload.
+    class MuxCodec
+    {
+    public:
+        static void header(char* dest, MuxFrameType type, uint32_t stream, size_t length);
+
+        static void encode(String&          dest,
+                           MuxFrameType     type,
+                           uint32_t         stream,
+                           std::string_view payload = {});
+
+        static FrameDecodeStatus decode(const char* data,
+                                        size_t      size,
+                                        MuxFrame&   dest,
+                                        size_t&     consumed,
+                                        size_t      maxPayload = Default::MuxChunk);
+    };
+
+    class Multiplexer;
+
+    // One bidirectional channel of a Multiplexer. It reads and writes
+    // like the socket streams; send and receive are the unformatted
+    // calls underneath. A stream stays registered until both sides
+    // have closed it or either side resets it, and must not be used
+    // once its multiplexer is destroyed.
+    class MuxStream final : public std::iostream,
+                            public std::enable_shared_from_this<MuxStream>
+    {
+    public:
+        class StreamBuffer final : public std::streambuf
+        {
+        private:
+            MuxStream& _stream;
+            String     _get;
+
+        public:
+            explicit StreamBuffer(MuxStream& stream);
+
+        protected:
+            int_type underflow() override;
+
+            int_type overflow(int_type ch) override;
+
+            std::streamsize xsputn(const char* ptr, std::streamsize count) override;
+        };
+
+    private:
+        friend class Multiplexer;
+
+        Multiplexer* const      _mux;
+        const uint32_t          _id;
+        StreamBuffer            _buffer;
+        std::condition_variable _readable;
+        std::condition_variable _writable;
+        String                  _in;
+        size_t                  _read{0};
+        size_t                  _unacked{0};
+        String                  _out;
+        size_t                  _sent{0};
+        size_t                  _credit{Default::MuxWindow};
+        bool                    _scheduled{false};
+        bool                    _finQueued{false};
+        bool                    _finSent{false};
+        bool                    _finReceived{false};
+        bool                    _reset{false};
+        int                     _timeout{Default::SocketTimeOut};
+
+    public:
+        MuxStream(Multiplexer* mux, uint32_t id);
+        ~MuxStream() override;
+
+        MuxStream(const MuxStream&)            = delete;
+        MuxStream& operator=(const MuxStream&) = delete;
+
+        uint32_t id() const;
+
+        // Queues data behind what is already waiting, blocking while
+        // a full window is queued. The multiplexer sends it as the
+        // peer grants credit, interleaved with the other streams.
+        Status send(std::string_view data, int timeout = Default::SocketTimeOut);
+
+        // Waits for data and copies out up to size bytes. ClosedStatus
+        // means the peer finished and everything has been read;
+        // ErrorStatus means the stream was reset.
+        Status receive(char*   dest,
+                       size_t  size,
+                       size_t& received,
+                       int     timeout = Default::SocketTimeOut);
+
+        // Half close: the peer reads to the end of what was sent.
+        void close();
+
+        // Abandons the stream on both sides, dropping unsent data.
+        void reset();
+
+        // True once nothing more can be read.
+        bool isClosed() const;
+
+        void setTimeout(int ms);
+
+        bool readExactly(size_t n, String& dest);
+
+        // Reads up to and including the delimiter, which is consumed
+        // but not copied into dest.
+        bool readUntil(const String& delimiter, String& dest);
+
+        // Everything up to the peer's close.
+        String string();
+
+        template <typename... Args>
+        void println(Args&&... args)
+        {
+            OStream& os = *this;
+            ((os << std::forward<Args>(args)), ...);
+            os << std::endl;
+        }
+
+        template <typename... Args>
+        void write(Args&&... args)
+        {
+            OStream& os = *this;
+            ((os << std::forward<Args>(args)), ...);
+        }
+
+        template <typename... Args>
+        void get(Args&&... args)
+        {
+            IStream& is = *this;
+            ((is >> std::forward<Args>(args)), ...);
+        }
+    };
+
+    using MuxStreamPtr = std::shared_ptr<MuxStream>;
+
+    // Carries many independent streams over one connected socket. Each
+    // stream has its own flow control window, so a slow reader only
+    // stalls its own stream, and a writer thread takes at most one
+    // chunk from each ready stream per turn so a large transfer cannot
+    // starve the others. The side that connected opens odd stream ids
+    // and the side that accepted opens even ones.
+    //
+    // The socket is not owned and must outlive the multiplexer.
+    class Multiplexer final : Thread::Runner
+    {
+    private:
+        friend class MuxStream;
+
+        using StreamMap = std::unordered_map<uint32_t, MuxStreamPtr>;
+
+        PlatformSocket           _sock{InvalidSocket};
+        RecvBuffer               _buffer;
+        StreamMap                _streams;
+        std::deque<MuxStreamPtr> _ready;
+        std::deque<MuxStreamPtr> _pending;
+        String                   _control;
+        mutable std::mutex       _lock;
+        std::condition_variable  _work;
+        std::condition_variable  _accepted;
+        Thread::StandardThread   _writer;
+        uint32_t                 _next;
+        size_t                   _backlog{Default::MuxBacklog};
+        std::atomic<bool>        _open{false};
+
+        void update() override;
+
+        void writeLoop();
+
+        void dispatch(const MuxFrame& frame);
+
+        void schedule(const MuxStreamPtr& stream);
+
+        void control(MuxFrameType type, uint32_t stream, std::string_view payload = {});
+
+        void release(const MuxStream& stream);
+
+        void fail();
+
+        bool isSendable(const MuxStream& stream) const;
+
+    public:
+        Multiplexer(const PlatformSocket& sock, bool initiator);
+        ~Multiplexer() override;
+
+        Multiplexer(const Multiplexer&)            = delete;
+        Multiplexer& operator=(const Multiplexer&) = delete;
+
+        // Opens a stream; the peer sees it in accept.
+        MuxStreamPtr open();
+
+        // Waits for a stream opened by the peer. Returns null on timeout
+        // or once the connection is gone.
+        MuxStreamPtr accept(int timeout = Default::SocketTimeOut);
+
+        // Sends what is already queued, then stops both threads and
+        // resets every stream still open.
+        void close();
+
+        bool isOpen() const;
+
+        size_t streams() const;
+
+        // Streams opened by the peer that may wait in accept; any more
+        // are reset.
+        void setBacklog(size_t streams);
+    };
+
+    inline uint32_t MuxStream::id() const
+    {
+        return _id;
+    }
+
+    inline void MuxStream::setTimeout(const int ms)
+    {
+        _timeout = ms;
+    }
+
+    inline bool Multiplexer::isOpen() const
+    {
+        return _open;
+    }
+
+}  // namespace Rt2::Sockets
@@ -0,0 +1,236 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#include "Sockets/NetBackend.h"
+#include <cstring>
+#if RT_PLATFORM != RT_PLATFORM_WINDOWS
+    #include <poll.h>
+    #include <sys/uio.h>
+    #include <unistd.h>
+#endif
+
+namespace Rt2::Sockets
+{
+    SystemBackend& SystemBackend::instance()
+    {
+        static SystemBackend system;
+        return system;
+    }
+
+    int64_t SystemBackend::send(const PlatformSocket& sock, const char* src, const size_t size)
+    {
+#if RT_PLATFORM == RT_PLATFORM_WINDOWS
+        return ::send(sock, src, (int)size, 0);
+#else
+        ssize_t rc;
+        do
+        {
+    #ifdef MSG_NOSIGNAL
+            rc = ::send(sock, src, size, MSG_NOSIGNAL);
+    #else
+            rc = ::send(sock, src, size, 0);
+    #endif
+        } while (rc < 0 && errno == EINTR);
+        return rc;
+#endif
+    }
+
+    int64_t SystemBackend::sendVector(const PlatformSocket& sock, IoVector* vectors, const int count)
+    {
+#if RT_PLATFORM == RT_PLATFORM_WINDOWS
+        DWORD written = 0;
+        if (WSASend(sock, vectors, (DWORD)count, &written, 0, nullptr, nullptr) != 0)
+            return -1;
+        return (int64_t)written;
+#else
+        msghdr msg{};
+        msg.msg_iov    = vectors;
+        msg.msg_iovlen = (size_t)count;
+
+        ssize_t rc;
+        do
+        {
+    #ifdef MSG_NOSIGNAL
+            rc = sendmsg(sock, &msg, MSG_NOSIGNAL);
+    #else
+            rc = sendmsg(sock, &msg, 0);
+    #endif
+        } while (rc < 0 && errno == EINTR);
+        return rc;
+#endif
+    }
+
+    int64_t SystemBackend::receive(const PlatformSocket& sock, char* dest, const size_t size)
+    {
+        int64_t rl;
+        do
+        {
+            rl = recv(sock, dest, (int)size, 0);
+        } while (rl < 0 && errno == EINTR);
+        return rl;
+    }
+
+    int64_t SystemBackend::receiveVector(const PlatformSocket& sock, IoVector* vectors, const int count)
+    {
+#if RT_PLATFORM == RT_PLATFORM_WINDOWS
+        DWORD received = 0, flags = 0;
+        if (WSARecv(sock, vectors, (DWORD)count, &received, &flags, nullptr, nullptr) != 0)
+            return -1;
+        return (int64_t)received;
+#else
+        ssize_t rl;
+        do
+        {
+            rl = readv(sock, vectors, count);
+        } while (rl < 0 && errno == EINTR);
+        return rl;
+#endif
+    }
+
+    int64_t SystemBackend::receiveNow(const PlatformSocket& sock, char* dest, const size_t size)
+    {
+#if RT_PLATFORM == RT_PLATFORM_WINDOWS
+        // no per-call flag; check readiness without waiting instead
+        const int ready = poll(sock, 0, Read);
+        if (ready <= 0)
+        {
+            if (ready == 0)
+                WSASetLastError(WSAEWOULDBLOCK);
+            return -1;
+        }
+        return receive(sock, dest, size);
+#else
+        int64_t rl;
+        do
+        {
+            rl = recv(sock, dest, size, MSG_DONTWAIT);
+        } while (rl < 0 && errno == EINTR);
+        return rl;
+#endif
+    }
+
+    int64_t SystemBackend::receiveStamped(const PlatformSocket& sock,
+                                          char*                 dest,
+                                          const size_t          size,
+                                          const bool            peek,
+                                          RecvTimestamp&        stamp)
+    {
+        stamp = {};
+#if RT_PLATFORM == RT_PLATFORM_WINDOWS
+        int64_t rl;
+        do
+        {
+            rl = recv(sock, dest, (int)size, peek ? MSG_PEEK : 0);
+        } while (rl < 0 && errno == EINTR);
+        return rl;
+#else
+        iovec vec{dest, size};
+
+        // room for SCM_TIMESTAMPING's three stamps and then some
+        char   control[CMSG_SPACE(sizeof(timespec) * 3) + 64];
+        msghdr msg{};
+        msg.msg_iov        = &vec;
+        msg.msg_iovlen     = 1;
+        msg.msg_control    = control;
+        msg.msg_controllen = sizeof control;
+
+        ssize_t rl;
+        do
+        {
+            rl = recvmsg(sock, &msg, peek ? MSG_PEEK : 0);
+        } while (rl < 0 && errno == EINTR);
+
+        if (rl <= 0)
+            return rl;
+
+        for (cmsghdr* cm = CMSG_FIRSTHDR(&msg); cm; cm = CMSG_NXTHDR(&msg, cm))
+        {
+            if (cm->cmsg_level != SOL_SOCKET)
+                continue;
+
+            timespec ts[3]{};
+    #ifdef SCM_TIMESTAMPNS
+            if (cm->cmsg_type == SCM_TIMESTAMPNS)
+            {
+                memcpy(ts, CMSG_DATA(cm), sizeof(timespec));
+                stamp.nanoseconds = ts[0].tv_sec * 1000000000ll + ts[0].tv_nsec;
+            }
+    #endif
+    #ifdef SCM_TIMESTAMPING
+            if (cm->cmsg_type == SCM_TIMESTAMPING)
+            {
+                // software, legacy and raw hardware, in that order
+                memcpy(ts, CMSG_DATA(cm), sizeof ts);
+                const timespec& pick = ts[2].tv_sec || ts[2].tv_nsec ? ts[2] : ts[0];
+
+                stamp.nanoseconds = pick.tv_sec * 1000000000ll + pick.tv_nsec;
+                stamp.hardware    = &pick == &ts[2];
+            }
+    #endif
+        }
+        return rl;
+#endif
+    }
+
+    int SystemBackend::poll(const PlatformSocket& sock, const int timeout, const int mode)
+    {
+        // poll rather than select: an fd_set only holds descriptors
+        // below FD_SETSIZE, and servers here routinely go past it
+        short events = 0;
+        if (mode == Read || mode == ReadWrite)
+            events |= POLLIN;
+        if (mode == Write || mode == ReadWrite)
+            events |= POLLOUT;
+        if (events == 0)
+            return -1;
+
+#if RT_PLATFORM == RT_PLATFORM_WINDOWS
+        WSAPOLLFD entry{sock, events, 0};
+
+        const int rc = WSAPoll(&entry, 1, timeout < 0 ? -1 : timeout);
+#else
+        pollfd entry{sock, events, 0};
+
+        const int rc = ::poll(&entry, 1, timeout < 0 ? -1 : timeout);
+#endif
+        // select failed on a closed descriptor; keep that behaviour
+        if (rc > 0 && (entry.revents & POLLNVAL))
+        {
+#if RT_PLATFORM == RT_PLATFORM_WINDOWS
+            WSASetLastError(WSAENOTSOCK);
+#else
+            errno = EBADF;
+#endif
+            return -1;
+        }
+        return rc;
+    }
+
+    int SystemBackend::close(const PlatformSocket& sock)
+    {
+#if RT_PLATFORM == RT_PLATFORM_WINDOWS
+        return closesocket(sock);
+#else
+        return ::close(sock);
+#endif
+    }
+
+}  // namespace Rt2::Sockets
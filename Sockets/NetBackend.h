@@ -0,0 +1,94 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#pragma once
+#include "Sockets/PlatformSocket.h"
+
+namespace Rt2::Sockets
+{
+    // The calls Net makes to move data on a connected socket. Each one
+    // returns what the system call it stands for would, and reports a
+    // failure through errno (the WSA error on Windows), so Net's
+    // timeouts, error recording and metrics work the same on any
+    // backend.
+    class NetBackend
+    {
+    public:
+        virtual ~NetBackend() = default;
+
+        // Bytes sent, or -1.
+        virtual int64_t send(const PlatformSocket& sock, const char* src, size_t size) = 0;
+
+        virtual int64_t sendVector(const PlatformSocket& sock, IoVector* vectors, int count) = 0;
+
+        // Bytes received, zero at the end of the stream, or -1.
+        virtual int64_t receive(const PlatformSocket& sock, char* dest, size_t size) = 0;
+
+        virtual int64_t receiveVector(const PlatformSocket& sock, IoVector* vectors, int count) = 0;
+
+        // receive that fails with would-block rather than waiting, even
+        // on a blocking socket.
+        virtual int64_t receiveNow(const PlatformSocket& sock, char* dest, size_t size) = 0;
+
+        // receive, or a peek that leaves the data queued, that also
+        // fills in the receive timestamp when one came with the data.
+        virtual int64_t receiveStamped(const PlatformSocket& sock,
+                                       char*                 dest,
+                                       size_t                size,
+                                       bool                  peek,
+                                       RecvTimestamp&        stamp) = 0;
+
+        // Above zero when sock is ready for mode, zero on timeout and
+        // -1 on failure. A negative timeout waits indefinitely.
+        virtual int poll(const PlatformSocket& sock, int timeout, int mode) = 0;
+
+        virtual int close(const PlatformSocket& sock) = 0;
+    };
+
+    // The operating system's sockets. Net uses this one unless
+    // another backend is installed.
+    class SystemBackend final : public NetBackend
+    {
+    public:
+        static SystemBackend& instance();
+
+        int64_t send(const PlatformSocket& sock, const char* src, size_t size) override;
+
+        int64_t sendVector(const PlatformSocket& sock, IoVector* vectors, int count) override;
+
+        int64_t receive(const PlatformSocket& sock, char* dest, size_t size) override;
+
+        int64_t receiveVector(const PlatformSocket& sock, IoVector* vectors, int count) override;
+
+        int64_t receiveNow(const PlatformSocket& sock, char* dest, size_t size) override;
+
+        int64_t receiveStamped(const PlatformSocket& sock,
+                               char*                 dest,
+                               size_t                size,
+                               bool                  peek,
+                               RecvTimestamp&        stamp) override;
+
+        int poll(const PlatformSocket& sock, int timeout, int mode) override;
+
+        int close(const PlatformSocket& sock) override;
+    };
+
+}  // namespace Rt2::Sockets
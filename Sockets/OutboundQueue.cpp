@@ -0,0 +1,206 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#include "Sockets/OutboundQueue.h"
+#include <chrono>
+
+namespace Rt2::Sockets
+{
+    OutboundQueue::OutboundQueue(const PlatformSocket& sock) :
+        _sock(sock)
+    {
+    }
+
+    bool OutboundQueue::push(const SharedBuffer& buffer)
+    {
+        RT_GUARD_RET(!buffer.empty(), true)
+
+        // copied under the lock, since onHigh may replace it meanwhile
+        WatermarkHandler notify;
+        {
+            std::lock_guard guard(_lock);
+            if (_queued + buffer.size() > _limit)
+                return false;
+
+            _chain.push_back(buffer);
+            _queued += buffer.size();
+            if (!_paused && _queued >= _high)
+            {
+                _paused = true;
+                notify  = _onHigh;
+            }
+        }
+
+        if (notify)
+            notify();
+        return true;
+    }
+
+    bool OutboundQueue::push(String&& data)
+    {
+        return push(SharedBuffer(std::move(data)));
+    }
+
+    void OutboundQueue::release(size_t bytes)
+    {
+        _queued -= bytes;
+        while (bytes > 0)
+        {
+            const size_t front = _chain.front().size() - _offset;
+            if (bytes < front)
+            {
+                _offset += bytes;
+                break;
+            }
+            bytes -= front;
+            _offset = 0;
+            _chain.pop_front();
+        }
+    }
+
+    Status OutboundQueue::flush()
+    {
+        Status           status = OkStatus;
+        WatermarkHandler notify;
+        {
+            std::lock_guard guard(_lock);
+            while (!_chain.empty())
+            {
+                IoVector vec[Default::QueueVectors];
+
+                int count = 0;
+                for (auto it = _chain.begin();
+                     it != _chain.end() && count < Default::QueueVectors;
+                     ++it)
+                {
+                    const size_t skip = count == 0 ? _offset : 0;
+                    Net::Utils::makeVector(vec[count++], it->data() + skip, it->size() - skip);
+                }
+
+                int sent = 0;
+                status   = Net::sendVector(_sock, vec, count, sent);
+                if (status == ErrorStatus)
+                    break;
+
+                release((size_t)sent);
+                if (status == TimeoutStatus || sent == 0)
+                {
+                    status = TimeoutStatus;
+                    break;
+                }
+            }
+
+            if (status != ErrorStatus && _chain.empty())
+                status = OkStatus;
+            if (_paused && _queued <= _low)
+            {
+                _paused = false;
+                notify  = _onLow;
+            }
+        }
+
+        if (notify)
+            notify();
+        return status;
+    }
+
+    Status OutboundQueue::drain(const int timeout)
+    {
+        using Clock = std::chrono::steady_clock;
+
+        const auto end = Clock::now() + std::chrono::milliseconds(timeout);
+
+        Status status;
+        while ((status = flush()) == TimeoutStatus)
+        {
+            const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                  end - Clock::now())
+                                  .count();
+            if (left <= 0)
+                break;
+            Net::poll(_sock, (int)left, Write);
+        }
+        return status;
+    }
+
+    void OutboundQueue::clear()
+    {
+        WatermarkHandler notify;
+        {
+            std::lock_guard guard(_lock);
+            _chain.clear();
+            _offset = 0;
+            _queued = 0;
+            if (_paused)
+                notify = _onLow;
+            _paused = false;
+        }
+
+        if (notify)
+            notify();
+    }
+
+    void OutboundQueue::setWatermarks(const size_t low, const size_t high)
+    {
+        RT_GUARD_CHECK_VOID(low <= high)
+
+        std::lock_guard guard(_lock);
+        _low  = low;
+        _high = high;
+    }
+
+    void OutboundQueue::setLimit(const size_t limit)
+    {
+        std::lock_guard guard(_lock);
+        _limit = limit;
+    }
+
+    void OutboundQueue::onHigh(const WatermarkHandler& handler)
+    {
+        std::lock_guard guard(_lock);
+        _onHigh = handler;
+    }
+
+    void OutboundQueue::onLow(const WatermarkHandler& handler)
+    {
+        std::lock_guard guard(_lock);
+        _onLow = handler;
+    }
+
+    bool OutboundQueue::isPaused() const
+    {
+        std::lock_guard guard(_lock);
+        return _paused;
+    }
+
+    bool OutboundQueue::empty() const
+    {
+        std::lock_guard guard(_lock);
+        return _chain.empty();
+    }
+
+    size_t OutboundQueue::size() const
+    {
+        std::lock_guard guard(_lock);
+        return _queued;
+    }
+
+}  // namespace Rt2::Sockets
@@ -0,0 +1,114 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#pragma once
+#include <deque>
+#include <functional>
+#include <mutex>
+#include "Sockets/PlatformSocket.h"
+#include "Sockets/SharedBuffer.h"
+
+namespace Rt2::Sockets
+{
+    namespace Default
+    {
+        constexpr size_t QueueHighWater = 0x40000;
+        constexpr size_t QueueLowWater  = 0x10000;
+        constexpr size_t QueueLimit     = 0x400000;
+        constexpr int    QueueVectors   = 0x40;
+    }  // namespace Default
+
+    using WatermarkHandler = std::function<void()>;
+
+    // Chain of buffers waiting to go out on one socket. Producers push
+    // without blocking; flush sends what the socket will take right
+    // now and is meant to be driven by write readiness. Crossing the
+    // high watermark calls onHigh so producers can pause, and draining
+    // back to the low watermark calls onLow so they can resume. Nothing
+    // is queued past the hard limit.
+    //
+    // push and flush may be called from different threads. Watermark
+    // handlers run on the calling thread with the queue unlocked.
+    class OutboundQueue
+    {
+    private:
+        PlatformSocket           _sock{InvalidSocket};
+        std::deque<SharedBuffer> _chain;
+        mutable std::mutex       _lock;
+        size_t                   _offset{0};
+        size_t                   _queued{0};
+        size_t                   _high{Default::QueueHighWater};
+        size_t                   _low{Default::QueueLowWater};
+        size_t                   _limit{Default::QueueLimit};
+        bool                     _paused{false};
+        WatermarkHandler         _onHigh;
+        WatermarkHandler         _onLow;
+
+        void release(size_t bytes);
+
+    public:
+        explicit OutboundQueue(const PlatformSocket& sock);
+
+        OutboundQueue(const OutboundQueue&)            = delete;
+        OutboundQueue& operator=(const OutboundQueue&) = delete;
+
+        // Returns false, queuing nothing, when the buffer would take
+        // the queue past its limit.
+        bool push(const SharedBuffer& buffer);
+
+        bool push(String&& data);
+
+        // Sends from the front of the chain until it is empty or the
+        // socket would block. Returns OkStatus when drained, TimeoutStatus
+        // when bytes remain and ErrorStatus when the socket failed.
+        Status flush();
+
+        // Flushes, waiting for write readiness between attempts, until
+        // the chain is empty or timeout milliseconds have passed.
+        Status drain(int timeout = Default::SocketTimeOut);
+
+        void clear();
+
+        void setWatermarks(size_t low, size_t high);
+
+        void setLimit(size_t limit);
+
+        void onHigh(const WatermarkHandler& handler);
+
+        void onLow(const WatermarkHandler& handler);
+
+        // True between crossing the high watermark and draining to the
+        // low one.
+        bool isPaused() const;
+
+        bool empty() const;
+
+        size_t size() const;
+
+        const PlatformSocket& socket() const;
+    };
+
+    inline const PlatformSocket& OutboundQueue::socket() const
+    {
+        return _sock;
+    }
+
+}  // namespace Rt2::Sockets
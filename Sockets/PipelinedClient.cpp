@@ -0,0 +1,257 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#include "Sockets/PipelinedClient.h"
+#include <algorithm>
+#include <memory>
+
+namespace Rt2::Sockets
+{
+    PipelinedClient::~PipelinedClient()
+    {
+        close();
+    }
+
+    Status PipelinedClient::connect(const String&       ipv4,
+                                    const uint16_t      port,
+                                    const SocketConfig& config)
+    {
+        close();
+        _buffer.clear();
+
+        _socket.open(ipv4, port, config);
+        if (!_socket.isValid())
+            return ErrorStatus;
+
+        _open = true;
+        start();
+        return OkStatus;
+    }
+
+    Status PipelinedClient::request(const std::string_view payload,
+                                    const FrameReply&      reply,
+                                    const int              timeout)
+    {
+        RT_GUARD_RET(reply && payload.size() <= _maxPayload, ErrorStatus)
+
+        const auto deadline = Clock::now() + std::chrono::milliseconds(timeout);
+
+        uint32_t id;
+        {
+            std::unique_lock lock(_lock);
+            if (!_slots.wait_until(lock,
+                                   deadline,
+                                   [this]
+                                   { return !_open || _pending.size() < _window; }))
+                return TimeoutStatus;
+            if (!_open)
+                return ClosedStatus;
+
+            // skip ids still waiting after a wrap
+            do
+                id = _next++;
+            while (_pending.find(id) != _pending.end());
+
+            _pending.emplace(id, Pending{reply, deadline});
+            _deadlines.emplace(deadline, id);
+        }
+
+        Status st;
+        {
+            std::lock_guard write(_write);
+            st = FrameCodec::write(_socket.socket(), id, payload, timeout);
+        }
+
+        if (st != OkStatus)
+        {
+            // a partial frame leaves the stream unusable
+            bool owned;
+            {
+                std::lock_guard lock(_lock);
+                owned = _pending.erase(id) != 0;
+            }
+            fail(ErrorStatus);
+
+            // A close, a failed read or the timeout may have claimed the
+            // request while it was written; its reply has already run.
+            if (!owned)
+                return OkStatus;
+        }
+        return st;
+    }
+
+    std::future<FrameResult> PipelinedClient::request(const std::string_view payload,
+                                                      const int              timeout)
+    {
+        auto promise = std::make_shared<std::promise<FrameResult>>();
+
+        std::future<FrameResult> result = promise->get_future();
+
+        const Status st = request(
+            payload,
+            [promise](const Status status, const std::string_view data)
+            { promise->set_value({status, String(data)}); },
+            timeout);
+
+        if (st != OkStatus)
+            promise->set_value({st, {}});
+        return result;
+    }
+
+    void PipelinedClient::update()
+    {
+        while (isRunning() && _open)
+        {
+            Frame  frame;
+            size_t used = 0;
+
+            FrameDecodeStatus ds;
+            while ((ds = FrameCodec::decode(_buffer.data(),
+                                            _buffer.size(),
+                                            frame,
+                                            used,
+                                            _maxPayload)) == FrameComplete)
+            {
+                complete(frame);
+                _buffer.consume(used);
+            }
+
+            if (ds == FrameTooLarge)
+            {
+                fail(ErrorStatus);
+                break;
+            }
+
+            expire();
+
+            const Status st = _buffer.fill(_socket.socket(), nextWait());
+            if (st != OkStatus && st != TimeoutStatus)
+            {
+                fail(st);
+                break;
+            }
+        }
+    }
+
+    void PipelinedClient::complete(const Frame& frame)
+    {
+        FrameReply reply;
+        {
+            std::lock_guard lock(_lock);
+
+            // a response after its deadline has already been answered
+            const auto it = _pending.find(frame.id);
+            if (it == _pending.end())
+                return;
+            reply = std::move(it->second.reply);
+            _pending.erase(it);
+        }
+        _slots.notify_one();
+        reply(OkStatus, frame.payload);
+    }
+
+    void PipelinedClient::expire()
+    {
+        std::vector<FrameReply> expired;
+        {
+            std::lock_guard lock(_lock);
+
+            const auto now = Clock::now();
+            while (!_deadlines.empty() && _deadlines.top().first <= now)
+            {
+                // entries are left behind by completed requests, so
+                // only one whose deadline still matches has timed out
+                const auto [deadline, id] = _deadlines.top();
+                _deadlines.pop();
+
+                const auto it = _pending.find(id);
+                if (it != _pending.end() && it->second.deadline == deadline)
+                {
+                    expired.push_back(std::move(it->second.reply));
+                    _pending.erase(it);
+                }
+            }
+            if (_pending.empty())
+                _deadlines = {};
+        }
+
+        if (!expired.empty())
+            _slots.notify_all();
+        for (const FrameReply& reply : expired)
+            reply(TimeoutStatus, {});
+    }
+
+    void PipelinedClient::fail(const Status status)
+    {
+        std::unordered_map<uint32_t, Pending> failed;
+        {
+            std::lock_guard lock(_lock);
+            _open = false;
+            failed.swap(_pending);
+            _deadlines = {};
+        }
+
+        _slots.notify_all();
+        for (auto& [id, pending] : failed)
+            pending.reply(status, {});
+    }
+
+    int PipelinedClient::nextWait() const
+    {
+        std::lock_guard lock(_lock);
+        if (_deadlines.empty())
+            return Default::PipelineTick;
+
+        const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+                              _deadlines.top().first - Clock::now())
+                              .count();
+        return (int)std::clamp<int64_t>(left + 1, 0, Default::PipelineTick);
+    }
+
+    void PipelinedClient::close()
+    {
+        _open = false;
+        stop();
+        fail(ClosedStatus);
+        _socket.close();
+    }
+
+    size_t PipelinedClient::inFlight() const
+    {
+        std::lock_guard lock(_lock);
+        return _pending.size();
+    }
+
+    void PipelinedClient::setWindow(const size_t requests)
+    {
+        {
+            std::lock_guard lock(_lock);
+            _window = std::max<size_t>(requests, 1);
+        }
+        _slots.notify_all();
+    }
+
+    void PipelinedClient::setMaxPayload(const size_t bytes)
+    {
+        _maxPayload = bytes;
+    }
+
+}  // namespace Rt2::Sockets
@@ -0,0 +1,140 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <queue>
+#include <unordered_map>
+#include "Sockets/ClientSocket.h"
+#include "Sockets/Frame.h"
+#include "Thread/Runner.h"
+
+namespace Rt2::Sockets
+{
+    namespace Default
+    {
+        constexpr size_t PipelineWindow  = 0x80;
+        constexpr int    PipelineTimeOut = 5000;
+        constexpr int    PipelineTick    = 20;
+    }  // namespace Default
+
+    // Called once per request from the reader thread: OkStatus with the
+    // response, TimeoutStatus when none came in time, or ClosedStatus
+    // and ErrorStatus when the connection ended first. The view is only
+    // valid for the duration of the call.
+    using FrameReply = std::function<void(Status status, std::string_view payload)>;
+
+    struct FrameResult
+    {
+        Status status{ErrorStatus};
+        String payload;
+    };
+
+    // Many requests in flight on one connection. Each request is framed
+    // with a correlation id and written at once; a reader thread matches
+    // responses by id in whatever order the server sends them, so the
+    // cost of a round trip is paid once per window rather than once per
+    // request. Requests may be issued from any thread.
+    class PipelinedClient final : Thread::Runner
+    {
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        struct Pending
+        {
+            FrameReply        reply;
+            Clock::time_point deadline;
+        };
+
+        using Deadline = std::pair<Clock::time_point, uint32_t>;
+
+        using DeadlineQueue = std::priority_queue<Deadline, std::vector<Deadline>, std::greater<>>;
+
+        ClientSocket                          _socket;
+        RecvBuffer                            _buffer;
+        std::unordered_map<uint32_t, Pending> _pending;
+        DeadlineQueue                         _deadlines;
+        mutable std::mutex                    _lock;
+        std::condition_variable               _slots;
+        std::mutex                            _write;
+        uint32_t                              _next{1};
+        size_t                                _window{Default::PipelineWindow};
+        size_t                                _maxPayload{Default::FrameMaxPayload};
+        std::atomic<bool>                     _open{false};
+
+        void update() override;
+
+        void complete(const Frame& frame);
+
+        void expire();
+
+        void fail(Status status);
+
+        int nextWait() const;
+
+    public:
+        PipelinedClient() = default;
+        ~PipelinedClient() override;
+
+        PipelinedClient(const PipelinedClient&)            = delete;
+        PipelinedClient& operator=(const PipelinedClient&) = delete;
+
+        Status connect(const String&       ipv4,
+                       uint16_t            port,
+                       const SocketConfig& config = {});
+
+        // Sends a request and returns without waiting for the response.
+        // Blocks while the window is full, for no longer than timeout,
+        // which also bounds the wait for the response. reply is called
+        // once when OkStatus is returned, and never otherwise.
+        Status request(std::string_view  payload,
+                       const FrameReply& reply,
+                       int               timeout = Default::PipelineTimeOut);
+
+        // As above, with the outcome delivered through a future.
+        std::future<FrameResult> request(std::string_view payload,
+                                         int              timeout = Default::PipelineTimeOut);
+
+        // Stops the reader and fails whatever is still in flight with
+        // ClosedStatus.
+        void close();
+
+        bool isOpen() const;
+
+        size_t inFlight() const;
+
+        // Upper bound on requests awaiting a response.
+        void setWindow(size_t requests);
+
+        void setMaxPayload(size_t bytes);
+    };
+
+    inline bool PipelinedClient::isOpen() const
+    {
+        return _open;
+    }
+
+}  // namespace Rt2::Sockets
@@ -20,9 +20,16 @@
 -------------------------------------------------------------------------------
 */
 #include "Sockets/PlatformSocket.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cmath>
 #include <cstdio>
 #include <iostream>
+#include <mutex>
+#include "Sockets/Metrics.h"
+#include "Sockets/NetBackend.h"
+#include "Sockets/Trace.h"
 #include "Thread/Thread.h"
 #include "Utils/Char.h"
 #include "Utils/Definitions.h"
@@ -34,13 +41,53 @@
     #include <fcntl.h>
     #include <poll.h>
     #include <sys/select.h>
+    #include <sys/un.h>
     #include <unistd.h>
     #include <cstring>
+    #ifdef __linux__
+        #include <linux/errqueue.h>
+    #endif
+#endif
+
+#if defined(MSG_ZEROCOPY) && defined(SO_EE_ORIGIN_ZEROCOPY)
+    #define SOCKETS_HAS_ZEROCOPY 1
 #endif
 
 // #define VERBOSE_DEBUG
 namespace Rt2::Sockets
 {
+    namespace
+    {
+        // null until a backend is installed, which means the system
+        std::atomic<NetBackend*> Backend{nullptr};
+    }  // namespace
+
+    void Net::setBackend(NetBackend* backend)
+    {
+        Backend.store(backend);
+    }
+
+    NetBackend& Net::backend()
+    {
+        NetBackend* backend = Backend.load(std::memory_order_acquire);
+        return backend ? *backend : SystemBackend::instance();
+    }
+
+    namespace
+    {
+        // Sends use MSG_NOSIGNAL where it exists; elsewhere a write to a
+        // closed peer would raise SIGPIPE unless the socket opts out.
+        void suppressSigPipe(const PlatformSocket& sock)
+        {
+#if defined(SO_NOSIGPIPE) && !defined(MSG_NOSIGNAL)
+            int on = 1;
+            setsockopt(sock, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof on);
+#else
+            (void)sock;
+#endif
+        }
+    }  // namespace
+
     PlatformSocket Net::create(
         const AddressFamily address,
         const SocketType    type,
@@ -48,19 +95,153 @@ namespace Rt2::Sockets
         const bool          block)
     {
         const PlatformSocket sock = socket(address, type, protocol);
+        if (sock == InvalidSocket)
+            Error::record(OpCreate);
+        else
+            suppressSigPipe(sock);
         return sock;
     }
 
-    void Net::close(const PlatformSocket& sock)
+    PlatformSocket Net::duplicate(const PlatformSocket& sock)
+    {
+        RT_GUARD_CHECK_RET(sock != InvalidSocket, InvalidSocket)
+#if RT_PLATFORM == RT_PLATFORM_WINDOWS
+        WSAPROTOCOL_INFOW info{};
+        if (WSADuplicateSocketW(sock, GetCurrentProcessId(), &info) != 0)
+        {
+            Error::record(OpDuplicate);
+            return InvalidSocket;
+        }
+
+        const PlatformSocket copy = WSASocketW(info.iAddressFamily,
+                                               info.iSocketType,
+                                               info.iProtocol,
+                                               &info,
+                                               0,
+                                               WSA_FLAG_OVERLAPPED);
+        if (copy == InvalidSocket)
+            Error::record(OpDuplicate);
+        return copy;
+#else
+    #ifdef F_DUPFD_CLOEXEC
+        const int fd = fcntl(sock, F_DUPFD_CLOEXEC, 0);
+    #else
+        const int fd = dup(sock);
+    #endif
+        if (fd < 0)
+        {
+            Error::record(OpDuplicate);
+            return InvalidSocket;
+        }
+        return fd;
+#endif
+    }
+
+    Status Net::sendHandle(
+        const PlatformSocket& channel,
+        const PlatformSocket& handle)
     {
 #if RT_PLATFORM == RT_PLATFORM_WINDOWS
-        if (closesocket(sock) != 0)
-            Error::log();
+        (void)channel;
+        (void)handle;
+        return ErrorStatus;
 #else
-        ::close(sock);
+        RT_GUARD_CHECK_RET(channel != InvalidSocket && handle != InvalidSocket, ErrorStatus)
+
+        // one byte of payload carries the descriptor
+        char  tag = 'H';
+        iovec vec{&tag, 1};
+
+        char   control[CMSG_SPACE(sizeof(int))]{};
+        msghdr msg{};
+        msg.msg_iov        = &vec;
+        msg.msg_iovlen     = 1;
+        msg.msg_control    = control;
+        msg.msg_controllen = sizeof control;
+
+        cmsghdr* cm    = CMSG_FIRSTHDR(&msg);
+        cm->cmsg_level = SOL_SOCKET;
+        cm->cmsg_type  = SCM_RIGHTS;
+        cm->cmsg_len   = CMSG_LEN(sizeof(int));
+        memcpy(CMSG_DATA(cm), &handle, sizeof(int));
+
+        ssize_t rc;
+        do
+        {
+            rc = sendmsg(channel, &msg, MSG_NOSIGNAL);
+        } while (rc < 0 && errno == EINTR);
+
+        if (rc != 1)
+        {
+            Error::record(OpWrite);
+            return ErrorStatus;
+        }
+        return OkStatus;
 #endif
     }
 
+    Status Net::receiveHandle(
+        const PlatformSocket& channel,
+        PlatformSocket&       dest,
+        const int             timeout)
+    {
+        dest = InvalidSocket;
+#if RT_PLATFORM == RT_PLATFORM_WINDOWS
+        (void)channel;
+        (void)timeout;
+        return ErrorStatus;
+#else
+        RT_GUARD_CHECK_RET(channel != InvalidSocket, ErrorStatus)
+        if (!poll(channel, timeout, Read))
+            return TimeoutStatus;
+
+        char  tag = 0;
+        iovec vec{&tag, 1};
+
+        char   control[CMSG_SPACE(sizeof(int))]{};
+        msghdr msg{};
+        msg.msg_iov        = &vec;
+        msg.msg_iovlen     = 1;
+        msg.msg_control    = control;
+        msg.msg_controllen = sizeof control;
+
+        int flags = 0;
+    #ifdef MSG_CMSG_CLOEXEC
+        flags |= MSG_CMSG_CLOEXEC;
+    #endif
+
+        ssize_t rc;
+        do
+        {
+            rc = recvmsg(channel, &msg, flags);
+        } while (rc < 0 && errno == EINTR);
+
+        if (rc == 0)
+            return ClosedStatus;
+        if (rc < 0)
+        {
+            Error::record(OpRead);
+            return ErrorStatus;
+        }
+
+        for (cmsghdr* cm = CMSG_FIRSTHDR(&msg); cm; cm = CMSG_NXTHDR(&msg, cm))
+        {
+            if (cm->cmsg_level == SOL_SOCKET && cm->cmsg_type == SCM_RIGHTS)
+            {
+                memcpy(&dest, CMSG_DATA(cm), sizeof(int));
+                return OkStatus;
+            }
+        }
+        return ErrorStatus;
+#endif
+    }
+
+    void Net::close(const PlatformSocket& sock)
+    {
+        if (backend().close(sock) != 0)
+            Error::record(OpClose);
+    }
+
     Status Net::connect(
         const PlatformSocket& sock,
         const String&         ipv4,
@@ -70,7 +251,12 @@ namespace Rt2::Sockets
         inp.sin_family         = AF_INET;
         inp.sin_port           = Utils::hostToNetworkShort(port);
         inp.sin_addr.s_addr    = Utils::asciiToNetworkIpV4(ipv4);
-        return (Status)::connect(sock, (const sockaddr*)&inp, sizeof(sockaddr));
+        if (::connect(sock, (const sockaddr*)&inp, sizeof(sockaddr)) != 0)
+        {
+            Error::record(OpConnect);
+            return ErrorStatus;
+        }
+        return OkStatus;
     }
 
     PlatformSocket Net::connect(const Host& host, const uint16_t port)
@@ -82,7 +268,8 @@ namespace Rt2::Sockets
             {
                 if (const Status st = connect(sock, host.address, port); st != OkStatus)
                 {
-                    Error::log(std::cout);
+                    // the connect failure stays in lastError; close
+                    // does not overwrite it on success
                     close(sock);
                     return InvalidSocket;
                 }
@@ -99,36 +286,120 @@ namespace Rt2::Sockets
         const PlatformSocket& sock,
         SocketInputAddress&   addr)
     {
-        return (Status)::bind(sock, (sockaddr*)&addr, sizeof(sockaddr));
+        if (::bind(sock, (sockaddr*)&addr, sizeof(sockaddr)) != 0)
+        {
+            Error::record(OpBind);
+            return ErrorStatus;
+        }
+        return OkStatus;
     }
 
     Status Net::listen(
         const PlatformSocket& sock,
         const int32_t         backlog)
     {
-        return (Status)::listen(sock, backlog);
+        if (::listen(sock, backlog) != 0)
+        {
+            Error::record(OpListen);
+            return ErrorStatus;
+        }
+        return OkStatus;
     }
 
-    PlatformSocket Net::accept(
-        const PlatformSocket& sock)
+#if RT_PLATFORM != RT_PLATFORM_WINDOWS
+    namespace
     {
-        SocketInputAddress unused = {};
+        bool localAddress(sockaddr_un& dest, const String& path)
+        {
+            dest            = {};
+            dest.sun_family = AF_UNIX;
+            if (path.empty() || path.size() >= sizeof dest.sun_path)
+                return false;
+            memcpy(dest.sun_path, path.data(), path.size());
+            return true;
+        }
+    }  // namespace
+#endif
+
+    Status Net::bindLocal(
+        const PlatformSocket& sock,
+        const String&         path)
+    {
+#if RT_PLATFORM == RT_PLATFORM_WINDOWS
+        (void)sock;
+        (void)path;
+        return ErrorStatus;
+#else
+        sockaddr_un addr;
+        RT_GUARD_CHECK_RET(localAddress(addr, path), ErrorStatus)
+
+        if (::bind(sock, (sockaddr*)&addr, sizeof addr) != 0)
+        {
+            Error::record(OpBind);
+            return ErrorStatus;
+        }
+        return OkStatus;
+#endif
+    }
 
-        int sz = sizeof(SocketInputAddress);
+    Status Net::connectLocal(
+        const PlatformSocket& sock,
+        const String&         path)
+    {
 #if RT_PLATFORM == RT_PLATFORM_WINDOWS
-        return ::accept(sock, (sockaddr*)&unused, &sz);
+        (void)sock;
+        (void)path;
+        return ErrorStatus;
 #else
-        return ::accept(sock, (sockaddr*)&unused, (socklen_t*)&sz);
+        sockaddr_un addr;
+        RT_GUARD_CHECK_RET(localAddress(addr, path), ErrorStatus)
+
+        if (::connect(sock, (sockaddr*)&addr, sizeof addr) != 0)
+        {
+            Error::record(OpConnect);
+            return ErrorStatus;
+        }
+        return OkStatus;
 #endif
     }
 
+    namespace
+    {
+        PlatformSocket acceptCompleted(const PlatformSocket client, const Metrics::Tick tick)
+        {
+            if (client == InvalidSocket && !Net::Utils::wouldBlock())
+                Net::Error::record(OpAccept);
+            else if (client != InvalidSocket)
+                suppressSigPipe(client);
+
+            if (tick != 0)
+            {
+                if (client != InvalidSocket)
+                    Metrics::count(CounterAccepts);
+                else if (!Net::Utils::wouldBlock())
+                    Metrics::count(CounterErrors);
+                Metrics::record(HistogramAccept, tick);
+            }
+            return client;
+        }
+    }  // namespace
+
+    PlatformSocket Net::accept(
+        const PlatformSocket& sock)
+    {
+        SocketInputAddress unused = {};
+        return accept(sock, unused);
+    }
+
     PlatformSocket Net::accept(
         const PlatformSocket& sock,
         SocketInputAddress&   dest)
     {
+        const Metrics::Tick tick = Metrics::start();
+
         dest         = {};
         socklen_t sz = sizeof(SocketInputAddress);
-        return ::accept(sock, (sockaddr*)&dest, &sz);
+        return acceptCompleted(::accept(sock, (sockaddr*)&dest, &sz), tick);
     }
 
     PlatformSocket Net::accept(
@@ -138,31 +409,72 @@ namespace Rt2::Sockets
         return accept(sock, result.input());
     }
 
+    PlatformSocket Net::accept(
+        const PlatformSocket& sock,
+        SocketInputAddress&   dest,
+        const int             flags)
+    {
+        const Metrics::Tick tick = Metrics::start();
+
+        dest         = {};
+        socklen_t sz = sizeof(SocketInputAddress);
+
+#if defined(SOCK_NONBLOCK) && defined(SOCK_CLOEXEC)
+        // accept4 applies both flags atomically with the accept,
+        // which saves the fcntl round-trips per connection.
+        int acceptFlags = 0;
+        if (flags & AcceptNonBlocking)
+            acceptFlags |= SOCK_NONBLOCK;
+        if (flags & AcceptCloseOnExec)
+            acceptFlags |= SOCK_CLOEXEC;
+        return acceptCompleted(::accept4(sock, (sockaddr*)&dest, &sz, acceptFlags), tick);
+#else
+        const PlatformSocket client = ::accept(sock, (sockaddr*)&dest, &sz);
+        if (client != InvalidSocket)
+        {
+            if (flags & AcceptNonBlocking)
+                Utils::setBlocking(client, false);
+            if (flags & AcceptCloseOnExec)
+                Utils::setCloseOnExec(client, true);
+        }
+        return acceptCompleted(client, tick);
+#endif
+    }
+
+    PlatformSocket Net::accept(
+        const PlatformSocket& sock,
+        Connection&           result,
+        const int             flags)
+    {
+        return accept(sock, result.input(), flags);
+    }
+
     bool Net::poll(
         const PlatformSocket& sock,
         const int             timeout,
         const int             mode)
     {
         RT_GUARD_CHECK_RET(sock != InvalidSocket, false)
-        fd_set set = {};
-        FD_ZERO(&set);
-        FD_CLR(sock, &set);
-        FD_SET(sock, &set);
 
-        const int nfd = (int)(sock + 1);
+        // zero timeouts are readiness checks rather than waits,
+        // so they are left out of the poll statistics
+        const Metrics::Tick tick = timeout != 0 ? Metrics::start() : 0;
 
-        const timeval tv{0, (long)timeout * 1000};
+        const int rc = backend().poll(sock, timeout, mode);
+        if (rc < 0)
+            Error::record(OpPoll);
 
-        timeval* tp = nullptr;
-        if (timeout >= 0) tp = const_cast<timeval*>(&tv);
-
-        if (mode == ReadWrite)
-            return select(nfd, &set, &set, nullptr, tp) > 0;
-        if (mode == Read)
-            return select(nfd, &set, nullptr, nullptr, tp) > 0;
-        if (mode == Write)
-            return select(nfd, nullptr, &set, nullptr, tp) > 0;
-        return false;
+        if (tick != 0)
+        {
+            if (rc > 0)
+                Metrics::count(CounterPollWakeups);
+            else if (rc == 0)
+                Metrics::count(CounterTimeouts);
+            else
+                Metrics::count(CounterErrors);
+            Metrics::record(HistogramPoll, tick);
+        }
+        return rc > 0;
     }
 
     Status Net::readSocket(
@@ -175,20 +487,255 @@ namespace Rt2::Sockets
         RT_GUARD_CHECK_RET(dest, ErrorStatus)
         RT_GUARD_CHECK_RET(destSizeInBytes < MaxBufferSize, ErrorStatus)
 
+        if (receive(sock, dest, destSizeInBytes, bytesRead, timeout) == OkStatus)
+        {
+            dest[bytesRead] = 0;
+            if (bytesRead < destSizeInBytes)
+                return DoneStatus;
+            return OkStatus;
+        }
+        return DoneStatus;
+    }
+
+    namespace
+    {
+        // Set by markAccepted and consumed by the first receive after it.
+        struct FirstByte
+        {
+            PlatformSocket sock{InvalidSocket};
+            int64_t        accepted{0};
+        };
+
+        thread_local FirstByte Pending;
+    }  // namespace
+
+    void Net::markAccepted(const PlatformSocket& sock, const int64_t accepted)
+    {
+        Pending = {accepted != 0 ? sock : InvalidSocket, accepted};
+    }
+
+    Status Net::receive(
+        const PlatformSocket& sock,
+        char*                 dest,
+        const int             destSizeInBytes,
+        int&                  bytesRead,
+        const int             timeout)
+    {
+        RT_GUARD_CHECK_RET(dest, ErrorStatus)
+        RT_GUARD_CHECK_RET(destSizeInBytes < MaxBufferSize, ErrorStatus)
+
+        if (Pending.accepted != 0 && Pending.sock == sock)
+        {
+            RecvTimestamp stamp;
+            return receive(sock, dest, destSizeInBytes, bytesRead, stamp, timeout);
+        }
+
         bytesRead = 0;
-        if (poll(sock, timeout, Read))
+        if (!poll(sock, timeout, Read))
+            return TimeoutStatus;
+
+        const Metrics::Tick tick = Metrics::start();
+
+        const int64_t rl = backend().receive(sock, dest, (size_t)destSizeInBytes);
+
+        const bool blocked = rl < 0 && Utils::wouldBlock();
+        if (rl < 0 && !blocked)
+            Error::record(OpRead);
+        if (tick != 0)
         {
-            if (const int rl = recv(sock, dest, destSizeInBytes, 0);
-                rl > 0 && rl <= destSizeInBytes)
+            if (rl > 0)
             {
-                bytesRead = rl;
-                dest[rl]  = 0;
-                if (rl < destSizeInBytes)
-                    return DoneStatus;
-                return OkStatus;
+                Metrics::count(CounterReads);
+                Metrics::count(CounterBytesIn, (uint64_t)rl);
             }
+            else if (rl < 0 && !blocked)
+                Metrics::count(CounterErrors);
+            Metrics::record(HistogramRead, tick);
         }
-        return DoneStatus;
+
+        if (rl > 0)
+        {
+            bytesRead = (int)rl;
+            return OkStatus;
+        }
+
+        // zero is an orderly shutdown by the peer, which is the end of
+        // the stream rather than a lack of data
+        if (rl == 0)
+            return ClosedStatus;
+        return blocked ? TimeoutStatus : ErrorStatus;
+    }
+
+    Status Net::receive(
+        const PlatformSocket& sock,
+        char*                 dest,
+        const int             destSizeInBytes,
+        int&                  bytesRead,
+        RecvTimestamp&        stamp,
+        const int             timeout)
+    {
+        RT_GUARD_CHECK_RET(dest, ErrorStatus)
+        RT_GUARD_CHECK_RET(destSizeInBytes < MaxBufferSize, ErrorStatus)
+
+        bytesRead = 0;
+        stamp     = {};
+        if (!poll(sock, timeout, Read))
+            return TimeoutStatus;
+
+        const Metrics::Tick tick = Metrics::start();
+
+        const int64_t rl      = backend().receiveStamped(sock, dest, (size_t)destSizeInBytes, false, stamp);
+        const bool    blocked = rl < 0 && Utils::wouldBlock();
+        if (rl < 0 && !blocked)
+            Error::record(OpRead);
+        if (tick != 0)
+        {
+            if (rl > 0)
+            {
+                Metrics::count(CounterReads);
+                Metrics::count(CounterBytesIn, (uint64_t)rl);
+                if (stamp.valid() && !stamp.hardware)
+                    Metrics::observe(HistogramKernelQueue, stamp.age());
+            }
+            else if (rl < 0 && !blocked)
+                Metrics::count(CounterErrors);
+            Metrics::record(HistogramRead, tick);
+        }
+
+        if (rl > 0 && Pending.accepted != 0 && Pending.sock == sock)
+        {
+            // hardware stamps use the card's clock, not accept's
+            if (stamp.valid() && !stamp.hardware)
+            {
+                Metrics::observe(HistogramAcceptToFirstByte, stamp.nanoseconds - Pending.accepted);
+                Metrics::observe(HistogramFirstByteToHandler, stamp.age());
+            }
+            Pending = {};
+        }
+
+        if (rl > 0)
+        {
+            bytesRead = (int)rl;
+            return OkStatus;
+        }
+        if (rl == 0)
+            return ClosedStatus;
+        return blocked ? TimeoutStatus : ErrorStatus;
+    }
+
+    Status Net::peekTimestamp(
+        const PlatformSocket& sock,
+        RecvTimestamp&        stamp,
+        const int             timeout)
+    {
+        stamp = {};
+        if (!poll(sock, timeout, Read))
+            return TimeoutStatus;
+
+        char          first = 0;
+        const int64_t rl    = backend().receiveStamped(sock, &first, 1, true, stamp);
+        if (rl > 0)
+            return OkStatus;
+        if (rl == 0)
+            return ClosedStatus;
+        if (Utils::wouldBlock())
+            return TimeoutStatus;
+
+        Error::record(OpRead);
+        return ErrorStatus;
+    }
+
+    Status Net::receiveNow(
+        const PlatformSocket& sock,
+        char*                 dest,
+        const int             destSizeInBytes,
+        int&                  bytesRead)
+    {
+        RT_GUARD_CHECK_RET(dest, ErrorStatus)
+        RT_GUARD_CHECK_RET(destSizeInBytes < MaxBufferSize, ErrorStatus)
+
+        bytesRead = 0;
+
+        // callers spin on this, so empty attempts are not counted
+        const int64_t rl      = backend().receiveNow(sock, dest, (size_t)destSizeInBytes);
+        const bool    blocked = rl < 0 && Utils::wouldBlock();
+        if (rl > 0)
+        {
+            Metrics::count(CounterReads);
+            Metrics::count(CounterBytesIn, (uint64_t)rl);
+            bytesRead = (int)rl;
+            return OkStatus;
+        }
+        if (rl == 0)
+            return ClosedStatus;
+        if (blocked)
+            return TimeoutStatus;
+
+        Error::record(OpRead);
+        Metrics::count(CounterErrors);
+        return ErrorStatus;
+    }
+
+    Status Net::readVector(
+        const PlatformSocket& sock,
+        IoVector*             vectors,
+        const int             count,
+        int&                  bytesRead,
+        const int             timeout)
+    {
+        RT_GUARD_CHECK_RET(vectors && count > 0, ErrorStatus)
+
+        if (Pending.accepted != 0 && Pending.sock == sock)
+        {
+            // the stamped first read fills the first buffer only; a
+            // short read is allowed, and the next one takes the rest
+            for (int i = 0; i < count; ++i)
+            {
+                const size_t size = Utils::vectorSize(vectors[i]);
+                if (size == 0)
+                    continue;
+
+                RecvTimestamp stamp;
+                return receive(sock,
+                               Utils::vectorBase(vectors[i]),
+                               (int)std::min<size_t>(size, MaxBufferSize - 1),
+                               bytesRead,
+                               stamp,
+                               timeout);
+            }
+        }
+
+        bytesRead = 0;
+        if (!poll(sock, timeout, Read))
+            return TimeoutStatus;
+
+        const Metrics::Tick tick = Metrics::start();
+
+        const int64_t rl = backend().receiveVector(sock, vectors, count);
+
+        const bool blocked = rl < 0 && Utils::wouldBlock();
+        if (rl < 0 && !blocked)
+            Error::record(OpRead);
+        if (tick != 0)
+        {
+            if (rl > 0)
+            {
+                Metrics::count(CounterReads);
+                Metrics::count(CounterBytesIn, (uint64_t)rl);
+            }
+            else if (rl < 0 && !blocked)
+                Metrics::count(CounterErrors);
+            Metrics::record(HistogramRead, tick);
+        }
+
+        if (rl > 0)
+        {
+            bytesRead = (int)rl;
+            return OkStatus;
+        }
+        if (rl == 0)
+            return ClosedStatus;
+        return blocked ? TimeoutStatus : ErrorStatus;
     }
 
     int Net::writeSocket(
@@ -200,10 +747,243 @@ namespace Rt2::Sockets
         RT_GUARD_CHECK_RET(ptr, -1)
         RT_GUARD_CHECK_RET(sizeInBytes < MaxBufferSize, -1)
 
-        int rc = -1;
-        if (poll(sock, timeout, Write))
-            rc = send(sock, (const char*)ptr, (int)sizeInBytes, 0);
-        return rc;
+        const Trace::Tick traced = Trace::start();
+
+        // Accepted sockets are non-blocking, so a large write
+        // may need several sends to go out completely.
+        const char* src  = (const char*)ptr;
+        size_t      sent = 0;
+        while (sent < sizeInBytes)
+        {
+            if (!poll(sock, timeout, Write))
+                break;
+
+            const Metrics::Tick tick = Metrics::start();
+
+            const int64_t rc      = backend().send(sock, src + sent, sizeInBytes - sent);
+            const bool    blocked = rc < 0 && Utils::wouldBlock();
+            if (rc < 0 && !blocked)
+                Error::record(OpWrite);
+            if (tick != 0)
+            {
+                if (rc >= 0)
+                {
+                    Metrics::count(CounterWrites);
+                    Metrics::count(CounterBytesOut, (uint64_t)rc);
+                    if ((size_t)rc < sizeInBytes - sent)
+                        Metrics::count(CounterShortWrites);
+                }
+                else if (!blocked)
+                    Metrics::count(CounterErrors);
+                Metrics::record(HistogramWrite, tick);
+            }
+
+            if (rc < 0)
+            {
+                if (blocked)
+                    continue;
+                break;
+            }
+            sent += (size_t)rc;
+        }
+
+        Trace::record(TraceWrite, traced, (int64_t)sent);
+        return sent > 0 ? (int)sent : -1;
+    }
+
+    Status Net::sendVector(
+        const PlatformSocket& sock,
+        IoVector*             vectors,
+        const int             count,
+        int&                  bytesSent)
+    {
+        RT_GUARD_CHECK_RET(vectors && count > 0, ErrorStatus)
+
+        bytesSent = 0;
+
+        size_t total = 0;
+        for (int i = 0; i < count; ++i)
+            total += Utils::vectorSize(vectors[i]);
+
+        const Metrics::Tick tick = Metrics::start();
+
+        const int64_t rc = backend().sendVector(sock, vectors, count);
+        const bool blocked = rc < 0 && Utils::wouldBlock();
+        if (rc < 0 && !blocked)
+            Error::record(OpWrite);
+        if (tick != 0)
+        {
+            if (rc >= 0)
+            {
+                Metrics::count(CounterWrites);
+                Metrics::count(CounterBytesOut, (uint64_t)rc);
+                if ((size_t)rc < total)
+                    Metrics::count(CounterShortWrites);
+            }
+            else if (!blocked)
+                Metrics::count(CounterErrors);
+            Metrics::record(HistogramWrite, tick);
+        }
+
+        if (rc >= 0)
+        {
+            bytesSent = (int)rc;
+            return OkStatus;
+        }
+        return blocked ? TimeoutStatus : ErrorStatus;
+    }
+
+    int Net::writeVector(
+        const PlatformSocket& sock,
+        IoVector*             vectors,
+        int                   count,
+        const int             timeout)
+    {
+        RT_GUARD_CHECK_RET(vectors && count > 0, -1)
+
+        size_t total = 0;
+        for (int i = 0; i < count; ++i)
+            total += Utils::vectorSize(vectors[i]);
+        RT_GUARD_CHECK_RET(total < MaxBufferSize, -1)
+
+        const Trace::Tick traced = Trace::start();
+
+        size_t sent = 0;
+        while (sent < total)
+        {
+            if (!poll(sock, timeout, Write))
+                break;
+
+            int          rc = 0;
+            const Status st = sendVector(sock, vectors, count, rc);
+            if (st == TimeoutStatus)
+                continue;
+            if (st != OkStatus)
+                break;
+            sent += (size_t)rc;
+
+            Utils::advanceVector(vectors, count, (size_t)rc);
+        }
+
+        Trace::record(TraceWrite, traced, (int64_t)sent);
+        return sent > 0 ? (int)sent : -1;
+    }
+
+    Status Net::sendZeroCopy(
+        const PlatformSocket& sock,
+        const void*           ptr,
+        const size_t          sizeInBytes,
+        int&                  bytesSent)
+    {
+        RT_GUARD_CHECK_RET(ptr && sizeInBytes > 0, ErrorStatus)
+
+        bytesSent = 0;
+#ifdef SOCKETS_HAS_ZEROCOPY
+        const Metrics::Tick tick = Metrics::start();
+
+        const size_t len = std::min<size_t>(sizeInBytes, MaxBufferSize);
+
+        ssize_t rc;
+        do
+        {
+            rc = send(sock, ptr, len, MSG_ZEROCOPY | MSG_DONTWAIT | MSG_NOSIGNAL);
+        } while (rc < 0 && errno == EINTR);
+
+        // ENOBUFS is the pinned page budget running out; it clears as
+        // completions are read, so it is treated like a full buffer
+        const bool blocked = rc < 0 && (Utils::wouldBlock() || errno == ENOBUFS);
+        if (rc < 0 && !blocked)
+            Error::record(OpWrite);
+        if (tick != 0)
+        {
+            if (rc >= 0)
+            {
+                Metrics::count(CounterWrites);
+                Metrics::count(CounterBytesOut, (uint64_t)rc);
+                if ((size_t)rc < sizeInBytes)
+                    Metrics::count(CounterShortWrites);
+            }
+            else if (!blocked)
+                Metrics::count(CounterErrors);
+            Metrics::record(HistogramWrite, tick);
+        }
+
+        if (rc >= 0)
+        {
+            bytesSent = (int)rc;
+            return OkStatus;
+        }
+        return blocked ? TimeoutStatus : ErrorStatus;
+#else
+        (void)sock;
+        return ErrorStatus;
+#endif
+    }
+
+    Status Net::readCompletion(
+        const PlatformSocket& sock,
+        ZeroCopyCompletion&   dest,
+        const int             timeout)
+    {
+#ifdef SOCKETS_HAS_ZEROCOPY
+        RT_GUARD_CHECK_RET(sock != InvalidSocket, ErrorStatus)
+
+        // the error queue only ever signals POLLERR, which select
+        // does not report, so this waits on poll directly
+        pollfd pfd{sock, 0, 0};
+        int    rc;
+        do
+        {
+            rc = ::poll(&pfd, 1, timeout);
+        } while (rc < 0 && errno == EINTR);
+        if (rc < 0)
+        {
+            Error::record(OpPoll);
+            return ErrorStatus;
+        }
+        if (rc == 0)
+            return TimeoutStatus;
+
+        char   control[CMSG_SPACE(sizeof(sock_extended_err))];
+        msghdr msg{};
+        msg.msg_control    = control;
+        msg.msg_controllen = sizeof control;
+
+        if (recvmsg(sock, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) < 0)
+        {
+            if (Utils::wouldBlock())
+                return TimeoutStatus;
+            Error::record(OpRead);
+            return ErrorStatus;
+        }
+
+        for (cmsghdr* cm = CMSG_FIRSTHDR(&msg); cm; cm = CMSG_NXTHDR(&msg, cm))
+        {
+            const auto* err = (const sock_extended_err*)CMSG_DATA(cm);
+            if (err->ee_errno != 0 || err->ee_origin != SO_EE_ORIGIN_ZEROCOPY)
+                continue;
+
+            dest.first  = err->ee_info;
+            dest.last   = err->ee_data;
+            dest.copied = (err->ee_code & SO_EE_CODE_ZEROCOPY_COPIED) != 0;
+            return OkStatus;
+        }
+        return ErrorStatus;
+#else
+        (void)sock;
+        (void)dest;
+        (void)timeout;
+        return ErrorStatus;
+#endif
+    }
+
+    bool Net::isZeroCopySupported()
+    {
+#ifdef SOCKETS_HAS_ZEROCOPY
+        return true;
+#else
+        return false;
+#endif
     }
 
     Status Net::setOption(
@@ -220,7 +1000,18 @@ namespace Rt2::Sockets
         case KeepAlive:
         case DoNotRoute:
         case Broadcast:
-            st = setOption(sock, option, &setVal, sizeof(int));
+            st = setOption(sock, SOL_SOCKET, option, &setVal, sizeof(int));
+            break;
+        case ZeroCopy:
+            if (!isZeroCopySupported())
+                return ErrorStatus;
+            st = setOption(sock, SOL_SOCKET, option, &setVal, sizeof(int));
+            break;
+        case BusyPoll:
+        case PreferBusyPoll:
+        case ReceiveTimestamp:
+        case Timestamping:
+            st = setOption(sock, option, setVal);
             break;
         case Blocking:
             Utils::setBlocking(sock, val);
@@ -234,7 +1025,7 @@ namespace Rt2::Sockets
         }
 
         if (st != OkStatus)
-            Error::log();
+            Error::record(OpSetOption);
         return st;
     }
 
@@ -266,26 +1057,38 @@ namespace Rt2::Sockets
         {
             const int sv = val != 0 ? 1 : 0;
 
-            st = setOption(sock, option, &sv, sizeof(int));
+            st = setOption(sock, SOL_SOCKET, option, &sv, sizeof(int));
             break;
         }
+        case ZeroCopy:
+            st = setOption(sock, option, val != 0);
+            break;
+        case BusyPoll:
+        case PreferBusyPoll:
+        case ReceiveTimestamp:
+        case Timestamping:
+            // placeholders are negative where the headers lack them
+            if (option < 0)
+                return ErrorStatus;
+            st = setOption(sock, SOL_SOCKET, option, &val, sizeof(int));
+            break;
         case Blocking:
             Utils::setBlocking(sock, val != 0);
             break;
         case SendBufferSize:
         case ReceiveBufferSize:
-            st = setOption(sock, option, &val, sizeof(int));
+            st = setOption(sock, SOL_SOCKET, option, &val, sizeof(int));
             break;
         case SendTimeout:
         case ReceiveTimeout:
         {
 #if RT_PLATFORM == RT_PLATFORM_WINDOWS
-            st = setOption(sock, option, &val, sizeof(int));
+            st = setOption(sock, SOL_SOCKET, option, &val, sizeof(int));
 #else
             // clang-format off
             timeval tv = {};
             splitMilliseconds(val, tv.tv_sec, tv.tv_usec);
-            st = setOption(sock, option, &tv, sizeof(timeval));
+            st = setOption(sock, SOL_SOCKET, option, &tv, sizeof(timeval));
             // clang-format on
 #endif
 
@@ -296,7 +1099,7 @@ namespace Rt2::Sockets
         }
 
         if (st != OkStatus)
-            Error::log();
+            Error::record(OpSetOption);
         return st;
     }
 
@@ -312,7 +1115,21 @@ namespace Rt2::Sockets
         case KeepAlive:
         case DoNotRoute:
         case Broadcast:
-            st = getOption(sock, option, &get, sz);
+            st = getOption(sock, SOL_SOCKET, option, &get, sz);
+            break;
+        case ZeroCopy:
+            if (isZeroCopySupported())
+                st = getOption(sock, SOL_SOCKET, option, &get, sz);
+            break;
+        case AcceptConnection:
+            st = getOption(sock, SOL_SOCKET, option, &get, sz);
+            break;
+        case BusyPoll:
+        case PreferBusyPoll:
+        case ReceiveTimestamp:
+        case Timestamping:
+            if (option >= 0)
+                st = getOption(sock, SOL_SOCKET, option, &get, sz);
             break;
         case Blocking:
         case SendBufferSize:
@@ -325,7 +1142,7 @@ namespace Rt2::Sockets
 
         if (st != OkStatus)
         {
-            Error::log();
+            Error::record(OpGetOption);
         }
         return get != 0;
     }
@@ -345,18 +1162,25 @@ namespace Rt2::Sockets
         case Blocking:
         case SendBufferSize:
         case ReceiveBufferSize:
-            st = getOption(sock, option, &get, sz);
+            st = getOption(sock, SOL_SOCKET, option, &get, sz);
+            break;
+        case BusyPoll:
+        case PreferBusyPoll:
+        case ReceiveTimestamp:
+        case Timestamping:
+            if (option >= 0)
+                st = getOption(sock, SOL_SOCKET, option, &get, sz);
             break;
         case ReceiveTimeout:
         case SendTimeout:
         {
 #if RT_PLATFORM == RT_PLATFORM_WINDOWS
-            st = getOption(sock, option, &get, sz);
+            st = getOption(sock, SOL_SOCKET, option, &get, sz);
 #else
             // clang-format off
             timeval tv = {};
             sz = sizeof(timeval);
-            st = getOption(sock, option, &tv, sz);
+            st = getOption(sock, SOL_SOCKET, option, &tv, sz);
             joinMilliseconds(get, tv.tv_sec, tv.tv_usec);
             // clang-format on
 #endif
@@ -367,28 +1191,64 @@ namespace Rt2::Sockets
         }
 
         if (st != OkStatus)
-            Error::log();
+            Error::record(OpGetOption);
+        return get;
+    }
+
+    Status Net::setOption(
+        const PlatformSocket& sock,
+        const TcpOption       option,
+        const int             val)
+    {
+        if (!isSupported(option))
+            return ErrorStatus;
+
+        const Status st = setOption(sock, IPPROTO_TCP, option, &val, sizeof(int));
+        if (st != OkStatus)
+            Error::record(OpSetOption);
+        return st;
+    }
+
+    bool Net::optionBool(const PlatformSocket& sock, const TcpOption option)
+    {
+        return optionInt(sock, option) != 0;
+    }
+
+    int Net::optionInt(const PlatformSocket& sock, const TcpOption option)
+    {
+        RT_GUARD_RET(isSupported(option), 0)
+
+        int get = 0;
+        int sz  = sizeof(int);
+        if (getOption(sock, IPPROTO_TCP, option, &get, sz) != OkStatus)
+            Error::record(OpGetOption);
         return get;
     }
 
+    bool Net::isSupported(const TcpOption option)
+    {
+        return (int)option >= 0;
+    }
+
     Status Net::setOption(
         const PlatformSocket& sock,
-        SocketOption          option,
+        const int             level,
+        const int             option,
         const void*           value,
-        size_t                valueSize)
+        const size_t          valueSize)
     {
 #if RT_PLATFORM == RT_PLATFORM_WINDOWS
         return (Status)setsockopt(
             sock,
-            SOL_SOCKET,
-            (int)option,
+            level,
+            option,
             (const char*)value,
             (socklen_t)valueSize);
 #else
         return (Status)setsockopt(
             sock,
-            SOL_SOCKET,
-            (int)option,
+            level,
+            option,
             (const void*)value,
             (socklen_t)valueSize);
 
@@ -397,18 +1257,19 @@ namespace Rt2::Sockets
 
     Status Net::getOption(
         const PlatformSocket& sock,
-        const SocketOption    option,
+        const int             level,
+        const int             option,
         void*                 dest,
         int&                  size)
     {
 #if RT_PLATFORM == RT_PLATFORM_WINDOWS
-        return (Status)getsockopt(sock, SOL_SOCKET, (int)option, (char*)dest, &size);
+        return (Status)getsockopt(sock, level, option, (char*)dest, &size);
 #else
-        socklen_t wrap;
-        auto      rc = (Status)getsockopt(
+        socklen_t wrap = (socklen_t)size;
+        auto      rc   = (Status)getsockopt(
             sock,
-            SOL_SOCKET,
-            (int)option,
+            level,
+            option,
             dest,
             &wrap);
         size = (int)wrap;
@@ -425,7 +1286,7 @@ namespace Rt2::Sockets
 #if RT_PLATFORM == RT_PLATFORM_WINDOWS
             u_long block = val ? 0 : 1;
             if (ioctlsocket(sock, FIONBIO, &block) != 0)
-                Error::log();
+                Error::record(OpSetOption);
 #else
             int cfl = fcntl(sock, F_GETFL);
             if (!val)
@@ -437,6 +1298,96 @@ namespace Rt2::Sockets
         }
     }
 
+    void Net::Utils::makeVector(IoVector& dest, const void* base, const size_t size)
+    {
+#if RT_PLATFORM == RT_PLATFORM_WINDOWS
+        dest.buf = (CHAR*)base;
+        dest.len = (ULONG)size;
+#else
+        dest.iov_base = const_cast<void*>(base);
+        dest.iov_len  = size;
+#endif
+    }
+
+    char* Net::Utils::vectorBase(const IoVector& vec)
+    {
+#if RT_PLATFORM == RT_PLATFORM_WINDOWS
+        return (char*)vec.buf;
+#else
+        return (char*)vec.iov_base;
+#endif
+    }
+
+    void Net::Utils::advanceVector(IoVector*& vectors, int& count, size_t bytes)
+    {
+        while (count > 0 && bytes >= vectorSize(*vectors))
+        {
+            bytes -= vectorSize(*vectors);
+            ++vectors;
+            --count;
+        }
+        if (count > 0 && bytes > 0)
+            makeVector(*vectors, vectorBase(*vectors) + bytes, vectorSize(*vectors) - bytes);
+    }
+
+    size_t Net::Utils::vectorSize(const IoVector& vec)
+    {
+#if RT_PLATFORM == RT_PLATFORM_WINDOWS
+        return (size_t)vec.len;
+#else
+        return vec.iov_len;
+#endif
+    }
+
+    void Net::Utils::setCloseOnExec(
+        PlatformSocket sock,
+        const bool     val)
+    {
+#if RT_PLATFORM == RT_PLATFORM_WINDOWS
+        if (sock != InvalidSocket)
+        {
+            if (SetHandleInformation((HANDLE)sock, HANDLE_FLAG_INHERIT, val ? 0 : HANDLE_FLAG_INHERIT) == 0)
+                Error::record(OpSetOption);
+        }
+#else
+        if (sock != InvalidSocket)
+        {
+            int cfl = fcntl(sock, F_GETFD);
+            if (val)
+                cfl |= FD_CLOEXEC;
+            else
+                cfl &= ~FD_CLOEXEC;
+            fcntl(sock, F_SETFD, cfl);
+        }
+#endif
+    }
+
+    bool Net::Utils::wouldBlock()
+    {
+#if RT_PLATFORM == RT_PLATFORM_WINDOWS
+        return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+        return errno == EAGAIN || errno == EWOULDBLOCK;
+#endif
+    }
+
+    int32_t Net::Utils::maxListenBacklog()
+    {
+        int32_t backlog = SOMAXCONN;
+#if RT_PLATFORM != RT_PLATFORM_WINDOWS
+        // The kernel silently truncates anything above somaxconn,
+        // so read the real limit when it is available.
+        if (FILE* fp = fopen("/proc/sys/net/core/somaxconn", "r"))
+        {
+            int32_t value = 0;
+            if (fscanf(fp, "%d", &value) == 1 && value > 0)
+                backlog = value;
+            fclose(fp);
+        }
+#endif
+        return backlog;
+    }
+
     void Net::Utils::constructInputAddress(
         SocketInputAddress& dest,
         const AddressFamily addressFamily,
@@ -454,61 +1405,24 @@ namespace Rt2::Sockets
         dest.sin_addr.s_addr = asciiToNetworkIpV4(address);
     }
 
-    bool isOnlyDecimal(const String& inp)
-    {
-        if (inp.size() > 3)
-            return false;
-
-        for (const char ch : inp)
-        {
-            if (!isDecimal(ch))
-                return false;
-        }
-
-        const int valCheck = Char::toInt32(inp);
-        return valCheck <= 255;
-    }
-
     bool Net::isValidIpv4(const String& address)
     {
-        if (address.empty())
-            return false;
-
-        StringArray sa;
-        Su::splitRejectEmpty(sa, address, '.');
-
-        if (sa.size() != 4)
-            return false;
-
-        bool stat = isOnlyDecimal(sa[0]);
-        stat      = stat && isOnlyDecimal(sa[1]);
-        stat      = stat && isOnlyDecimal(sa[2]);
-        stat      = stat && isOnlyDecimal(sa[3]);
-        return stat;
+        return Ipv4::isValid(address);
     }
 
     uint32_t Net::Utils::asciiToNetworkIpV4(const String& inp)
     {
         if (inp.empty()) return 0;
 
-        if (!isValidIpv4(inp))
+        Ipv4 addr;
+        if (!Ipv4::parse(inp, addr))
             throw Exception("Invalid IpV4 address: ", inp);
-
-        char buf[33]{};
-        inet_pton(AF_INET, inp.c_str(), buf);
-        return *(uint32_t*)&buf[0];
+        return addr.network();
     }
 
     String Net::Utils::networkToAsciiIpV4(const uint32_t& inp)
     {
-        in_addr addr4{};
-        memset(&addr4, 0, sizeof(in_addr));
-
-        addr4.s_addr = inp;
-        char buf[32];
-
-        inet_ntop(AF_INET, &addr4, buf, 32);
-        return {buf};
+        return Ipv4::fromNetwork(inp).toString();
     }
 
     uint32_t Net::Utils::networkToHostLong(const uint32_t& inp)
@@ -696,6 +1610,27 @@ namespace Rt2::Sockets
         return false;
     }
 
+    AddressFamily Net::Utils::addressFamily(const PlatformSocket sock)
+    {
+        sockaddr_storage addr{};
+        socklen_t        len = sizeof addr;
+        if (getsockname(sock, (sockaddr*)&addr, &len) != 0)
+        {
+            Error::record(OpGetOption);
+            return AddressFamilyUnknown;
+        }
+
+        switch (addr.ss_family)
+        {
+        case AF_INET:
+            return AddressFamilyINet;
+        case AF_UNIX:
+            return AddressFamilyUnix;
+        default:
+            return AddressFamilyUnknown;
+        }
+    }
+
     String Net::Utils::toString(const AddressFamily& addressFamily)
     {
         switch (addressFamily)
@@ -730,46 +1665,198 @@ namespace Rt2::Sockets
 
     String Net::Utils::toString(const SocketType& socketType)
     {
-        switch (socketType)
+        switch (socketType)
+        {
+        case SocketDatagram:
+            return "Datagram";
+        case SocketStream:
+            return "Stream";
+        case SocketRaw:
+            return "Raw";
+        default:
+        case SocketUnknown:
+            return "Unknown";
+        }
+    }
+
+    void Net::ensureInitialized()
+    {
+#if RT_PLATFORM == RT_PLATFORM_WINDOWS
+        class PlatformSetup
+        {
+        public:
+            PlatformSetup()
+            {
+                WSADATA data = {};
+                // The current version of the Windows Sockets specification is version 2.2.
+                constexpr WORD versionRequested = MAKEWORD(2, 2);
+
+                // If successful, the WSAStartup function returns zero
+                if (const int status = WSAStartup(versionRequested, &data); status != 0)
+                    Error::record(OpStartup, status);
+            }
+
+            ~PlatformSetup()
+            {
+                // If successful, the WSACleanup function returns zero.
+                if (const int status = WSACleanup(); status != 0)
+                    Error::record(OpStartup);
+            }
+        };
+        static PlatformSetup inst;
+#endif
+    }
+
+    namespace
+    {
+        thread_local ErrorCode LastError;
+
+        struct SinkState
+        {
+            std::mutex            lock;
+            ErrorSink             sink;
+            std::atomic<bool>     active{false};
+            std::atomic<int>      rate{Default::ErrorLogRate};
+            std::atomic<int64_t>  window{0};
+            std::atomic<int>      count{0};
+            std::atomic<uint64_t> suppressed{0};
+        };
+
+        SinkState& sinkState()
+        {
+            static SinkState state;
+            return state;
+        }
+
+        int32_t systemError()
+        {
+#if RT_PLATFORM == RT_PLATFORM_WINDOWS
+            return WSAGetLastError();
+#else
+            return errno;
+#endif
+        }
+
+        void forward(const ErrorCode& err)
+        {
+            SinkState& state = sinkState();
+
+            // a fixed one second window; good enough to stop a flood
+            const int64_t now = std::chrono::duration_cast<std::chrono::seconds>(
+                                    std::chrono::steady_clock::now().time_since_epoch())
+                                    .count();
+
+            int64_t window = state.window.load(std::memory_order_relaxed);
+            if (window != now && state.window.compare_exchange_strong(window, now))
+                state.count.store(0, std::memory_order_relaxed);
+
+            const int rate = state.rate.load(std::memory_order_relaxed);
+            if (state.count.fetch_add(1, std::memory_order_relaxed) >= rate)
+            {
+                state.suppressed.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+
+            std::lock_guard guard(state.lock);
+            if (state.sink)
+                state.sink(err);
+        }
+    }  // namespace
+
+    ErrorCode Net::Error::record(const NetOperation op)
+    {
+        return record(op, systemError());
+    }
+
+    ErrorCode Net::Error::record(const NetOperation op, const int32_t code)
+    {
+        LastError = {code, op};
+        if (sinkState().active.load(std::memory_order_relaxed))
+            forward(LastError);
+        return LastError;
+    }
+
+    const ErrorCode& Net::Error::last()
+    {
+        return LastError;
+    }
+
+    const ErrorCode& Net::lastError()
+    {
+        return LastError;
+    }
+
+    void Net::Error::clear()
+    {
+        LastError = {};
+    }
+
+    void Net::Error::setSink(const ErrorSink& sink, const int perSecond)
+    {
+        SinkState& state = sinkState();
+
+        std::lock_guard guard(state.lock);
+        state.sink = sink;
+        state.rate.store(perSecond, std::memory_order_relaxed);
+        state.active.store(sink != nullptr, std::memory_order_relaxed);
+    }
+
+    uint64_t Net::Error::suppressed()
+    {
+        return sinkState().suppressed.load(std::memory_order_relaxed);
+    }
+
+    ErrorSink Net::Error::streamSink(OStream& out)
+    {
+        return [&out](const ErrorCode& err)
+        { log(out, err); };
+    }
+
+    const char* Net::Error::toString(const NetOperation op)
+    {
+        switch (op)
         {
-        case SocketDatagram:
-            return "Datagram";
-        case SocketStream:
-            return "Stream";
-        case SocketRaw:
-            return "Raw";
+        case OpStartup:
+            return "startup";
+        case OpCreate:
+            return "create";
+        case OpClose:
+            return "close";
+        case OpDuplicate:
+            return "duplicate";
+        case OpConnect:
+            return "connect";
+        case OpBind:
+            return "bind";
+        case OpListen:
+            return "listen";
+        case OpAccept:
+            return "accept";
+        case OpPoll:
+            return "poll";
+        case OpRead:
+            return "read";
+        case OpWrite:
+            return "write";
+        case OpSetOption:
+            return "set option";
+        case OpGetOption:
+            return "get option";
+        case OpNone:
+        case OpOperationCount:
         default:
-        case SocketUnknown:
-            return "Unknown";
+            return "none";
         }
     }
 
-    void Net::ensureInitialized()
+    void Net::Error::log(OStream& out, const ErrorCode& err)
     {
-#if RT_PLATFORM == RT_PLATFORM_WINDOWS
-        class PlatformSetup
-        {
-        public:
-            PlatformSetup()
-            {
-                WSADATA data = {};
-                // The current version of the Windows Sockets specification is version 2.2.
-                constexpr WORD versionRequested = MAKEWORD(2, 2);
-
-                // If successful, the WSAStartup function returns zero
-                if (const int status = WSAStartup(versionRequested, &data); status != 0)
-                    Error::log();
-            }
+        Ts::println(out, toString(err.operation), ": ", describe(err.code), " (", err.code, ')');
+    }
 
-            ~PlatformSetup()
-            {
-                // If successful, the WSACleanup function returns zero.
-                if (const int status = WSACleanup(); status != 0)
-                    Error::log();
-            }
-        };
-        static PlatformSetup inst;
-#endif
+    void Net::Error::log(OStream& out)
+    {
+        log(out, LastError);
     }
 
     void Net::Error::log()
@@ -787,684 +1874,461 @@ namespace Rt2::Sockets
     // Descriptions:
     // https://learn.microsoft.com/en-us/windows/win32/winsock/windows-sockets-error-codes-2
     // https://man7.org/linux/man-pages/man3/errno.3.html
-    void Net::Error::log(OStream& out)
+    const char* Net::Error::describe(const int32_t code)
     {
 #if RT_PLATFORM == RT_PLATFORM_WINDOWS
-        switch (WSAGetLastError())
+        switch (code)
         {
         case WSA_INVALID_HANDLE:
-            Ts::println(out, "Specified event object handle is invalid.");
-            break;
+            return "Specified event object handle is invalid.";
         case WSA_NOT_ENOUGH_MEMORY:
-            Ts::println(out, "Insufficient memory available.");
-            break;
+            return "Insufficient memory available.";
         case WSA_INVALID_PARAMETER:
-            Ts::println(out, "One or more parameters are invalid.");
-            break;
+            return "One or more parameters are invalid.";
         case WSA_OPERATION_ABORTED:
-            Ts::println(out, "Overlapped operation aborted.");
-            break;
+            return "Overlapped operation aborted.";
         case WSA_IO_INCOMPLETE:
-            Ts::println(out, "Overlapped I/O event object not in signaled state.");
-            break;
+            return "Overlapped I/O event object not in signaled state.";
         case WSA_IO_PENDING:
-            Ts::println(out, "Overlapped operations will complete later.");
-            break;
+            return "Overlapped operations will complete later.";
         case WSAEINTR:
-            Ts::println(out, "Interrupted function call.");
-            break;
+            return "Interrupted function call.";
         case WSAEBADF:
-            Ts::println(out, "File handle is not valid.");
-            break;
+            return "File handle is not valid.";
         case WSAEACCES:
-            Ts::println(out, "Permission denied.");
-            break;
+            return "Permission denied.";
         case WSAEFAULT:
-            Ts::println(out, "Bad address.");
-            break;
+            return "Bad address.";
         case WSAEINVAL:
-            Ts::println(out, "Invalid argument.");
-            break;
+            return "Invalid argument.";
         case WSAEMFILE:
-            Ts::println(out, "Too many open files.");
-            break;
+            return "Too many open files.";
         case WSAEWOULDBLOCK:
-            Ts::println(out, "Resource temporarily unavailable.");
-            break;
+            return "Resource temporarily unavailable.";
         case WSAEINPROGRESS:
-            Ts::println(out, "Operation now in progress.");
-            break;
+            return "Operation now in progress.";
         case WSAEALREADY:
-            Ts::println(out, "Operation already in progress.");
-            break;
+            return "Operation already in progress.";
         case WSAENOTSOCK:
-            Ts::println(out, "Socket operation on non-socket.");
-            break;
+            return "Socket operation on non-socket.";
         case WSAEDESTADDRREQ:
-            Ts::println(out, "Destination address required.");
-            break;
+            return "Destination address required.";
         case WSAEMSGSIZE:
-            Ts::println(out, "Message too long.");
-            break;
+            return "Message too long.";
         case WSAEPROTOTYPE:
-            Ts::println(out, "Protocol wrong type for socket.");
-            break;
+            return "Protocol wrong type for socket.";
         case WSAENOPROTOOPT:
-            Ts::println(out, "Bad protocol option.");
-            break;
+            return "Bad protocol option.";
         case WSAEPROTONOSUPPORT:
-            Ts::println(out, "Protocol not supported.");
-            break;
+            return "Protocol not supported.";
         case WSAESOCKTNOSUPPORT:
-            Ts::println(out, "Socket type not supported.");
-            break;
+            return "Socket type not supported.";
         case WSAEOPNOTSUPP:
-            Ts::println(out, "Operation not supported.");
-            break;
+            return "Operation not supported.";
         case WSAEPFNOSUPPORT:
-            Ts::println(out, "Protocol family not supported.");
-            break;
+            return "Protocol family not supported.";
         case WSAEAFNOSUPPORT:
-            Ts::println(out, "Address family not supported by protocol family.");
-            break;
+            return "Address family not supported by protocol family.";
         case WSAEADDRINUSE:
-            Ts::println(out, "Address already in use.");
-            break;
+            return "Address already in use.";
         case WSAEADDRNOTAVAIL:
-            Ts::println(out, "Cannot assign requested address.");
-            break;
+            return "Cannot assign requested address.";
         case WSAENETDOWN:
-            Ts::println(out, "Network is down.");
-            break;
+            return "Network is down.";
         case WSAENETUNREACH:
-            Ts::println(out, "Network is unreachable.");
-            break;
+            return "Network is unreachable.";
         case WSAENETRESET:
-            Ts::println(out, "Network dropped connection on reset.");
-            break;
+            return "Network dropped connection on reset.";
         case WSAECONNABORTED:
-            Ts::println(out, "Software caused connection abort.");
-            break;
+            return "Software caused connection abort.";
         case WSAECONNRESET:
-            Ts::println(out, "Connection reset by peer.");
-            break;
+            return "Connection reset by peer.";
         case WSAENOBUFS:
-            Ts::println(out, "No buffer space available.");
-            break;
+            return "No buffer space available.";
         case WSAEISCONN:
-            Ts::println(out, "Socket is already connected.");
-            break;
+            return "Socket is already connected.";
         case WSAENOTCONN:
-            Ts::println(out, "Socket is not connected.");
-            break;
+            return "Socket is not connected.";
         case WSAESHUTDOWN:
-            Ts::println(out, "Cannot send after socket shutdown.");
-            break;
+            return "Cannot send after socket shutdown.";
         case WSAETOOMANYREFS:
-            Ts::println(out, "Too many references.");
-            break;
+            return "Too many references.";
         case WSAETIMEDOUT:
-            Ts::println(out, "Connection timed out.");
-            break;
+            return "Connection timed out.";
         case WSAECONNREFUSED:
-            Ts::println(out, "Connection refused.");
-            break;
+            return "Connection refused.";
         case WSAELOOP:
-            Ts::println(out, "Cannot translate name.");
-            break;
+            return "Cannot translate name.";
         case WSAENAMETOOLONG:
-            Ts::println(out, "Name too long.");
-            break;
+            return "Name too long.";
         case WSAEHOSTDOWN:
-            Ts::println(out, "Host is down.");
-            break;
+            return "Host is down.";
         case WSAEHOSTUNREACH:
-            Ts::println(out, "No route to host.");
-            break;
+            return "No route to host.";
         case WSAENOTEMPTY:
-            Ts::println(out, "Directory not empty.");
-            break;
+            return "Directory not empty.";
         case WSAEPROCLIM:
-            Ts::println(out, "Too many processes.");
-            break;
+            return "Too many processes.";
         case WSAEUSERS:
-            Ts::println(out, "User quota exceeded.");
-            break;
+            return "User quota exceeded.";
         case WSAEDQUOT:
-            Ts::println(out, "Disk quota exceeded.");
-            break;
+            return "Disk quota exceeded.";
         case WSAESTALE:
-            Ts::println(out, "Stale file handle reference.");
-            break;
+            return "Stale file handle reference.";
         case WSAEREMOTE:
-            Ts::println(out, "Item is remote.");
-            break;
+            return "Item is remote.";
         case WSASYSNOTREADY:
-            Ts::println(out, "Network subsystem is unavailable.");
-            break;
+            return "Network subsystem is unavailable.";
         case WSAVERNOTSUPPORTED:
-            Ts::println(out, "Winsock.dll version out of range.");
-            break;
+            return "Winsock.dll version out of range.";
         case WSANOTINITIALISED:
-            Ts::println(out, "Successful WSAStartup not yet performed.");
-            break;
+            return "Successful WSAStartup not yet performed.";
         case WSAEDISCON:
-            Ts::println(out, "Graceful shutdown in progress.");
-            break;
+            return "Graceful shutdown in progress.";
         case WSAENOMORE:
-            Ts::println(out, "No more results.");
-            break;
+            return "No more results.";
         case WSAECANCELLED:
-            Ts::println(out, "Call has been canceled.");
-            break;
+            return "Call has been canceled.";
         case WSAEINVALIDPROCTABLE:
-            Ts::println(out, "Procedure call table is invalid.");
-            break;
+            return "Procedure call table is invalid.";
         case WSAEINVALIDPROVIDER:
-            Ts::println(out, "Service provider is invalid.");
-            break;
+            return "Service provider is invalid.";
         case WSAEPROVIDERFAILEDINIT:
-            Ts::println(out, "Service provider failed to initialize.");
-            break;
+            return "Service provider failed to initialize.";
         case WSASYSCALLFAILURE:
-            Ts::println(out, "System call failure.");
-            break;
+            return "System call failure.";
         case WSASERVICE_NOT_FOUND:
-            Ts::println(out, "Service not found.");
-            break;
+            return "Service not found.";
         case WSATYPE_NOT_FOUND:
-            Ts::println(out, "Class type not found.");
-            break;
+            return "Class type not found.";
         case WSA_E_NO_MORE:
-            Ts::println(out, "No more results.");
-            break;
+            return "No more results.";
         case WSA_E_CANCELLED:
-            Ts::println(out, "Call was canceled.");
-            break;
+            return "Call was canceled.";
         case WSAEREFUSED:
-            Ts::println(out, "Database query was refused.");
-            break;
+            return "Database query was refused.";
         case WSAHOST_NOT_FOUND:
-            Ts::println(out, "Host not found.");
-            break;
+            return "Host not found.";
         case WSATRY_AGAIN:
-            Ts::println(out, "Non authoritative host not found.");
-            break;
+            return "Non authoritative host not found.";
         case WSANO_RECOVERY:
-            Ts::println(out, "This is a nonrecoverable error.");
-            break;
+            return "This is a nonrecoverable error.";
         case WSANO_DATA:
-            Ts::println(out, "Valid name, no data record of requested type.");
-            break;
+            return "Valid name, no data record of requested type.";
         case WSA_QOS_RECEIVERS:
-            Ts::println(out, "QoS receivers.");
-            break;
+            return "QoS receivers.";
         case WSA_QOS_SENDERS:
-            Ts::println(out, "QoS senders.");
-            break;
+            return "QoS senders.";
         case WSA_QOS_NO_SENDERS:
-            Ts::println(out, "No QoS senders.");
-            break;
+            return "No QoS senders.";
         case WSA_QOS_NO_RECEIVERS:
-            Ts::println(out, "QoS no receivers.");
-            break;
+            return "QoS no receivers.";
         case WSA_QOS_REQUEST_CONFIRMED:
-            Ts::println(out, "QoS request confirmed.");
-            break;
+            return "QoS request confirmed.";
         case WSA_QOS_ADMISSION_FAILURE:
-            Ts::println(out, "QoS admission error.");
-            break;
+            return "QoS admission error.";
         case WSA_QOS_POLICY_FAILURE:
-            Ts::println(out, "QoS policy failure.");
-            break;
+            return "QoS policy failure.";
         case WSA_QOS_BAD_STYLE:
-            Ts::println(out, "QoS bad style.");
-            break;
+            return "QoS bad style.";
         case WSA_QOS_BAD_OBJECT:
-            Ts::println(out, "QoS bad object.");
-            break;
+            return "QoS bad object.";
         case WSA_QOS_TRAFFIC_CTRL_ERROR:
-            Ts::println(out, "QoS traffic control error.");
-            break;
+            return "QoS traffic control error.";
         case WSA_QOS_GENERIC_ERROR:
-            Ts::println(out, "QoS generic error.");
-            break;
+            return "QoS generic error.";
         case WSA_QOS_ESERVICETYPE:
-            Ts::println(out, "QoS service type error.");
-            break;
+            return "QoS service type error.";
         case WSA_QOS_EFLOWSPEC:
-            Ts::println(out, "QoS flowspec error.");
-            break;
+            return "QoS flowspec error.";
         case WSA_QOS_EPROVSPECBUF:
-            Ts::println(out, "Invalid QoS provider buffer.");
-            break;
+            return "Invalid QoS provider buffer.";
         case WSA_QOS_EFILTERSTYLE:
-            Ts::println(out, "Invalid QoS filter style.");
-            break;
+            return "Invalid QoS filter style.";
         case WSA_QOS_EFILTERTYPE:
-            Ts::println(out, "Invalid QoS filter type.");
-            break;
+            return "Invalid QoS filter type.";
         case WSA_QOS_EFILTERCOUNT:
-            Ts::println(out, "Incorrect QoS filter count.");
-            break;
+            return "Incorrect QoS filter count.";
         case WSA_QOS_EOBJLENGTH:
-            Ts::println(out, "Invalid QoS object length.");
-            break;
+            return "Invalid QoS object length.";
         case WSA_QOS_EFLOWCOUNT:
-            Ts::println(out, "Incorrect QoS flow count.");
-            break;
+            return "Incorrect QoS flow count.";
         case WSA_QOS_EUNKOWNPSOBJ:
-            Ts::println(out, "Unrecognized QoS object.");
-            break;
+            return "Unrecognized QoS object.";
         case WSA_QOS_EPOLICYOBJ:
-            Ts::println(out, "Invalid QoS policy object.");
-            break;
+            return "Invalid QoS policy object.";
         case WSA_QOS_EFLOWDESC:
-            Ts::println(out, "Invalid QoS flow descriptor.");
-            break;
+            return "Invalid QoS flow descriptor.";
         case WSA_QOS_EPSFLOWSPEC:
-            Ts::println(out, "Invalid QoS provider-specific flowspec.");
-            break;
+            return "Invalid QoS provider-specific flowspec.";
         case WSA_QOS_EPSFILTERSPEC:
-            Ts::println(out, "Invalid QoS provider-specific filterspec.");
-            break;
+            return "Invalid QoS provider-specific filterspec.";
         case WSA_QOS_ESDMODEOBJ:
-            Ts::println(out, "Invalid QoS shape discard mode object.");
-            break;
+            return "Invalid QoS shape discard mode object.";
         case WSA_QOS_ESHAPERATEOBJ:
-            Ts::println(out, "Invalid QoS shaping rate object.");
-            break;
+            return "Invalid QoS shaping rate object.";
         case WSA_QOS_RESERVED_PETYPE:
-            Ts::println(out, "Reserved policy QoS element type.");
-            break;
+            return "Reserved policy QoS element type.";
         default:
-            Ts::println(out, "unknown error");
-            break;
+            return "unknown error";
         }
 #else
-        switch (errno)
+        switch (code)
         {
         case E2BIG:
-            Ts::println(out, "Argument list too long.");
-            break;
+            return "Argument list too long.";
         case EACCES:
-            Ts::println(out, "Permission denied.");
-            break;
+            return "Permission denied.";
         case EADDRINUSE:
-            Ts::println(out, "Address already in use.");
-            break;
+            return "Address already in use.";
         case EADDRNOTAVAIL:
-            Ts::println(out, "Address not available.");
-            break;
+            return "Address not available.";
         case EAFNOSUPPORT:
-            Ts::println(out, "Address family not supported.");
-            break;
+            return "Address family not supported.";
         case EAGAIN:
-            Ts::println(out, "Resource temporarily unavailable.");
-            break;
+            return "Resource temporarily unavailable.";
         case EALREADY:
-            Ts::println(out, "Connection already in progress.");
-            break;
+            return "Connection already in progress.";
         case EBADE:
-            Ts::println(out, "Invalid exchange.");
-            break;
+            return "Invalid exchange.";
         case EBADF:
-            Ts::println(out, "Bad file descriptor.");
-            break;
+            return "Bad file descriptor.";
         case EBADFD:
-            Ts::println(out, "File descriptor in bad state.");
-            break;
+            return "File descriptor in bad state.";
         case EBADMSG:
-            Ts::println(out, "Bad message.");
-            break;
+            return "Bad message.";
         case EBADR:
-            Ts::println(out, "Invalid request descriptor.");
-            break;
+            return "Invalid request descriptor.";
         case EBADRQC:
-            Ts::println(out, "Invalid request code.");
-            break;
+            return "Invalid request code.";
         case EBADSLT:
-            Ts::println(out, "Invalid slot.");
-            break;
+            return "Invalid slot.";
         case EBUSY:
-            Ts::println(out, "Device or resource busy.");
-            break;
+            return "Device or resource busy.";
         case ECANCELED:
-            Ts::println(out, "Operation canceled.");
-            break;
+            return "Operation canceled.";
         case ECHILD:
-            Ts::println(out, "No child processes.");
-            break;
+            return "No child processes.";
         case ECHRNG:
-            Ts::println(out, "Channel number out of range.");
-            break;
+            return "Channel number out of range.";
         case ECOMM:
-            Ts::println(out, "Communication error on send.");
-            break;
+            return "Communication error on send.";
         case ECONNABORTED:
-            Ts::println(out, "Connection aborted.");
-            break;
+            return "Connection aborted.";
         case ECONNREFUSED:
-            Ts::println(out, "Connection refused.");
-            break;
+            return "Connection refused.";
         case ECONNRESET:
-            Ts::println(out, "Connection reset.");
-            break;
+            return "Connection reset.";
         case EDEADLK:
-            Ts::println(out, "Resource deadlock avoided.");
-            break;
+            return "Resource deadlock avoided.";
         // case EDEADLOCK:
-        //     Ts::println(out, "Resource deadlock avoided.");
-        //     break;
+        //     return "Resource deadlock avoided.";
         case EDESTADDRREQ:
-            Ts::println(out, "Destination address required.");
-            break;
+            return "Destination address required.";
         case EDOM:
-            Ts::println(out, "Mathematics argument out of domain of function.");
-            break;
+            return "Mathematics argument out of domain of function.";
         case EDQUOT:
-            Ts::println(out, "Disk quota exceeded.");
-            break;
+            return "Disk quota exceeded.";
         case EEXIST:
-            Ts::println(out, "File exists.");
-            break;
+            return "File exists.";
         case EFAULT:
-            Ts::println(out, "Bad address.");
-            break;
+            return "Bad address.";
         case EFBIG:
-            Ts::println(out, "File too large.");
-            break;
+            return "File too large.";
         case EHOSTDOWN:
-            Ts::println(out, "Host is down.");
-            break;
+            return "Host is down.";
         case EHOSTUNREACH:
-            Ts::println(out, "Host is unreachable.");
-            break;
+            return "Host is unreachable.";
         case EHWPOISON:
-            Ts::println(out, "Memory page has hardware error.");
-            break;
+            return "Memory page has hardware error.";
         case EIDRM:
-            Ts::println(out, "Identifier removed.");
-            break;
+            return "Identifier removed.";
         case EILSEQ:
-            Ts::println(out, "Invalid or incomplete multibyte or wide character.");
-            break;
+            return "Invalid or incomplete multibyte or wide character.";
         case EINPROGRESS:
-            Ts::println(out, "Operation in progress.");
-            break;
+            return "Operation in progress.";
         case EINTR:
-            Ts::println(out, "Interrupted function call.");
-            break;
+            return "Interrupted function call.";
         case EINVAL:
-            Ts::println(out, "Invalid argument.");
-            break;
+            return "Invalid argument.";
         case EIO:
-            Ts::println(out, "Input/output error.");
-            break;
+            return "Input/output error.";
         case EISCONN:
-            Ts::println(out, "Socket is connected.");
-            break;
+            return "Socket is connected.";
         case EISDIR:
-            Ts::println(out, "Is a directory.");
-            break;
+            return "Is a directory.";
         case EISNAM:
-            Ts::println(out, "Is a named type file.");
-            break;
+            return "Is a named type file.";
         case EKEYEXPIRED:
-            Ts::println(out, "Key has expired.");
-            break;
+            return "Key has expired.";
         case EKEYREJECTED:
-            Ts::println(out, "Key was rejected by service.");
-            break;
+            return "Key was rejected by service.";
         case EKEYREVOKED:
-            Ts::println(out, "Key has been revoked.");
-            break;
+            return "Key has been revoked.";
         case EL2HLT:
-            Ts::println(out, "Level 2 halted.");
-            break;
+            return "Level 2 halted.";
         case EL2NSYNC:
-            Ts::println(out, "Level 2 not synchronized.");
-            break;
+            return "Level 2 not synchronized.";
         case EL3HLT:
-            Ts::println(out, "Level 3 halted.");
-            break;
+            return "Level 3 halted.";
         case EL3RST:
-            Ts::println(out, "Level 3 reset.");
-            break;
+            return "Level 3 reset.";
         case ELIBACC:
-            Ts::println(out, "Cannot access a needed shared library.");
-            break;
+            return "Cannot access a needed shared library.";
         case ELIBBAD:
-            Ts::println(out, "Accessing a corrupted shared library.");
-            break;
+            return "Accessing a corrupted shared library.";
         case ELIBMAX:
-            Ts::println(out, "Attempting to link in too many shared libraries.");
-            break;
+            return "Attempting to link in too many shared libraries.";
         case ELIBSCN:
-            Ts::println(out, ".lib section in a.out corrupted");
-            break;
+            return ".lib section in a.out corrupted";
         case ELIBEXEC:
-            Ts::println(out, "Cannot exec a shared library directly.");
-            break;
+            return "Cannot exec a shared library directly.";
         case ELNRNG:
-            Ts::println(out, "Link number out of range.");
-            break;
+            return "Link number out of range.";
         case ELOOP:
-            Ts::println(out, "Too many levels of symbolic links.");
-            break;
+            return "Too many levels of symbolic links.";
         case EMEDIUMTYPE:
-            Ts::println(out, "Wrong medium type.");
-            break;
+            return "Wrong medium type.";
         case EMFILE:
-            Ts::println(out, "Too many open files.");
-            break;
+            return "Too many open files.";
         case EMLINK:
-            Ts::println(out, "Too many links.");
-            break;
+            return "Too many links.";
         case EMSGSIZE:
-            Ts::println(out, "Message too long.");
-            break;
+            return "Message too long.";
         case EMULTIHOP:
-            Ts::println(out, "Multihop attempted.");
-            break;
+            return "Multihop attempted.";
         case ENAMETOOLONG:
-            Ts::println(out, "Filename too long.");
-            break;
+            return "Filename too long.";
         case ENETDOWN:
-            Ts::println(out, "Network is down.");
-            break;
+            return "Network is down.";
         case ENETRESET:
-            Ts::println(out, "Connection aborted by network.");
-            break;
+            return "Connection aborted by network.";
         case ENETUNREACH:
-            Ts::println(out, "Network unreachable.");
-            break;
+            return "Network unreachable.";
         case ENFILE:
-            Ts::println(out, "Too many open files in system.");
-            break;
+            return "Too many open files in system.";
         case ENOANO:
-            Ts::println(out, "No anode.");
-            break;
+            return "No anode.";
         case ENOBUFS:
-            Ts::println(out, "No buffer space available.");
-            break;
+            return "No buffer space available.";
         case ENODATA:
-            Ts::println(out, "The named attribute does not exist, or the process has no access to this attribute");
-            break;
+            return "The named attribute does not exist, or the process has no access to this attribute";
         case ENODEV:
-            Ts::println(out, "No such device.");
-            break;
+            return "No such device.";
         case ENOENT:
-            Ts::println(out, "No such file or directory.");
-            break;
+            return "No such file or directory.";
         case ENOEXEC:
-            Ts::println(out, "Exec format error.");
-            break;
+            return "Exec format error.";
         case ENOKEY:
-            Ts::println(out, "Required key not available.");
-            break;
+            return "Required key not available.";
         case ENOLCK:
-            Ts::println(out, "No locks available.");
-            break;
+            return "No locks available.";
         case ENOLINK:
-            Ts::println(out, "Link has been severed.");
-            break;
+            return "Link has been severed.";
         case ENOMEDIUM:
-            Ts::println(out, "No medium found.");
-            break;
+            return "No medium found.";
         case ENOMEM:
-            Ts::println(out, "Not enough space/cannot allocate memory.");
-            break;
+            return "Not enough space/cannot allocate memory.";
         case ENOMSG:
-            Ts::println(out, "No message of the desired type.");
-            break;
+            return "No message of the desired type.";
         case ENONET:
-            Ts::println(out, "Machine is not on the network.");
-            break;
+            return "Machine is not on the network.";
         case ENOPKG:
-            Ts::println(out, "Package not installed.");
-            break;
+            return "Package not installed.";
         case ENOPROTOOPT:
-            Ts::println(out, "Protocol not available.");
-            break;
+            return "Protocol not available.";
         case ENOSPC:
-            Ts::println(out, "No space left on device.");
-            break;
+            return "No space left on device.";
         case ENOSR:
-            Ts::println(out, "No STREAM resources.");
-            break;
+            return "No STREAM resources.";
         case ENOSTR:
-            Ts::println(out, "Not a STREAM.");
-            break;
+            return "Not a STREAM.";
         case ENOSYS:
-            Ts::println(out, "Function not implemented.");
-            break;
+            return "Function not implemented.";
         case ENOTBLK:
-            Ts::println(out, "Block device required.");
-            break;
+            return "Block device required.";
         case ENOTCONN:
-            Ts::println(out, "The socket is not connected.");
-            break;
+            return "The socket is not connected.";
         case ENOTDIR:
-            Ts::println(out, "Not a directory.");
-            break;
+            return "Not a directory.";
         case ENOTEMPTY:
-            Ts::println(out, "Directory not empty.");
-            break;
+            return "Directory not empty.";
         case ENOTRECOVERABLE:
-            Ts::println(out, "State not recoverable.");
-            break;
+            return "State not recoverable.";
         case ENOTSOCK:
-            Ts::println(out, "Not a socket.");
-            break;
+            return "Not a socket.";
         // case ENOTSUP:
-        //     Ts::println(out, "Operation not supported.");
-        //     break;
+        //     return "Operation not supported.";
         case EOPNOTSUPP:
-            Ts::println(out, "Operation not supported on socket.");
-            break;
+            return "Operation not supported on socket.";
         case ENOTTY:
-            Ts::println(out, "Inappropriate I/O control operation.");
-            break;
+            return "Inappropriate I/O control operation.";
         case ENOTUNIQ:
-            Ts::println(out, "Name not unique on network.");
-            break;
+            return "Name not unique on network.";
         case ENXIO:
-            Ts::println(out, "No such device or address.");
-            break;
+            return "No such device or address.";
         case EOVERFLOW:
-            Ts::println(out, "Value too large to be stored in data type.");
-            break;
+            return "Value too large to be stored in data type.";
         case EOWNERDEAD:
-            Ts::println(out, "Owner died.");
-            break;
+            return "Owner died.";
         case EPERM:
-            Ts::println(out, "Operation not permitted.");
-            break;
+            return "Operation not permitted.";
         case EPFNOSUPPORT:
-            Ts::println(out, "Protocol family not supported.");
-            break;
+            return "Protocol family not supported.";
         case EPIPE:
-            Ts::println(out, "Broken pipe.");
-            break;
+            return "Broken pipe.";
         case EPROTO:
-            Ts::println(out, "Protocol error.");
-            break;
+            return "Protocol error.";
         case EPROTONOSUPPORT:
-            Ts::println(out, "Protocol not supported.");
-            break;
+            return "Protocol not supported.";
         case EPROTOTYPE:
-            Ts::println(out, "Protocol wrong type for socket.");
-            break;
+            return "Protocol wrong type for socket.";
         case ERANGE:
-            Ts::println(out, "Result too large.");
-            break;
+            return "Result too large.";
         case EREMCHG:
-            Ts::println(out, "Remote address changed.");
-            break;
+            return "Remote address changed.";
         case EREMOTE:
-            Ts::println(out, "Object is remote.");
-            break;
+            return "Object is remote.";
         case EREMOTEIO:
-            Ts::println(out, "Remote I/O error.");
-            break;
+            return "Remote I/O error.";
         case ERESTART:
-            Ts::println(out, "Interrupted system call should be restarted.");
-            break;
+            return "Interrupted system call should be restarted.";
         case ERFKILL:
-            Ts::println(out, "Operation not possible due to RF-kill.");
-            break;
+            return "Operation not possible due to RF-kill.";
         case EROFS:
-            Ts::println(out, "Read-only filesystem.");
-            break;
+            return "Read-only filesystem.";
         case ESHUTDOWN:
-            Ts::println(out, "Cannot send after transport endpoint shutdown.");
-            break;
+            return "Cannot send after transport endpoint shutdown.";
         case ESPIPE:
-            Ts::println(out, "Invalid seek.");
-            break;
+            return "Invalid seek.";
         case ESOCKTNOSUPPORT:
-            Ts::println(out, "Socket type not supported.");
-            break;
+            return "Socket type not supported.";
         case ESRCH:
-            Ts::println(out, "No such process.");
-            break;
+            return "No such process.";
         case ESTALE:
-            Ts::println(out, "Stale file handle.");
-            break;
+            return "Stale file handle.";
         case ESTRPIPE:
-            Ts::println(out, "Streams pipe error.");
-            break;
+            return "Streams pipe error.";
         case ETIME:
-            Ts::println(out, "Timer expired.");
-            break;
+            return "Timer expired.";
         case ETIMEDOUT:
-            Ts::println(out, "Connection timed out.");
-            break;
+            return "Connection timed out.";
         case ETOOMANYREFS:
-            Ts::println(out, "Too many references: cannot splice.");
-            break;
+            return "Too many references: cannot splice.";
         case ETXTBSY:
-            Ts::println(out, "Text file busy.");
-            break;
+            return "Text file busy.";
         case EUCLEAN:
-            Ts::println(out, "Structure needs cleaning.");
-            break;
+            return "Structure needs cleaning.";
         case EUNATCH:
-            Ts::println(out, "Protocol driver not attached.");
-            break;
+            return "Protocol driver not attached.";
         case EUSERS:
-            Ts::println(out, "Too many users.");
-            break;
+            return "Too many users.";
         case EXDEV:
-            Ts::println(out, "Invalid cross-device link.");
-            break;
+            return "Invalid cross-device link.";
         case EXFULL:
-            Ts::println(out, "Exchange full.");
-            break;
+            return "Exchange full.";
         default:
-            Ts::println(out, "Unknown error. (", errno, ')');
-            break;
+            return "Unknown error.";
         }
 #endif
     }
@@ -28,12 +28,17 @@
     #include <arpa/inet.h>
     #include <netdb.h>
     #include <netinet/in.h>
+    #include <netinet/tcp.h>
     #include <sys/signal.h>
     #include <sys/socket.h>
     #include <sys/time.h>
+    #include <sys/uio.h>
 #endif
 
+#include <chrono>
 #include <cstdint>
+#include "Sockets/ErrorCode.h"
+#include "Sockets/Ipv4.h"
 #include "Utils/Json.h"
 #include "Utils/String.h"
 
@@ -41,18 +46,24 @@ namespace Rt2::Sockets
 {
 #if RT_PLATFORM == RT_PLATFORM_WINDOWS
     using PlatformSocket                   = SOCKET;
+    using IoVector                         = WSABUF;
     constexpr PlatformSocket InvalidSocket = INVALID_SOCKET;
 #else
     using PlatformSocket                   = int;
+    using IoVector                         = iovec;
     constexpr PlatformSocket InvalidSocket = -1;
 #endif
     constexpr int MaxBufferSize = 0x7FFFFF;
 
     namespace Default
     {
-        constexpr size_t IoBufferSize  = 0x800;
-        constexpr int    SocketTimeOut = 1000;
-        constexpr int    AcceptTimeOut = 0x00;
+        constexpr size_t IoBufferSize      = 0x800;
+        constexpr int    SocketTimeOut     = 1000;
+        constexpr int    AcceptTimeOut     = 0x00;
+        constexpr int    AcceptBatch       = 0x40;
+        constexpr int    ListenBacklog     = 0x00;  // zero sizes it from somaxconn
+        constexpr int    LowLatencyNotSent = 0x4000;
+        constexpr int    KernelNotSent     = 0x00;  // zero defers to tcp_notsent_lowat
     }  // namespace Default
 
     class Connection;
@@ -62,9 +73,11 @@ namespace Rt2::Sockets
 
     enum Status
     {
-        DoneStatus  = -2,
-        ErrorStatus = -1,
-        OkStatus    = 0,
+        TimeoutStatus = -4,
+        ClosedStatus  = -3,
+        DoneStatus    = -2,
+        ErrorStatus   = -1,
+        OkStatus      = 0,
     };
 
     enum AddressFamily
@@ -102,6 +115,130 @@ namespace Rt2::Sockets
         ReceiveBufferSize = SO_RCVBUF,
         ReceiveTimeout    = SO_RCVTIMEO,
         SendTimeout       = SO_SNDTIMEO,
+        AcceptConnection  = SO_ACCEPTCONN,  // read only; set by listen
+#ifdef SO_ZEROCOPY
+        ZeroCopy = SO_ZEROCOPY,
+#else
+        ZeroCopy = -0xFE,
+#endif
+#ifdef SO_BUSY_POLL
+        BusyPoll = SO_BUSY_POLL,  // microseconds; raising it needs CAP_NET_ADMIN
+#else
+        BusyPoll = -0xFD,
+#endif
+#ifdef SO_PREFER_BUSY_POLL
+        PreferBusyPoll = SO_PREFER_BUSY_POLL,
+#else
+        PreferBusyPoll = -0xFC,
+#endif
+#ifdef SO_TIMESTAMPNS
+        ReceiveTimestamp = SO_TIMESTAMPNS,  // software receive stamps
+#else
+        ReceiveTimestamp = -0xFB,
+#endif
+#ifdef SO_TIMESTAMPING
+        Timestamping = SO_TIMESTAMPING,  // SOF_TIMESTAMPING_* flags
+#else
+        Timestamping = -0xFA,
+#endif
+    };
+
+    // Options that live at the IPPROTO_TCP level. Options that the
+    // platform headers do not define map to a negative placeholder, and
+    // Net::setOption reports them as unsupported.
+    enum TcpOption
+    {
+        NoDelay = TCP_NODELAY,
+#ifdef TCP_CORK
+        Cork = TCP_CORK,
+#else
+        Cork = -0x101,
+#endif
+#ifdef TCP_QUICKACK
+        QuickAck = TCP_QUICKACK,
+#else
+        QuickAck = -0x102,
+#endif
+#ifdef TCP_FASTOPEN
+        FastOpen = TCP_FASTOPEN,
+#else
+        FastOpen = -0x103,
+#endif
+#ifdef TCP_FASTOPEN_CONNECT
+        FastOpenConnect = TCP_FASTOPEN_CONNECT,
+#else
+        FastOpenConnect = -0x104,
+#endif
+#ifdef TCP_NOTSENT_LOWAT
+        NotSentLowWater = TCP_NOTSENT_LOWAT,
+#else
+        NotSentLowWater = -0x105,
+#endif
+#ifdef TCP_KEEPIDLE
+        KeepIdle = TCP_KEEPIDLE,
+#else
+        KeepIdle = -0x106,
+#endif
+#ifdef TCP_KEEPINTVL
+        KeepInterval = TCP_KEEPINTVL,
+#else
+        KeepInterval = -0x107,
+#endif
+#ifdef TCP_KEEPCNT
+        KeepCount = TCP_KEEPCNT,
+#else
+        KeepCount = -0x108,
+#endif
+#ifdef TCP_USER_TIMEOUT
+        UserTimeout = TCP_USER_TIMEOUT,
+#else
+        UserTimeout = -0x109,
+#endif
+    };
+
+    // Range of zero-copy send calls the kernel has finished with.
+    // Sends are numbered from zero per socket in the order they were
+    // accepted. copied is set when the kernel fell back to copying,
+    // which is what loopback always does.
+    struct ZeroCopyCompletion
+    {
+        uint32_t first{0};
+        uint32_t last{0};
+        bool     copied{false};
+    };
+
+    // When the kernel, or the network card, received the data, in
+    // nanoseconds of the system clock. Zero when the socket has
+    // timestamps off or the platform has none; Linux also starts
+    // stamping a moment after the first socket asks. Hardware stamps
+    // come from the card's clock and only compare with the system
+    // clock when the two are synchronized.
+    struct RecvTimestamp
+    {
+        int64_t nanoseconds{0};
+        bool    hardware{false};
+
+        bool valid() const;
+
+        // Nanoseconds from the stamp to now.
+        int64_t age() const;
+
+        // The system clock the kernel stamps with, in nanoseconds.
+        static int64_t now();
+    };
+
+    enum LatencyProfile
+    {
+        ProfileDefault,
+        ProfileLowLatency,      // small request/response messages
+        ProfileBulkThroughput,  // large streaming transfers
+    };
+
+    enum AcceptFlags
+    {
+        AcceptDefault     = 0x00,
+        AcceptNonBlocking = 0x01,
+        AcceptCloseOnExec = 0x02,
     };
 
     enum PollMode
@@ -151,14 +288,29 @@ namespace Rt2::Sockets
 
         SocketInputAddress& input();
 
+        Ipv4 ipv4() const;
+
+        // Formatted on request; the connection only keeps the binary
+        // address.
+        Ipv4Text addressText() const;
+
         String address() const;
 
         uint16_t port() const;
     };
 
+    class NetBackend;
+
     class Net
     {
     public:
+        // Routes the data transfer calls (send, receive, poll and
+        // close) through backend; null restores the system's sockets.
+        // The backend must outlive every call made while installed.
+        static void setBackend(NetBackend* backend);
+
+        static NetBackend& backend();
+
         static PlatformSocket create(
             AddressFamily address,
             SocketType    type,
@@ -168,6 +320,21 @@ namespace Rt2::Sockets
         static void close(
             const PlatformSocket& sock);
 
+        // A second handle to the same socket, closed independently.
+        static PlatformSocket duplicate(
+            const PlatformSocket& sock);
+
+        // Passes a handle to the peer of a connected AF_UNIX stream
+        // with SCM_RIGHTS. Not available on Windows.
+        static Status sendHandle(
+            const PlatformSocket& channel,
+            const PlatformSocket& handle);
+
+        static Status receiveHandle(
+            const PlatformSocket& channel,
+            PlatformSocket&       dest,
+            int                   timeout = Default::SocketTimeOut);
+
         static Status connect(
             const PlatformSocket& sock,
             const String&         ipv4,
@@ -185,6 +352,16 @@ namespace Rt2::Sockets
             const PlatformSocket& sock,
             int32_t               backlog);
 
+        // Binds or connects an AF_UNIX socket to a filesystem path.
+        // Not available on Windows.
+        static Status bindLocal(
+            const PlatformSocket& sock,
+            const String&         path);
+
+        static Status connectLocal(
+            const PlatformSocket& sock,
+            const String&         path);
+
         static PlatformSocket accept(
             const PlatformSocket& sock);
 
@@ -196,6 +373,16 @@ namespace Rt2::Sockets
             const PlatformSocket& sock,
             Connection&           result);
 
+        static PlatformSocket accept(
+            const PlatformSocket& sock,
+            SocketInputAddress&   dest,
+            int                   flags);
+
+        static PlatformSocket accept(
+            const PlatformSocket& sock,
+            Connection&           result,
+            int                   flags);
+
         static bool poll(
             const PlatformSocket& sock,
             int                   timeout = 0,
@@ -208,12 +395,92 @@ namespace Rt2::Sockets
             int&                  bytesRead,
             int                   timeout = 100);
 
+        static Status receive(
+            const PlatformSocket& sock,
+            char*                 dest,
+            int                   destSizeInBytes,
+            int&                  bytesRead,
+            int                   timeout = 100);
+
+        // receive that also returns when the kernel received the data,
+        // for sockets with ReceiveTimestamp or Timestamping enabled.
+        // A software stamp's age is recorded in kernel_queue.
+        static Status receive(
+            const PlatformSocket& sock,
+            char*                 dest,
+            int                   destSizeInBytes,
+            int&                  bytesRead,
+            RecvTimestamp&        stamp,
+            int                   timeout = 100);
+
+        // Marks sock as accepted at a RecvTimestamp::now() time. The
+        // calling thread's next receive or readVector on it records the
+        // first byte's stamp in accept_to_first_byte and
+        // first_byte_to_handler. Zero clears the mark.
+        static void markAccepted(const PlatformSocket& sock, int64_t accepted);
+
+        // Waits for data and returns the first unread byte's stamp
+        // without consuming it.
+        static Status peekTimestamp(
+            const PlatformSocket& sock,
+            RecvTimestamp&        stamp,
+            int                   timeout = 100);
+
+        // One receive that does not wait, on any socket. TimeoutStatus
+        // means nothing was buffered.
+        static Status receiveNow(
+            const PlatformSocket& sock,
+            char*                 dest,
+            int                   destSizeInBytes,
+            int&                  bytesRead);
+
+        static Status readVector(
+            const PlatformSocket& sock,
+            IoVector*             vectors,
+            int                   count,
+            int&                  bytesRead,
+            int                   timeout = 100);
+
         static int writeSocket(
             const PlatformSocket& sock,
             const void*           ptr,
             size_t                sizeInBytes,
             int                   timeout = 100);
 
+        // One non-blocking gather write. TimeoutStatus means the send
+        // buffer is full; bytesSent may be short of the total.
+        static Status sendVector(
+            const PlatformSocket& sock,
+            IoVector*             vectors,
+            int                   count,
+            int&                  bytesSent);
+
+        // Gathers the vectors into as few sends as possible. Partially
+        // sent vectors are advanced in place, so the array is modified.
+        static int writeVector(
+            const PlatformSocket& sock,
+            IoVector*             vectors,
+            int                   count,
+            int                   timeout = 100);
+
+        // One non-blocking send with MSG_ZEROCOPY. The pages stay
+        // pinned until a completion for this call is read, so the
+        // memory must not change until then.
+        static Status sendZeroCopy(
+            const PlatformSocket& sock,
+            const void*           ptr,
+            size_t                sizeInBytes,
+            int&                  bytesSent);
+
+        // Reads one completion from the socket error queue, waiting up
+        // to timeout milliseconds for it.
+        static Status readCompletion(
+            const PlatformSocket& sock,
+            ZeroCopyCompletion&   dest,
+            int                   timeout = 0);
+
+        static bool isZeroCopySupported();
+
         static Status setOption(
             const PlatformSocket& sock,
             SocketOption          option,
@@ -229,6 +496,18 @@ namespace Rt2::Sockets
         static int  optionInt(const PlatformSocket& sock,
                               SocketOption          option);
 
+        static Status setOption(
+            const PlatformSocket& sock,
+            TcpOption             option,
+            int                   val);
+
+        static bool optionBool(const PlatformSocket& sock,
+                               TcpOption             option);
+        static int  optionInt(const PlatformSocket& sock,
+                              TcpOption             option);
+
+        static bool isSupported(TcpOption option);
+
         static void ensureInitialized();
 
         static bool isValidIpv4(const String& address);
@@ -238,6 +517,26 @@ namespace Rt2::Sockets
         public:
             static void setBlocking(PlatformSocket sock, bool val);
 
+            static void makeVector(IoVector& dest, const void* base, size_t size);
+
+            static char* vectorBase(const IoVector& vec);
+
+            static size_t vectorSize(const IoVector& vec);
+
+            // Drops the first bytes from a vector array, moving past
+            // vectors that were consumed whole.
+            static void advanceVector(IoVector*& vectors, int& count, size_t bytes);
+
+            static void setCloseOnExec(PlatformSocket sock, bool val);
+
+            static bool wouldBlock();
+
+            static int32_t maxListenBacklog();
+
+            // The family the socket was created with, from its local
+            // address; unknown for anything besides INet and Unix.
+            static AddressFamily addressFamily(PlatformSocket sock);
+
             static uint32_t asciiToNetworkIpV4(const String& inp);
 
             static String networkToAsciiIpV4(const uint32_t& inp);
@@ -277,26 +576,58 @@ namespace Rt2::Sockets
                 const String&       address);
         };
 
+        // Failures are recorded per thread rather than printed. Nothing
+        // is written anywhere unless a sink is installed, and the sink
+        // is rate limited so a burst of resets cannot flood it.
         class Error
         {
         public:
-            static void log();
+            // Captures the calling thread's system error against op.
+            static ErrorCode record(NetOperation op);
+
+            static ErrorCode record(NetOperation op, int32_t code);
+
+            // The last error recorded on the calling thread.
+            static const ErrorCode& last();
+
+            static void clear();
+
+            static const char* describe(int32_t code);
+
+            static const char* toString(NetOperation op);
+
+            static void setSink(const ErrorSink& sink, int perSecond = Default::ErrorLogRate);
+
+            // Errors that arrived while the sink was over its rate.
+            static uint64_t suppressed();
+
+            // A sink that prints one line per error to out.
+            static ErrorSink streamSink(OStream& out);
+
+            static void log(OStream& out, const ErrorCode& err);
 
             static void log(OStream& out);
 
+            // Writes the last error to the console.
+            static void log();
+
             [[noreturn]] static void error();
         };
 
+        static const ErrorCode& lastError();
+
     private:
         static Status setOption(
             const PlatformSocket& sock,
-            SocketOption          option,
+            int                   level,
+            int                   option,
             const void*           value,
             size_t                valueSize);
 
         static Status getOption(
             const PlatformSocket& sock,
-            SocketOption          option,
+            int                   level,
+            int                   option,
             void*                 dest,
             int&                  size);
     };
@@ -306,9 +637,19 @@ namespace Rt2::Sockets
         return _inp;
     }
 
+    inline Ipv4 Connection::ipv4() const
+    {
+        return Ipv4::fromNetwork(_inp.sin_addr.s_addr);
+    }
+
+    inline Ipv4Text Connection::addressText() const
+    {
+        return ipv4().text();
+    }
+
     inline String Connection::address() const
     {
-        return Net::Utils::networkToAsciiIpV4(_inp.sin_addr.s_addr);
+        return ipv4().toString();
     }
 
     inline uint16_t Connection::port() const
@@ -316,4 +657,21 @@ namespace Rt2::Sockets
         return Net::Utils::networkToHostShort(_inp.sin_port);
     }
 
+    inline bool RecvTimestamp::valid() const
+    {
+        return nanoseconds != 0;
+    }
+
+    inline int64_t RecvTimestamp::age() const
+    {
+        return now() - nanoseconds;
+    }
+
+    inline int64_t RecvTimestamp::now()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::system_clock::now().time_since_epoch())
+            .count();
+    }
+
 }  // namespace Rt2::Sockets
@@ -0,0 +1,165 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#include "Sockets/RecvBuffer.h"
+#include <cstring>
+#include "Sockets/Simd.h"
+
+namespace Rt2::Sockets
+{
+    RecvBuffer::RecvBuffer(const size_t initial, BufferPool* pool) :
+        _pool(pool ? pool : &BufferPool::global())
+    {
+        _block = _pool->acquire(initial);
+    }
+
+    RecvBuffer::~RecvBuffer()
+    {
+        _pool->release(_block);
+        _pool->release(_spare);
+    }
+
+    void RecvBuffer::consume(size_t n)
+    {
+        n = n < size() ? n : size();
+        _head += n;
+        if (_head == _tail)
+            _head = _tail = 0;
+    }
+
+    void RecvBuffer::clear()
+    {
+        _head = _tail = 0;
+    }
+
+    void RecvBuffer::reserve(const size_t extra)
+    {
+        if (_block.capacity - _tail >= extra)
+            return;
+
+        const size_t used = size();
+
+        // Slide the unread bytes to the front when that frees enough
+        // room, otherwise move them into a larger block.
+        if (_block.capacity - used >= extra)
+            memmove(_block.data, data(), used);
+        else
+        {
+            PoolBlock grown = _pool->acquire(used + extra);
+            if (used > 0)
+                memcpy(grown.data, data(), used);
+            _pool->release(_block);
+            _block = grown;
+        }
+        _head = 0;
+        _tail = used;
+    }
+
+    Status RecvBuffer::fill(const PlatformSocket& sock, const int timeout)
+    {
+        // keep at least a quarter of a block free for the direct read
+        reserve(Default::RecvBlockSize / 4);
+
+        if (!_spare.data)
+            _spare = _pool->acquire(Default::RecvBlockSize);
+
+        const size_t room = _block.capacity - _tail;
+
+        IoVector vec[2];
+        Net::Utils::makeVector(vec[0], _block.data + _tail, room);
+        Net::Utils::makeVector(vec[1], _spare.data, _spare.capacity);
+
+        int          br = 0;
+        const Status st = Net::readVector(sock, vec, 2, br, timeout);
+        if (st != OkStatus)
+            return st;
+
+        if ((size_t)br <= room)
+            _tail += (size_t)br;
+        else
+        {
+            // the burst spilled into the spare block
+            const size_t spill = (size_t)br - room;
+            _tail += room;
+            reserve(spill);
+            memcpy(_block.data + _tail, _spare.data, spill);
+            _tail += spill;
+        }
+
+        if (_limit > 0 && size() > _limit)
+            return ErrorStatus;
+        return OkStatus;
+    }
+
+    Status RecvBuffer::scan(const PlatformSocket& sock,
+                            const std::string_view delimiter,
+                            std::string_view&     dest,
+                            const int             timeout)
+    {
+        RT_GUARD_RET(!delimiter.empty(), ErrorStatus)
+
+        size_t scanned = 0;
+        for (;;)
+        {
+            if (const size_t pos = Simd::find(view(), delimiter, scanned);
+                pos != std::string_view::npos)
+            {
+                dest = {data(), pos};
+                consume(pos + delimiter.size());
+                return OkStatus;
+            }
+
+            // only rescan the tail that could hold a partial match
+            if (size() >= delimiter.size())
+                scanned = size() - delimiter.size() + 1;
+
+            if (const Status st = fill(sock, timeout); st != OkStatus)
+                return st;
+        }
+    }
+
+    Status RecvBuffer::readUntil(const PlatformSocket& sock,
+                                 const std::string_view delimiter,
+                                 std::string_view&     dest,
+                                 const int             timeout)
+    {
+        return scan(sock, delimiter, dest, timeout);
+    }
+
+    Status RecvBuffer::readUntil(const PlatformSocket& sock,
+                                 const char            delimiter,
+                                 std::string_view&     dest,
+                                 const int             timeout)
+    {
+        return scan(sock, {&delimiter, 1}, dest, timeout);
+    }
+
+    Status RecvBuffer::readLine(const PlatformSocket& sock,
+                                std::string_view&     dest,
+                                const int             timeout)
+    {
+        const Status st = scan(sock, "\n", dest, timeout);
+        if (st == OkStatus && !dest.empty() && dest.back() == '\r')
+            dest.remove_suffix(1);
+        return st;
+    }
+
+}  // namespace Rt2::Sockets
@@ -0,0 +1,142 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#pragma once
+#include <string_view>
+#include "Sockets/BufferPool.h"
+#include "Sockets/PlatformSocket.h"
+
+namespace Rt2::Sockets
+{
+    namespace Default
+    {
+        constexpr size_t RecvBlockSize = 0x4000;
+    }
+
+    // Receive buffer that hands out views of the received bytes in
+    // place. The readable region is always contiguous, so parsers can
+    // scan it directly; nothing is copied out and no terminator is
+    // written. Storage comes from a BufferPool.
+    class RecvBuffer
+    {
+    private:
+        BufferPool* _pool{nullptr};
+        PoolBlock   _block;
+        PoolBlock   _spare;
+        size_t      _head{0};
+        size_t      _tail{0};
+        size_t      _limit{0};
+
+        void reserve(size_t extra);
+
+        Status scan(const PlatformSocket& sock,
+                    std::string_view      delimiter,
+                    std::string_view&     dest,
+                    int                   timeout);
+
+    public:
+        explicit RecvBuffer(size_t initial = Default::RecvBlockSize,
+                            BufferPool* pool    = nullptr);
+        ~RecvBuffer();
+
+        RecvBuffer(const RecvBuffer&)            = delete;
+        RecvBuffer& operator=(const RecvBuffer&) = delete;
+
+        // Receives whatever is available in one call. The free space at
+        // the tail and a spare pooled block are passed to readv together,
+        // so a large burst is taken in a single system call.
+        Status fill(const PlatformSocket& sock, int timeout = Default::SocketTimeOut);
+
+        // Receives until the delimiter is buffered, then points dest at
+        // the bytes in front of it and consumes both. The view stays
+        // valid until the next fill, read or clear.
+        Status readUntil(const PlatformSocket& sock,
+                         std::string_view      delimiter,
+                         std::string_view&     dest,
+                         int                   timeout = Default::SocketTimeOut);
+
+        Status readUntil(const PlatformSocket& sock,
+                         char                  delimiter,
+                         std::string_view&     dest,
+                         int                   timeout = Default::SocketTimeOut);
+
+        // readUntil on '\n' with a trailing '\r' removed.
+        Status readLine(const PlatformSocket& sock,
+                        std::string_view&     dest,
+                        int                   timeout = Default::SocketTimeOut);
+
+        std::string_view view() const;
+
+        const char* data() const;
+
+        char* data();
+
+        size_t size() const;
+
+        bool empty() const;
+
+        void consume(size_t n);
+
+        void clear();
+
+        size_t capacity() const;
+
+        // Upper bound on the buffered bytes; zero means no limit.
+        // fill reports ErrorStatus when a receive would exceed it.
+        void setLimit(size_t bytes);
+    };
+
+    inline std::string_view RecvBuffer::view() const
+    {
+        return {data(), size()};
+    }
+
+    inline const char* RecvBuffer::data() const
+    {
+        return _block.data + _head;
+    }
+
+    inline char* RecvBuffer::data()
+    {
+        return _block.data + _head;
+    }
+
+    inline size_t RecvBuffer::size() const
+    {
+        return _tail - _head;
+    }
+
+    inline bool RecvBuffer::empty() const
+    {
+        return _tail == _head;
+    }
+
+    inline size_t RecvBuffer::capacity() const
+    {
+        return _block.capacity;
+    }
+
+    inline void RecvBuffer::setLimit(const size_t bytes)
+    {
+        _limit = bytes;
+    }
+
+}  // namespace Rt2::Sockets
@@ -27,11 +27,25 @@
 
 namespace Rt2::Sockets
 {
+    ServerSocket::ServerSocket(const String&       ipv4,
+                               const uint16_t      port,
+                               const SocketConfig& config)
+    {
+        open(ipv4, port, config);
+    }
+
     ServerSocket::ServerSocket(const String&  ipv4,
                                const uint16_t port,
-                               const uint16_t backlog)
+                               const int32_t  backlog)
+    {
+        SocketConfig config;
+        config.backlog = backlog;
+        open(ipv4, port, config);
+    }
+
+    ServerSocket::ServerSocket(const PlatformSocket listener, const SocketConfig& config)
     {
-        open(ipv4, port, backlog);
+        adopt(listener, config);
     }
 
     ServerSocket::~ServerSocket()
@@ -40,7 +54,7 @@ namespace Rt2::Sockets
         close();
     }
 
-    void ServerSocket::open(const String& ipv4, uint16_t port, const uint16_t backlog)
+    void ServerSocket::open(const String& ipv4, uint16_t port, const SocketConfig& config)
     {
         try
         {
@@ -52,10 +66,13 @@ namespace Rt2::Sockets
 
             setReuseAddress(true);
 
-            setMaxReceiveBuffer(Default::IoBufferSize);
-            setMaxSendBuffer(Default::IoBufferSize);
-            setSendTimeout(Default::SocketTimeOut);
-            setReceiveTimeout(Default::SocketTimeOut);
+            // The accept loop drains the backlog until it would block.
+            setBlocking(false);
+
+            // Accepted sockets inherit these from the listener.
+            configure(config);
+            if (config.fastOpen > 0)
+                setFastOpen(config.fastOpen);
 
             SocketInputAddress host;
             Net::Utils::constructInputAddress(host, AddressFamilyINet, port, ipv4);
@@ -63,6 +80,10 @@ namespace Rt2::Sockets
             if (Net::bind(_sock, host) != OkStatus)
                 throw Exception("Failed to bind server socket to ", ipv4, ':', port);
 
+            int32_t backlog = config.backlog;
+            if (backlog <= 0)
+                backlog = Net::Utils::maxListenBacklog();
+
             if (Net::listen(_sock, backlog) != OkStatus)
                 throw Exception("Failed to listen on the server socket");
 
@@ -75,6 +96,32 @@ namespace Rt2::Sockets
         }
     }
 
+    void ServerSocket::adopt(const PlatformSocket listener, const SocketConfig& config)
+    {
+        _sock = listener;
+        try
+        {
+            if (!isValid()) throw Exception("invalid listener");
+            if (!Net::optionBool(_sock, AcceptConnection))
+                throw Exception("the adopted socket is not listening");
+
+            setFamily(Net::Utils::addressFamily(_sock));
+            setType(SocketStream);
+            setProtocol(family() == AddressFamilyINet ? ProtocolIpTcp : ProtocolUnknown);
+
+            // Bound and listening already, so only the
+            // per-connection options are applied here.
+            setBlocking(false);
+            configure(config);
+            start();
+        }
+        catch (Exception& ex)
+        {
+            Console::println(ex.what());
+            close();
+        }
+    }
+
     void ServerSocket::start()
     {
         if (!_main)
@@ -88,7 +135,10 @@ namespace Rt2::Sockets
     void ServerSocket::destroy()
     {
         if (_main)
+        {
+            _main->shutdown();
             _main->stop();
+        }
         delete _main;
         _main = nullptr;
     }
@@ -112,6 +162,29 @@ namespace Rt2::Sockets
     void ServerSocket::stop()
     {
         _running = false;
+        if (_main)
+            _main->shutdown();
+    }
+
+    void ServerSocket::stopOn(ExitSignal& signal)
+    {
+        RT_GUARD_CHECK_VOID(_main)
+        _main->watch(signal);
+    }
+
+    void ServerSocket::setDrainTimeout(const int ms)
+    {
+        RT_GUARD_CHECK_VOID(_main)
+        _main->setDrainTimeout(ms);
+    }
+
+    bool ServerSocket::handOff(const String& path, const int timeout)
+    {
+        RT_GUARD_CHECK_RET(_main, false)
+        if (!ListenerHandoff::offer(path, _sock, timeout))
+            return false;
+        stop();
+        return true;
     }
 
     void ServerSocket::connect(const Accept& onAccept)
@@ -21,12 +21,14 @@
 */
 #pragma once
 #include <functional>
+#include "Sockets/ListenerHandoff.h"
 #include "Sockets/Socket.h"
 #include "Thread/SharedValue.h"
 
 namespace Rt2::Sockets
 {
     class ServerThread;
+    class ExitSignal;
     using Accept = std::function<void(const PlatformSocket& con)>;
     using Update = std::function<void()>;
 
@@ -38,20 +40,39 @@ namespace Rt2::Sockets
         bool          _running{false};
 
     public:
-        ServerSocket(const String& ipv4, uint16_t port, uint16_t backlog = 0x100);
+        ServerSocket(const String& ipv4, uint16_t port, const SocketConfig& config = {});
+        ServerSocket(const String& ipv4, uint16_t port, int32_t backlog);
+
+        // Serves an already listening socket, such as one from
+        // ListenerHandoff, and takes ownership of it.
+        explicit ServerSocket(PlatformSocket listener, const SocketConfig& config = {});
         ~ServerSocket() override;
 
         void run();
         void run(const Update& up);
 
+        // Stops accepting at once and lets run return; connections
+        // already accepted are drained when the server is destroyed.
         void stop();
 
+        // Stops the server when the signal fires, from its own loop.
+        void stopOn(ExitSignal& signal);
+
+        void setDrainTimeout(int ms);
+
+        // Passes the listener to a new process waiting in
+        // ListenerHandoff::take, then stops so run returns and
+        // the accepted connections drain.
+        bool handOff(const String& path, int timeout = Default::HandoffTimeOut);
+
         void connect(const Accept& onAccept);
 
         Accept accept();
 
     private:
-        void open(const String& ipv4, uint16_t port, uint16_t backlog);
+        void open(const String& ipv4, uint16_t port, const SocketConfig& config);
+
+        void adopt(PlatformSocket listener, const SocketConfig& config);
 
         void start();
 
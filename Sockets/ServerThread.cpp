@@ -20,7 +20,11 @@
 -------------------------------------------------------------------------------
 */
 #include "Sockets/ServerThread.h"
+#include <chrono>
+#include "Sockets/ExitSignal.h"
+#include "Sockets/Metrics.h"
 #include "Sockets/ServerSocket.h"
+#include "Sockets/Trace.h"
 
 namespace Rt2::Sockets
 {
@@ -39,38 +43,126 @@ namespace Rt2::Sockets
 
     void ServerThread::update()
     {
-        int n = 0, m = 0;
-        while (isRunning())
+        _stamped = Net::optionBool(socket(), ReceiveTimestamp);
+
+        if (!_loop.isValid() ||
+            !_loop.add(socket(), EventRead, [this](int)
+                       { acceptPending(); }))
         {
-            if (Net::poll(socket(), 0, Read))
+            // without a loop, fall back to polling the listener
+            while (isRunning() && !_stopping)
             {
-                Connection client;
-                if (const PlatformSocket sock = Net::accept(socket(), client);
-                    sock != InvalidSocket)
-                {
-                    // clang-format off
-                    Thread::StandardThread
-                    {
-                        [&n](const Accept& accept, const PlatformSocket& s)
-                        {
-                            if (accept)  accept(s);
-                            Net::close(s);
-                            --n;
-                        },
-                        _owner->accept(),
-                        sock,
-                    }.detach();
-                    // clang-format on
-                    ++n;
-                }
+                if (Net::poll(socket(), Default::LoopTimeOut, Read))
+                    acceptPending();
             }
         }
+        else
+        {
+            while (isRunning() && !_stopping)
+                _loop.poll();
+            _loop.remove(socket());
+        }
+
+        drain();
+    }
+
+    void ServerThread::drain() const
+    {
+        using Clock = std::chrono::steady_clock;
 
-        while (n > 0 && m < 100)
+        const auto end = Clock::now() + std::chrono::milliseconds(_drain.load());
+        while (*_active > 0 && Clock::now() < end)
+            Thread::Thread::sleep(1);
+        RT_GUARD_CHECK_VOID(*_active == 0)
+    }
+
+    void ServerThread::shutdown()
+    {
+        _stopping = true;
+        _loop.wake();
+    }
+
+    void ServerThread::watch(ExitSignal& signal)
+    {
+        RT_GUARD_CHECK_VOID(signal.handle() != InvalidSocket)
+
+        _loop.post(
+            [this, &signal]
+            {
+                _loop.add(signal.handle(),
+                          EventRead,
+                          [this, &signal](int)
+                          {
+                              // the handle stays readable, so it is
+                              // dropped here rather than drained
+                              _loop.remove(signal.handle());
+                              signal.dispatch();
+                              _stopping = true;
+                              _owner->stop();
+                          });
+            });
+    }
+
+    void ServerThread::acceptPending()
+    {
+        // Drain as much of the backlog as one wake-up allows. The
+        // listening socket is non-blocking, so an empty queue ends the
+        // loop instead of stalling it.
+        for (int i = 0; i < Default::AcceptBatch; ++i)
         {
-            Thread::Thread::sleep(10);
-            ++m;
+            // only read the clock when some connection may be traced
+            const Trace::Tick accepting = Trace::sampleRate() != 0 ? Metrics::now() : 0;
+
+            Connection           client;
+            const PlatformSocket sock = Net::accept(
+                socket(),
+                client,
+                AcceptNonBlocking | AcceptCloseOnExec);
+
+            if (sock == InvalidSocket)
+                break;
+            dispatch(sock, accepting);
         }
-        RT_GUARD_CHECK_VOID(n == 0 && m == 0)
+    }
+
+    void ServerThread::dispatch(const PlatformSocket& sock, const int64_t accepting)
+    {
+        ++*_active;
+
+        const uint64_t    traced = accepting != 0 ? Trace::sample() : 0;
+        const Trace::Tick queued = traced != 0 ? Metrics::now() : 0;
+        Trace::record(TraceAccept, traced, accepting, queued);
+
+        // Zero unless the listener stamps receives and metrics are on.
+        const int64_t accepted = _stamped && Metrics::enabled()
+                                     ? RecvTimestamp::now()
+                                     : 0;
+
+        // The count is shared with the handler, so one that outlives
+        // the drain timeout does not touch a deleted thread.
+        // clang-format off
+        Thread::StandardThread
+        {
+            [](const Accept& accept, const PlatformSocket& s, const Counter& active, const int64_t accepted, const uint64_t traced, const int64_t queued)
+            {
+                {
+                    const TraceScope scope(traced, queued);
+
+                    // the handler's first read records the first byte
+                    Net::markAccepted(s, accepted);
+                    if (accept)  accept(s);
+                    Net::markAccepted(s, 0);
+                }
+                Net::close(s);
+                --*active;
+            },
+            _owner->accept(),
+            sock,
+            _active,
+            accepted,
+            traced,
+            queued,
+        }.detach();
+        // clang-format on
     }
 }  // namespace Rt2::Sockets
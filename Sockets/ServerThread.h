@@ -20,25 +20,69 @@
 -------------------------------------------------------------------------------
 */
 #pragma once
+#include <atomic>
+#include <memory>
+#include "Sockets/EventLoop.h"
 #include "Sockets/Socket.h"
 #include "Thread/Runner.h"
 
 namespace Rt2::Sockets
 {
     class ServerSocket;
+    class ExitSignal;
 
+    namespace Default
+    {
+        constexpr int DrainTimeOut = 1000;
+    }  // namespace Default
+
+    // Waits on an EventLoop holding the listener and, optionally, an
+    // ExitSignal. Shutdown stops accepting at once, then gives the
+    // connections already handed off up to the drain timeout to end.
     class ServerThread final : public Thread::Runner
     {
     private:
-        ServerSocket* _owner{nullptr};
+        using Counter = std::shared_ptr<std::atomic<int>>;
+
+        ServerSocket*     _owner{nullptr};
+        EventLoop         _loop;
+        Counter           _active{std::make_shared<std::atomic<int>>(0)};
+        std::atomic<bool> _stopping{false};
+        std::atomic<int>  _drain{Default::DrainTimeOut};
+        bool              _stamped{false};
 
     private:
         void update() override;
 
+        void acceptPending();
+
+        void dispatch(const PlatformSocket& sock, int64_t accepting);
+
+        void drain() const;
+
     public:
         explicit ServerThread(ServerSocket* owner);
 
         const PlatformSocket& socket() const;
+
+        // Safe from any thread, including a signal watcher.
+        void shutdown();
+
+        void watch(ExitSignal& signal);
+
+        void setDrainTimeout(int ms);
+
+        int active() const;
     };
 
+    inline void ServerThread::setDrainTimeout(const int ms)
+    {
+        _drain = ms;
+    }
+
+    inline int ServerThread::active() const
+    {
+        return _active->load();
+    }
+
 }  // namespace Rt2::Sockets
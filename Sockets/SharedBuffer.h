@@ -0,0 +1,89 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#pragma once
+#include <memory>
+#include <string_view>
+#include "Utils/String.h"
+
+namespace Rt2::Sockets
+{
+    // Immutable, reference counted bytes. Copies share one allocation,
+    // so a payload queued on many connections is stored once.
+    class SharedBuffer
+    {
+    private:
+        std::shared_ptr<const String> _data;
+
+    public:
+        SharedBuffer() = default;
+
+        explicit SharedBuffer(String&& data);
+
+        static SharedBuffer copy(std::string_view data);
+
+        const char* data() const;
+
+        size_t size() const;
+
+        bool empty() const;
+
+        std::string_view view() const;
+
+        long useCount() const;
+    };
+
+    inline SharedBuffer::SharedBuffer(String&& data) :
+        _data(std::make_shared<const String>(std::move(data)))
+    {
+    }
+
+    inline SharedBuffer SharedBuffer::copy(const std::string_view data)
+    {
+        return SharedBuffer(String(data));
+    }
+
+    inline const char* SharedBuffer::data() const
+    {
+        return _data ? _data->data() : nullptr;
+    }
+
+    inline size_t SharedBuffer::size() const
+    {
+        return _data ? _data->size() : 0;
+    }
+
+    inline bool SharedBuffer::empty() const
+    {
+        return size() == 0;
+    }
+
+    inline std::string_view SharedBuffer::view() const
+    {
+        return _data ? std::string_view(*_data) : std::string_view();
+    }
+
+    inline long SharedBuffer::useCount() const
+    {
+        return _data.use_count();
+    }
+
+}  // namespace Rt2::Sockets
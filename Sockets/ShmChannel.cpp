@@ -0,0 +1,641 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#include "Sockets/ShmChannel.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <new>
+#include <thread>
+#include "Sockets/Ipv4.h"
+#if RT_PLATFORM != RT_PLATFORM_WINDOWS
+    #include <poll.h>
+    #include <unistd.h>
+#endif
+#ifdef __linux__
+    #include <sys/eventfd.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+#endif
+
+namespace Rt2::Sockets
+{
+    // Lives at the start of each ring. The indices sit on their own
+    // cache lines so the two sides do not write to the same line.
+    struct ShmRingHeader
+    {
+        alignas(64) std::atomic<uint64_t> head{0};  // written by the producer
+        alignas(64) std::atomic<uint64_t> tail{0};  // written by the consumer
+        alignas(64) std::atomic<uint32_t> readerWaiting{0};
+        std::atomic<uint32_t> writerWaiting{0};
+        std::atomic<uint32_t> closed{0};
+        uint64_t              capacity{0};
+    };
+
+    namespace
+    {
+        using Clock = std::chrono::steady_clock;
+
+        constexpr char Shared   = 'S';
+        constexpr char Fallback = 'F';
+        constexpr char Receipt  = 'A';
+
+        // the memfd, then ready and space for each ring
+        constexpr int Handles = 5;
+
+        int remaining(const Clock::time_point& end)
+        {
+            const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+                end - Clock::now());
+            return std::max(0, (int)left.count());
+        }
+
+        void relax()
+        {
+#if defined(__x86_64__) || defined(__i386__)
+            __builtin_ia32_pause();
+#endif
+        }
+
+        void signal(const int event)
+        {
+#ifdef __linux__
+            if (event >= 0)
+                (void)eventfd_write(event, 1);
+#else
+            (void)event;
+#endif
+        }
+
+        void closeHandle(int& fd)
+        {
+#if RT_PLATFORM != RT_PLATFORM_WINDOWS
+            if (fd >= 0)
+                ::close(fd);
+#endif
+            fd = -1;
+        }
+    }  // namespace
+
+    size_t SpscRing::footprint(const size_t capacity)
+    {
+        return sizeof(ShmRingHeader) + ((capacity + 63) & ~(size_t)63);
+    }
+
+    void SpscRing::create(void* base, const size_t capacity)
+    {
+        RT_GUARD_CHECK_VOID(base && capacity && (capacity & (capacity - 1)) == 0)
+        _header           = new (base) ShmRingHeader();
+        _header->capacity = capacity;
+
+        _data = (char*)base + sizeof(ShmRingHeader);
+        _mask = capacity - 1;
+    }
+
+    void SpscRing::attach(void* base)
+    {
+        RT_GUARD_CHECK_VOID(base)
+        _header = (ShmRingHeader*)base;
+        _data   = (char*)base + sizeof(ShmRingHeader);
+        _mask   = (size_t)_header->capacity - 1;
+    }
+
+    size_t SpscRing::capacity() const
+    {
+        return _mask + 1;
+    }
+
+    size_t SpscRing::available() const
+    {
+        return (size_t)(_header->head.load() - _header->tail.load(std::memory_order_relaxed));
+    }
+
+    size_t SpscRing::space() const
+    {
+        return capacity() - (size_t)(_header->head.load(std::memory_order_relaxed) -
+                                     _header->tail.load());
+    }
+
+    size_t SpscRing::write(const char* src, const size_t size)
+    {
+        const uint64_t head = _header->head.load(std::memory_order_relaxed);
+        const size_t   n    = std::min(size, space());
+        if (n == 0)
+            return 0;
+
+        const size_t at    = (size_t)head & _mask;
+        const size_t first = std::min(n, capacity() - at);
+        memcpy(_data + at, src, first);
+        memcpy(_data, src + first, n - first);
+
+        // sequentially consistent so that the load of the waiting flag
+        // that follows cannot move ahead of it
+        _header->head.store(head + n);
+        return n;
+    }
+
+    size_t SpscRing::read(char* dest, const size_t size)
+    {
+        const uint64_t tail = _header->tail.load(std::memory_order_relaxed);
+        const size_t   n    = std::min(size, available());
+        if (n == 0)
+            return 0;
+
+        const size_t at    = (size_t)tail & _mask;
+        const size_t first = std::min(n, capacity() - at);
+        memcpy(dest, _data + at, first);
+        memcpy(dest + first, _data, n - first);
+
+        _header->tail.store(tail + n);
+        return n;
+    }
+
+    void SpscRing::close()
+    {
+        _header->closed.store(1);
+    }
+
+    bool SpscRing::isClosed() const
+    {
+        return _header->closed.load() != 0;
+    }
+
+    ShmChannel::ShmChannel() :
+        _spin(std::thread::hardware_concurrency() > 1 ? Default::ShmSpin : 0)
+    {
+    }
+
+    ShmChannel::ShmChannel(const PlatformSocket sock) :
+        ShmChannel()
+    {
+        _sock = sock;
+    }
+
+    ShmChannel::~ShmChannel()
+    {
+        close();
+    }
+
+    void ShmChannel::close()
+    {
+#ifdef __linux__
+        if (_map)
+        {
+            _out.close();
+            signal(_outReady);
+
+            munmap(_map, _mapSize);
+            _map     = nullptr;
+            _mapSize = 0;
+        }
+#endif
+        closeHandle(_inReady);
+        closeHandle(_inSpace);
+        closeHandle(_outReady);
+        closeHandle(_outSpace);
+
+        if (_sock != InvalidSocket)
+        {
+            Net::close(_sock);
+            _sock = InvalidSocket;
+        }
+    }
+
+    Status ShmChannel::wait(const int event, const int timeout)
+    {
+#ifdef __linux__
+        // after the handshake nothing else is sent on the socket, so it
+        // only becomes readable when the peer goes away
+        pollfd fds[2] = {
+            {event, POLLIN, 0},
+            {_sock,  POLLIN, 0},
+        };
+
+        int rc;
+        do
+        {
+            rc = ::poll(fds, 2, timeout);
+        } while (rc < 0 && errno == EINTR);
+
+        if (rc < 0)
+        {
+            Net::Error::record(OpPoll);
+            return ErrorStatus;
+        }
+        if (fds[0].revents & POLLIN)
+        {
+            eventfd_t drained;
+            (void)eventfd_read(event, &drained);
+            return OkStatus;
+        }
+        if (fds[1].revents)
+            return ClosedStatus;
+        return TimeoutStatus;
+#else
+        (void)event;
+        (void)timeout;
+        return ErrorStatus;
+#endif
+    }
+
+    Status ShmChannel::write(const char* data, const size_t size, const int timeout)
+    {
+        RT_GUARD_CHECK_RET(data || size == 0, ErrorStatus)
+        if (_sock == InvalidSocket)
+            return ErrorStatus;
+
+        if (!isShared())
+        {
+            size_t sent = 0;
+            while (sent < size)
+            {
+                const size_t chunk = std::min(size - sent, (size_t)MaxBufferSize - 1);
+                if (Net::writeSocket(_sock, data + sent, chunk, timeout) != (int)chunk)
+                    return ErrorStatus;
+                sent += chunk;
+            }
+            return OkStatus;
+        }
+
+        const auto     end    = Clock::now() + std::chrono::milliseconds(timeout);
+        ShmRingHeader* header = _out.header();
+
+        size_t sent = 0;
+        while (sent < size)
+        {
+            if (const size_t n = _out.write(data + sent, size - sent); n > 0)
+            {
+                sent += n;
+                if (header->readerWaiting.load())
+                    signal(_outReady);
+                continue;
+            }
+
+            for (int i = 0; i < _spin && _out.space() == 0; ++i)
+                relax();
+            if (_out.space() > 0)
+                continue;
+
+            // announce the wait, then look again; the reader stores its
+            // tail before it loads this flag, so one of the two sees
+            // the other
+            header->writerWaiting.store(1);
+            Status st = OkStatus;
+            if (_out.space() == 0)
+                st = wait(_outSpace, remaining(end));
+            header->writerWaiting.store(0);
+
+            if (st == ClosedStatus || st == ErrorStatus)
+                return st;
+            if (st == TimeoutStatus && _out.space() == 0)
+                return TimeoutStatus;
+        }
+        return OkStatus;
+    }
+
+    Status ShmChannel::write(const String& msg, const int timeout)
+    {
+        return write(msg.data(), msg.size(), timeout);
+    }
+
+    Status ShmChannel::receive(char*        dest,
+                               const size_t size,
+                               size_t&      received,
+                               const int    timeout)
+    {
+        RT_GUARD_CHECK_RET(dest && size > 0, ErrorStatus)
+        received = 0;
+        if (_sock == InvalidSocket)
+            return ErrorStatus;
+
+        if (!isShared())
+        {
+            int        br = 0;
+            const auto st = Net::receive(_sock,
+                                         dest,
+                                         (int)std::min(size, (size_t)MaxBufferSize - 1),
+                                         br,
+                                         timeout);
+            received      = (size_t)br;
+            return st;
+        }
+
+        const auto     end    = Clock::now() + std::chrono::milliseconds(timeout);
+        ShmRingHeader* header = _in.header();
+        for (;;)
+        {
+            // the closed flag is read first: everything written before
+            // it was set is then visible to the read that follows
+            const bool closed = _in.isClosed();
+            if (const size_t n = _in.read(dest, size); n > 0)
+            {
+                received = n;
+                if (header->writerWaiting.load())
+                    signal(_inSpace);
+                return OkStatus;
+            }
+            if (closed)
+                return ClosedStatus;
+
+            for (int i = 0; i < _spin && _in.available() == 0 && !_in.isClosed(); ++i)
+                relax();
+            if (_in.available() > 0 || _in.isClosed())
+                continue;
+
+            header->readerWaiting.store(1);
+            Status st = OkStatus;
+            if (_in.available() == 0 && !_in.isClosed())
+                st = wait(_inReady, remaining(end));
+            header->readerWaiting.store(0);
+
+            if (_in.available() > 0 || _in.isClosed())
+                continue;
+            if (st != OkStatus)
+                return st;
+        }
+    }
+
+    bool ShmChannel::readExactly(String& dest, const size_t n, const int timeout)
+    {
+        const auto end = Clock::now() + std::chrono::milliseconds(timeout);
+
+        dest.resize(n);
+        size_t have = 0;
+        while (have < n)
+        {
+            size_t got = 0;
+            if (receive(dest.data() + have, n - have, got, remaining(end)) != OkStatus)
+            {
+                dest.resize(have);
+                return false;
+            }
+            have += got;
+        }
+        return true;
+    }
+
+    Status ShmChannel::join(const int timeout)
+    {
+#ifdef __linux__
+        const auto end = Clock::now() + std::chrono::milliseconds(timeout);
+
+        int handles[Handles];
+        std::fill_n(handles, Handles, -1);
+
+        bool received = true;
+        for (int& handle : handles)
+        {
+            PlatformSocket fd = InvalidSocket;
+            if (Net::receiveHandle(_sock, fd, remaining(end)) != OkStatus)
+            {
+                received = false;
+                break;
+            }
+            handle = fd;
+        }
+
+        struct stat st{};
+        void*       map  = MAP_FAILED;
+        size_t      size = 0;
+        if (received && fstat(handles[0], &st) == 0 && st.st_size > 0)
+        {
+            size = (size_t)st.st_size;
+            map  = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, handles[0], 0);
+        }
+        closeHandle(handles[0]);
+
+        if (map != MAP_FAILED)
+        {
+            // the listener's first ring is its output, so it is this
+            // side's input
+            _in.attach(map);
+            const size_t ring = SpscRing::footprint(_in.capacity());
+            if (_in.capacity() > 1 && (_in.capacity() & (_in.capacity() - 1)) == 0 && 2 * ring == size)
+            {
+                _out.attach((char*)map + ring);
+                if (_out.capacity() == _in.capacity() &&
+                    Net::writeSocket(_sock, &Receipt, 1, remaining(end)) == 1)
+                {
+                    _map      = map;
+                    _mapSize  = size;
+                    _inReady  = handles[1];
+                    _inSpace  = handles[2];
+                    _outReady = handles[3];
+                    _outSpace = handles[4];
+                    return OkStatus;
+                }
+            }
+            munmap(map, size);
+        }
+
+        for (int& handle : handles)
+            closeHandle(handle);
+        _in  = {};
+        _out = {};
+        return ErrorStatus;
+#else
+        (void)timeout;
+        return ErrorStatus;
+#endif
+    }
+
+    bool ShmChannel::offer(const bool shared, const int timeout)
+    {
+        const auto end = Clock::now() + std::chrono::milliseconds(timeout);
+#ifdef __linux__
+        const size_t ring = SpscRing::footprint(Default::ShmRingSize);
+        const size_t size = 2 * ring;
+
+        int handles[Handles];
+        std::fill_n(handles, Handles, -1);
+
+        void* map = MAP_FAILED;
+        bool  ok  = false;
+        if (shared)
+        {
+            handles[0] = memfd_create("rt2-shm", MFD_CLOEXEC);
+            if (handles[0] >= 0 && ftruncate(handles[0], (off_t)size) == 0)
+                map = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, handles[0], 0);
+
+            ok = map != MAP_FAILED;
+            for (int i = 1; ok && i < Handles; ++i)
+            {
+                handles[i] = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+                ok         = handles[i] >= 0;
+            }
+        }
+
+        if (!ok)
+        {
+            // nothing has been sent yet, so the peer can still be
+            // told to stay on the socket
+            if (map != MAP_FAILED)
+                munmap(map, size);
+            for (int& handle : handles)
+                closeHandle(handle);
+            return Net::writeSocket(_sock, &Fallback, 1, remaining(end)) == 1;
+        }
+
+        _out.create(map, Default::ShmRingSize);
+        _in.create((char*)map + ring, Default::ShmRingSize);
+
+        ok = Net::writeSocket(_sock, &Shared, 1, remaining(end)) == 1;
+        for (int i = 0; ok && i < Handles; ++i)
+            ok = Net::sendHandle(_sock, handles[i]) == OkStatus;
+
+        char ack = 0;
+        int  br  = 0;
+        if (ok)
+            ok = Net::receive(_sock, &ack, 1, br, remaining(end)) == OkStatus && ack == Receipt;
+
+        // the mapping keeps the memory alive
+        closeHandle(handles[0]);
+        if (ok)
+        {
+            _map      = map;
+            _mapSize  = size;
+            _outReady = handles[1];
+            _outSpace = handles[2];
+            _inReady  = handles[3];
+            _inSpace  = handles[4];
+            return true;
+        }
+
+        munmap(map, size);
+        for (int& handle : handles)
+            closeHandle(handle);
+        _in  = {};
+        _out = {};
+        return false;
+#else
+        (void)shared;
+        return Net::writeSocket(_sock, &Fallback, 1, remaining(end)) == 1;
+#endif
+    }
+
+    Status ShmChannel::connect(const String& path, const int timeout)
+    {
+        close();
+
+        const auto end = Clock::now() + std::chrono::milliseconds(timeout);
+
+        _sock = Net::create(AddressFamilyUnix, SocketStream);
+        if (_sock == InvalidSocket)
+            return ErrorStatus;
+        Net::Utils::setCloseOnExec(_sock, true);
+
+        if (Net::connectLocal(_sock, path) != OkStatus)
+        {
+            close();
+            return ErrorStatus;
+        }
+
+        char mode = 0;
+        int  br   = 0;
+        if (Net::receive(_sock, &mode, 1, br, remaining(end)) != OkStatus ||
+            (mode != Shared && mode != Fallback))
+        {
+            close();
+            return ErrorStatus;
+        }
+
+        if (mode == Shared && join(remaining(end)) != OkStatus)
+        {
+            close();
+            return ErrorStatus;
+        }
+        return OkStatus;
+    }
+
+    Status ShmChannel::connect(const String&  ipv4,
+                               const uint16_t port,
+                               const String&  path,
+                               const int      timeout)
+    {
+        if (Ipv4 address; Ipv4::parse(ipv4, address) && address.octet(0) == 127)
+        {
+            if (connect(path, timeout) == OkStatus)
+                return OkStatus;
+        }
+
+        close();
+        _sock = Net::create(AddressFamilyINet, SocketStream, ProtocolIpTcp);
+        if (_sock == InvalidSocket)
+            return ErrorStatus;
+
+        Net::Utils::setCloseOnExec(_sock, true);
+        (void)Net::setOption(_sock, NoDelay, 1);
+        if (Net::connect(_sock, ipv4, port) != OkStatus)
+        {
+            close();
+            return ErrorStatus;
+        }
+        return OkStatus;
+    }
+
+    ShmListener::ShmListener(const String& path, const int32_t backlog) :
+        _path(path)
+    {
+        _sock = Net::create(AddressFamilyUnix, SocketStream);
+        if (_sock == InvalidSocket)
+            return;
+        Net::Utils::setCloseOnExec(_sock, true);
+
+#if RT_PLATFORM != RT_PLATFORM_WINDOWS
+        // a stale path from an earlier run would fail the bind
+        unlink(_path.c_str());
+#endif
+        if (Net::bindLocal(_sock, _path) != OkStatus || Net::listen(_sock, backlog) != OkStatus)
+        {
+            Net::close(_sock);
+            _sock = InvalidSocket;
+        }
+    }
+
+    ShmListener::~ShmListener()
+    {
+        if (_sock != InvalidSocket)
+        {
+            Net::close(_sock);
+#if RT_PLATFORM != RT_PLATFORM_WINDOWS
+            unlink(_path.c_str());
+#endif
+        }
+    }
+
+    ShmChannelPtr ShmListener::accept(const int timeout)
+    {
+        if (_sock == InvalidSocket || !Net::poll(_sock, timeout, Read))
+            return nullptr;
+
+        const PlatformSocket peer = Net::accept(_sock);
+        if (peer == InvalidSocket)
+            return nullptr;
+        Net::Utils::setCloseOnExec(peer, true);
+
+        auto channel = std::make_unique<ShmChannel>(peer);
+        if (!channel->offer(_shared, timeout))
+            return nullptr;
+        return channel;
+    }
+
+}  // namespace Rt2::Sockets
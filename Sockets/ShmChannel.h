@@ -0,0 +1,223 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#pragma once
+#include <memory>
+#include "Sockets/PlatformSocket.h"
+
+namespace Rt2::Sockets
+{
+    namespace Default
+    {
+        constexpr size_t  ShmRingSize = 0x100000;
+        constexpr int     ShmSpin     = 0x800;
+        constexpr int32_t ShmBacklog  = 0x80;
+    }  // namespace Default
+
+    struct ShmRingHeader;
+
+    // Single producer, single consumer byte ring in memory that both
+    // processes map. Each side only advances its own index, so the
+    // indices are the only synchronization; the capacity is a power
+    // of two and the indices run freely.
+    class SpscRing
+    {
+    private:
+        ShmRingHeader* _header{nullptr};
+        char*          _data{nullptr};
+        size_t         _mask{0};
+
+    public:
+        SpscRing() = default;
+
+        // Bytes of shared memory a ring of capacity bytes occupies.
+        static size_t footprint(size_t capacity);
+
+        // Initializes a ring at base. capacity is a power of two.
+        void create(void* base, size_t capacity);
+
+        // Attaches to a ring the other side created at base.
+        void attach(void* base);
+
+        // Producer side: copies what fits and returns the count.
+        size_t write(const char* src, size_t size);
+
+        // Consumer side: copies what is available and returns the count.
+        size_t read(char* dest, size_t size);
+
+        size_t capacity() const;
+
+        size_t available() const;
+
+        size_t space() const;
+
+        // Marks the end of the stream; the consumer reads what is left.
+        void close();
+
+        bool isClosed() const;
+
+        ShmRingHeader* header() const;
+    };
+
+    // Byte stream to a peer on the same host. A Unix socket carries the
+    // handshake and stays open so either side notices the other exit,
+    // while the data moves through a shared ring in each direction.
+    // Waiting sides spin briefly, then sleep on an eventfd the other
+    // side only writes when told someone is asleep, so a busy stream
+    // makes no system calls at all.
+    //
+    // When shared memory is not available, or the peer is on another
+    // host, the same calls go through the socket instead.
+    class ShmChannel
+    {
+    private:
+        friend class ShmListener;
+
+        PlatformSocket _sock{InvalidSocket};
+        void*          _map{nullptr};
+        size_t         _mapSize{0};
+        SpscRing       _in;
+        SpscRing       _out;
+        int            _inReady{-1};
+        int            _inSpace{-1};
+        int            _outReady{-1};
+        int            _outSpace{-1};
+        int            _spin;
+
+        // Listener side of the handshake: sends the rings, or tells the
+        // peer to stay on the socket when shared is false or they
+        // cannot be set up.
+        bool offer(bool shared, int timeout);
+
+        Status join(int timeout);
+
+        Status wait(int event, int timeout);
+
+    public:
+        ShmChannel();
+
+        // Wraps a connected socket, of any family, as a plain channel.
+        explicit ShmChannel(PlatformSocket sock);
+
+        ~ShmChannel();
+
+        ShmChannel(const ShmChannel&)            = delete;
+        ShmChannel& operator=(const ShmChannel&) = delete;
+
+        // Connects to an ShmListener and maps its rings; the listener
+        // may decline, leaving the channel on the Unix socket.
+        Status connect(const String& path, int timeout = Default::SocketTimeOut);
+
+        // Uses path when ipv4 is a loopback address with a listener
+        // there, and TCP to ipv4:port otherwise.
+        Status connect(const String& ipv4,
+                       uint16_t      port,
+                       const String& path,
+                       int           timeout = Default::SocketTimeOut);
+
+        Status write(const char* data, size_t size, int timeout = Default::SocketTimeOut);
+
+        Status write(const String& msg, int timeout = Default::SocketTimeOut);
+
+        // Waits for data and copies out up to size bytes. ClosedStatus
+        // means the peer closed and everything has been read.
+        Status receive(char* dest, size_t size, size_t& received, int timeout = Default::SocketTimeOut);
+
+        bool readExactly(String& dest, size_t n, int timeout = Default::SocketTimeOut);
+
+        void close();
+
+        bool isValid() const;
+
+        // True when data moves through shared memory.
+        bool isShared() const;
+
+        // Polls before sleeping; zero sleeps at once, which is the
+        // default on a single processor where the peer cannot run
+        // while this side spins.
+        void setSpin(int iterations);
+
+        const PlatformSocket& socket() const;
+    };
+
+    using ShmChannelPtr = std::unique_ptr<ShmChannel>;
+
+    // Accepts ShmChannels on a Unix socket path.
+    class ShmListener
+    {
+    private:
+        PlatformSocket _sock{InvalidSocket};
+        String         _path;
+        bool           _shared{true};
+
+    public:
+        explicit ShmListener(const String& path, int32_t backlog = Default::ShmBacklog);
+        ~ShmListener();
+
+        ShmListener(const ShmListener&)            = delete;
+        ShmListener& operator=(const ShmListener&) = delete;
+
+        // Returns null when nothing connects in time.
+        ShmChannelPtr accept(int timeout = Default::SocketTimeOut);
+
+        // With false, accepted channels stay on the socket; kept so the
+        // two can be compared.
+        void setShared(bool shared);
+
+        bool isValid() const;
+    };
+
+    inline bool ShmChannel::isValid() const
+    {
+        return _sock != InvalidSocket;
+    }
+
+    inline bool ShmChannel::isShared() const
+    {
+        return _map != nullptr;
+    }
+
+    inline void ShmChannel::setSpin(const int iterations)
+    {
+        _spin = iterations;
+    }
+
+    inline const PlatformSocket& ShmChannel::socket() const
+    {
+        return _sock;
+    }
+
+    inline void ShmListener::setShared(const bool shared)
+    {
+        _shared = shared;
+    }
+
+    inline bool ShmListener::isValid() const
+    {
+        return _sock != InvalidSocket;
+    }
+
+    inline ShmRingHeader* SpscRing::header() const
+    {
+        return _header;
+    }
+
+}  // namespace Rt2::Sockets
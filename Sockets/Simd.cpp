@@ -0,0 +1,362 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#include "Sockets/Simd.h"
+#include <atomic>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    #define SOCKETS_SIMD_X86 1
+    #include <immintrin.h>
+    #if defined(__GNUC__)
+        // kernels are built for their own level whatever the baseline
+        #define SOCKETS_TARGET_SSE2 __attribute__((target("sse2")))
+        #define SOCKETS_TARGET_AVX2 __attribute__((target("avx2")))
+    #else
+        #if defined(_MSC_VER)
+            #include <intrin.h>
+        #endif
+        #define SOCKETS_TARGET_SSE2
+        #define SOCKETS_TARGET_AVX2
+    #endif
+#endif
+
+namespace Rt2::Sockets
+{
+    namespace
+    {
+        using FindChar   = const char* (*)(const char*, const char*, char);
+        using FindString = const char* (*)(const char*, const char*, const char*, size_t);
+        using MaskBytes  = void (*)(char*, size_t, uint32_t);
+
+        uint32_t lowestBit(const uint32_t mask)
+        {
+#if defined(_MSC_VER)
+            unsigned long idx = 0;
+            _BitScanForward(&idx, mask);
+            return (uint32_t)idx;
+#else
+            return (uint32_t)__builtin_ctz(mask);
+#endif
+        }
+
+        const char* findCharScalar(const char* begin, const char* end, const char ch)
+        {
+            for (; begin < end; ++begin)
+            {
+                if (*begin == ch)
+                    return begin;
+            }
+            return end;
+        }
+
+        // Compares the first and last byte of the needle first, which
+        // rejects nearly every position before a full compare is needed.
+        const char* findStringScalar(const char* begin, const char* end, const char* needle, const size_t n)
+        {
+            const char first = needle[0];
+            const char last  = needle[n - 1];
+            for (const char* p = begin; p + n <= end; ++p)
+            {
+                if (p[0] == first && p[n - 1] == last && memcmp(p, needle, n) == 0)
+                    return p;
+            }
+            return end;
+        }
+
+        // The key arrives already rotated to the starting offset and
+        // packed in memory order, so byte i pairs with key byte i % 4.
+        void maskScalar(char* data, const size_t size, const uint32_t key)
+        {
+            uint8_t bytes[4];
+            memcpy(bytes, &key, 4);
+
+            size_t i = 0;
+            for (; i + 4 <= size; i += 4)
+            {
+                uint32_t word;
+                memcpy(&word, data + i, 4);
+                word ^= key;
+                memcpy(data + i, &word, 4);
+            }
+            for (; i < size; ++i)
+                data[i] ^= (char)bytes[i & 3];
+        }
+
+#ifdef SOCKETS_SIMD_X86
+        SOCKETS_TARGET_SSE2 void maskSse2(char* data, const size_t size, const uint32_t key)
+        {
+            const __m128i pattern = _mm_set1_epi32((int)key);
+
+            size_t i = 0;
+            for (; i + 16 <= size; i += 16)
+            {
+                const __m128i block = _mm_loadu_si128((const __m128i*)(data + i));
+                _mm_storeu_si128((__m128i*)(data + i), _mm_xor_si128(block, pattern));
+            }
+            maskScalar(data + i, size - i, key);
+        }
+
+        SOCKETS_TARGET_AVX2 void maskAvx2(char* data, const size_t size, const uint32_t key)
+        {
+            const __m256i pattern = _mm256_set1_epi32((int)key);
+
+            size_t i = 0;
+            for (; i + 32 <= size; i += 32)
+            {
+                const __m256i block = _mm256_loadu_si256((const __m256i*)(data + i));
+                _mm256_storeu_si256((__m256i*)(data + i), _mm256_xor_si256(block, pattern));
+            }
+            maskSse2(data + i, size - i, key);
+        }
+
+        SOCKETS_TARGET_SSE2 const char* findCharSse2(const char* begin, const char* end, const char ch)
+        {
+            const __m128i pattern = _mm_set1_epi8(ch);
+
+            const char* p = begin;
+            for (; p + 16 <= end; p += 16)
+            {
+                const __m128i block = _mm_loadu_si128((const __m128i*)p);
+                if (const uint32_t mask = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(block, pattern)))
+                    return p + lowestBit(mask);
+            }
+            return findCharScalar(p, end, ch);
+        }
+
+        SOCKETS_TARGET_SSE2 const char* findStringSse2(const char* begin, const char* end, const char* needle, const size_t n)
+        {
+            const __m128i first = _mm_set1_epi8(needle[0]);
+            const __m128i last  = _mm_set1_epi8(needle[n - 1]);
+
+            const char* p = begin;
+            for (; p + n - 1 + 16 <= end; p += 16)
+            {
+                const __m128i a = _mm_loadu_si128((const __m128i*)p);
+                const __m128i b = _mm_loadu_si128((const __m128i*)(p + n - 1));
+
+                auto mask = (uint32_t)_mm_movemask_epi8(
+                    _mm_and_si128(_mm_cmpeq_epi8(a, first), _mm_cmpeq_epi8(b, last)));
+                while (mask)
+                {
+                    const uint32_t bit = lowestBit(mask);
+                    if (memcmp(p + bit, needle, n) == 0)
+                        return p + bit;
+                    mask &= mask - 1;
+                }
+            }
+            return findStringScalar(p, end, needle, n);
+        }
+
+        SOCKETS_TARGET_AVX2 const char* findCharAvx2(const char* begin, const char* end, const char ch)
+        {
+            const __m256i pattern = _mm256_set1_epi8(ch);
+
+            const char* p = begin;
+            for (; p + 32 <= end; p += 32)
+            {
+                const __m256i block = _mm256_loadu_si256((const __m256i*)p);
+                if (const uint32_t mask = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, pattern)))
+                    return p + lowestBit(mask);
+            }
+            return findCharSse2(p, end, ch);
+        }
+
+        SOCKETS_TARGET_AVX2 const char* findStringAvx2(const char* begin, const char* end, const char* needle, const size_t n)
+        {
+            const __m256i first = _mm256_set1_epi8(needle[0]);
+            const __m256i last  = _mm256_set1_epi8(needle[n - 1]);
+
+            const char* p = begin;
+            for (; p + n - 1 + 32 <= end; p += 32)
+            {
+                const __m256i a = _mm256_loadu_si256((const __m256i*)p);
+                const __m256i b = _mm256_loadu_si256((const __m256i*)(p + n - 1));
+
+                auto mask = (uint32_t)_mm256_movemask_epi8(
+                    _mm256_and_si256(_mm256_cmpeq_epi8(a, first), _mm256_cmpeq_epi8(b, last)));
+                while (mask)
+                {
+                    const uint32_t bit = lowestBit(mask);
+                    if (memcmp(p + bit, needle, n) == 0)
+                        return p + bit;
+                    mask &= mask - 1;
+                }
+            }
+            return findStringSse2(p, end, needle, n);
+        }
+
+        bool hasAvx2()
+        {
+    #if defined(_MSC_VER)
+            int info[4] = {};
+            __cpuid(info, 0);
+            if (info[0] < 7)
+                return false;
+            __cpuid(info, 1);
+            // the OS must save the ymm registers as well
+            if ((info[2] & (1 << 27)) == 0 || (_xgetbv(0) & 6) != 6)
+                return false;
+            __cpuidex(info, 7, 0);
+            return (info[1] & (1 << 5)) != 0;
+    #elif defined(__GNUC__)
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2");
+    #else
+            return false;
+    #endif
+        }
+
+        bool hasSse2()
+        {
+    #if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+            return true;
+    #elif defined(_MSC_VER)
+            int info[4] = {};
+            __cpuid(info, 1);
+            return (info[3] & (1 << 26)) != 0;
+    #elif defined(__GNUC__)
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("sse2");
+    #else
+            return false;
+    #endif
+        }
+#endif
+
+        Simd::Level detect()
+        {
+#ifdef SOCKETS_SIMD_X86
+            if (hasAvx2())
+                return Simd::Avx2;
+            return hasSse2() ? Simd::Sse2 : Simd::Scalar;
+#else
+            return Simd::Scalar;
+#endif
+        }
+
+        struct Kernels
+        {
+            std::atomic<Simd::Level> level{Simd::Scalar};
+            std::atomic<FindChar>    findChar{findCharScalar};
+            std::atomic<FindString>  findString{findStringScalar};
+            std::atomic<MaskBytes>   mask{maskScalar};
+
+            Kernels()
+            {
+                select(detect());
+            }
+
+            void select(const Simd::Level lvl)
+            {
+                switch (lvl)
+                {
+#ifdef SOCKETS_SIMD_X86
+                case Simd::Avx2:
+                    findChar   = findCharAvx2;
+                    findString = findStringAvx2;
+                    mask       = maskAvx2;
+                    break;
+                case Simd::Sse2:
+                    findChar   = findCharSse2;
+                    findString = findStringSse2;
+                    mask       = maskSse2;
+                    break;
+#endif
+                default:
+                    findChar   = findCharScalar;
+                    findString = findStringScalar;
+                    mask       = maskScalar;
+                    break;
+                }
+                level = lvl;
+            }
+        };
+
+        Kernels& kernels()
+        {
+            static Kernels inst;
+            return inst;
+        }
+    }  // namespace
+
+    Simd::Level Simd::level()
+    {
+        return kernels().level.load(std::memory_order_relaxed);
+    }
+
+    Simd::Level Simd::supported()
+    {
+        static const Level lvl = detect();
+        return lvl;
+    }
+
+    void Simd::setLevel(const Level level)
+    {
+        kernels().select(level < supported() ? level : supported());
+    }
+
+    const char* Simd::find(const char* begin, const char* end, const char ch)
+    {
+        RT_GUARD_RET(begin && begin < end, end)
+        return kernels().findChar.load(std::memory_order_relaxed)(begin, end, ch);
+    }
+
+    const char* Simd::find(const char* begin, const char* end, const std::string_view needle)
+    {
+        RT_GUARD_RET(begin && begin < end && !needle.empty(), end)
+
+        if (needle.size() == 1)
+            return find(begin, end, needle[0]);
+        if ((size_t)(end - begin) < needle.size())
+            return end;
+        return kernels().findString.load(std::memory_order_relaxed)(begin, end, needle.data(), needle.size());
+    }
+
+    void Simd::mask(char* data, const size_t size, const uint8_t key[4], const size_t offset)
+    {
+        RT_GUARD_VOID(data && key && size > 0)
+
+        uint32_t rotated = 0;
+        for (size_t i = 0; i < 4; ++i)
+            rotated |= (uint32_t)key[(offset + i) & 3] << (8 * i);
+
+    #if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        rotated = __builtin_bswap32(rotated);
+    #endif
+        kernels().mask.load(std::memory_order_relaxed)(data, size, rotated);
+    }
+
+    const char* Simd::toString(const Level level)
+    {
+        switch (level)
+        {
+        case Avx2:
+            return "avx2";
+        case Sse2:
+            return "sse2";
+        case Scalar:
+        default:
+            return "scalar";
+        }
+    }
+
+}  // namespace Rt2::Sockets
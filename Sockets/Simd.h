@@ -0,0 +1,86 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#pragma once
+#include <cstdint>
+#include <string_view>
+#include "Utils/Definitions.h"
+
+namespace Rt2::Sockets
+{
+    // Byte search kernels used by the line and token readers. The widest
+    // instruction set the processor supports is picked the first time one
+    // of the kernels runs; setLevel can lower it for testing.
+    class Simd
+    {
+    public:
+        enum Level
+        {
+            Scalar,
+            Sse2,
+            Avx2,
+        };
+
+        static Level level();
+
+        static Level supported();
+
+        static void setLevel(Level level);
+
+        // Returns a pointer to the first ch in [begin, end), or end.
+        static const char* find(const char* begin, const char* end, char ch);
+
+        // Returns a pointer to the first occurrence of needle in
+        // [begin, end), or end.
+        static const char* find(const char* begin, const char* end, std::string_view needle);
+
+        // XORs data with the repeating four byte key, starting at key
+        // byte offset % 4. Used to mask and unmask WebSocket payloads.
+        static void mask(char* data, size_t size, const uint8_t key[4], size_t offset = 0);
+
+        static size_t find(std::string_view haystack, char ch, size_t offset = 0);
+
+        static size_t find(std::string_view haystack, std::string_view needle, size_t offset = 0);
+
+        static const char* toString(Level level);
+    };
+
+    inline size_t Simd::find(const std::string_view haystack, const char ch, const size_t offset)
+    {
+        if (offset >= haystack.size())
+            return std::string_view::npos;
+
+        const char* end = haystack.data() + haystack.size();
+        const char* pos = find(haystack.data() + offset, end, ch);
+        return pos == end ? std::string_view::npos : (size_t)(pos - haystack.data());
+    }
+
+    inline size_t Simd::find(const std::string_view haystack, const std::string_view needle, const size_t offset)
+    {
+        if (offset >= haystack.size())
+            return std::string_view::npos;
+
+        const char* end = haystack.data() + haystack.size();
+        const char* pos = find(haystack.data() + offset, end, needle);
+        return pos == end ? std::string_view::npos : (size_t)(pos - haystack.data());
+    }
+
+}  // namespace Rt2::Sockets
@@ -147,6 +147,193 @@ namespace Rt2::Sockets
         Net::setOption(_sock, ReceiveTimeout, ms);
     }
 
+    void Socket::setNoDelay(const bool val) const
+    {
+        RT_GUARD_VOID(isValid() && _type == SocketStream)
+        Net::setOption(_sock, NoDelay, val);
+    }
+
+    bool Socket::noDelay() const
+    {
+        RT_GUARD_RET(isValid() && _type == SocketStream, false)
+        return Net::optionBool(_sock, NoDelay);
+    }
+
+    void Socket::setCork(const bool val) const
+    {
+        RT_GUARD_VOID(isValid() && _type == SocketStream)
+        Net::setOption(_sock, Cork, val);
+    }
+
+    bool Socket::isCorked() const
+    {
+        RT_GUARD_RET(isValid() && _type == SocketStream, false)
+        return Net::optionBool(_sock, Cork);
+    }
+
+    void Socket::setQuickAck(const bool val) const
+    {
+        // Linux clears this flag on its own as the connection moves in
+        // and out of interactive mode, so it needs to be reapplied after
+        // reads when it matters.
+        RT_GUARD_VOID(isValid() && _type == SocketStream)
+        Net::setOption(_sock, QuickAck, val);
+    }
+
+    void Socket::setFastOpen(const int queueLength) const
+    {
+        // Server side; must be set before listen.
+        RT_GUARD_VOID(isValid() && _type == SocketStream)
+        Net::setOption(_sock, FastOpen, queueLength);
+    }
+
+    void Socket::setFastOpenConnect(const bool val) const
+    {
+        // Client side; must be set before connect.
+        RT_GUARD_VOID(isValid() && _type == SocketStream)
+        Net::setOption(_sock, FastOpenConnect, val);
+    }
+
+    void Socket::setNotSentLowWater(const int bytes) const
+    {
+        RT_GUARD_VOID(isValid() && _type == SocketStream)
+        Net::setOption(_sock, NotSentLowWater, bytes);
+    }
+
+    int Socket::notSentLowWater() const
+    {
+        RT_GUARD_RET(isValid() && _type == SocketStream, 0)
+        return Net::optionInt(_sock, NotSentLowWater);
+    }
+
+    void Socket::setZeroCopy(const bool val) const
+    {
+        // Only permits MSG_ZEROCOPY sends; see ZeroCopySender.
+        RT_GUARD_VOID(isValid() && _type == SocketStream)
+        Net::setOption(_sock, ZeroCopy, val);
+    }
+
+    bool Socket::zeroCopy() const
+    {
+        RT_GUARD_RET(isValid() && _type == SocketStream, false)
+        return Net::optionBool(_sock, ZeroCopy);
+    }
+
+    void Socket::setKeepAliveProbes(const int idleSec,
+                                    const int intervalSec,
+                                    const int count) const
+    {
+        RT_GUARD_VOID(isValid() && _type == SocketStream)
+        Net::setOption(_sock, KeepAlive, true);
+        Net::setOption(_sock, KeepIdle, idleSec);
+        Net::setOption(_sock, KeepInterval, intervalSec);
+        Net::setOption(_sock, KeepCount, count);
+    }
+
+    void Socket::setUserTimeout(const int ms) const
+    {
+        RT_GUARD_VOID(isValid() && _type == SocketStream)
+        Net::setOption(_sock, UserTimeout, ms);
+    }
+
+    int Socket::userTimeout() const
+    {
+        RT_GUARD_RET(isValid() && _type == SocketStream, 0)
+        return Net::optionInt(_sock, UserTimeout);
+    }
+
+    void Socket::setBusyPoll(const int microseconds) const
+    {
+        // Lets a blocking receive poll the device queue instead of
+        // sleeping; loopback has no queue to poll, so it is a no-op there.
+        RT_GUARD_VOID(isValid())
+        Net::setOption(_sock, BusyPoll, microseconds);
+        Net::setOption(_sock, PreferBusyPoll, microseconds > 0);
+    }
+
+    int Socket::busyPoll() const
+    {
+        RT_GUARD_RET(isValid(), 0)
+        return Net::optionInt(_sock, BusyPoll);
+    }
+
+    void Socket::setReceiveTimestamps(const bool val) const
+    {
+        // Accepted connections inherit this from the listener.
+        RT_GUARD_VOID(isValid())
+        Net::setOption(_sock, ReceiveTimestamp, val);
+    }
+
+    bool Socket::receiveTimestamps() const
+    {
+        RT_GUARD_RET(isValid(), false)
+        return Net::optionBool(_sock, ReceiveTimestamp);
+    }
+
+    void Socket::applyProfile(const LatencyProfile profile) const
+    {
+        RT_GUARD_VOID(isValid() && _type == SocketStream)
+        switch (profile)
+        {
+        case ProfileLowLatency:
+            // Send small messages immediately, acknowledge right away,
+            // and keep the unsent queue shallow so that new messages do
+            // not wait behind stale ones.
+            setCork(false);
+            setNoDelay(true);
+            setQuickAck(true);
+            setNotSentLowWater(Default::LowLatencyNotSent);
+            break;
+        case ProfileBulkThroughput:
+            // Let Nagle and delayed acknowledgements coalesce segments,
+            // and leave the send queue depth to the kernel.
+            setCork(false);
+            setNoDelay(false);
+            setQuickAck(false);
+            setNotSentLowWater(Default::KernelNotSent);
+            break;
+        case ProfileDefault:
+        default:
+            setCork(false);
+            setNoDelay(false);
+            setNotSentLowWater(Default::KernelNotSent);
+            break;
+        }
+    }
+
+    void Socket::configure(const SocketConfig& config) const
+    {
+        RT_GUARD_VOID(isValid())
+
+        if (config.sendBufferSize > 0)
+            setMaxSendBuffer(config.sendBufferSize);
+        if (config.receiveBufferSize > 0)
+            setMaxReceiveBuffer(config.receiveBufferSize);
+
+        setSendTimeout(config.sendTimeout);
+        setReceiveTimeout(config.receiveTimeout);
+
+        if (config.keepAlive)
+        {
+            setKeepAlive(true);
+            if (config.keepIdle > 0)
+                Net::setOption(_sock, KeepIdle, config.keepIdle);
+            if (config.keepInterval > 0)
+                Net::setOption(_sock, KeepInterval, config.keepInterval);
+            if (config.keepCount > 0)
+                Net::setOption(_sock, KeepCount, config.keepCount);
+        }
+
+        if (config.profile != ProfileDefault)
+            applyProfile(config.profile);
+        if (config.zeroCopy)
+            setZeroCopy(true);
+        if (config.busyPoll > 0)
+            setBusyPoll(config.busyPoll);
+        if (config.receiveTimestamps)
+            setReceiveTimestamps(true);
+    }
+
     void Socket::close()
     {
         if (_sock != InvalidSocket)
@@ -21,6 +21,7 @@
 */
 #pragma once
 #include "Sockets/PlatformSocket.h"
+#include "Sockets/SocketConfig.h"
 
 namespace Rt2::Sockets
 {
@@ -77,6 +78,46 @@ namespace Rt2::Sockets
 
         int receiveTimeout() const;
 
+        void setNoDelay(bool val) const;
+
+        bool noDelay() const;
+
+        void setCork(bool val) const;
+
+        bool isCorked() const;
+
+        void setQuickAck(bool val) const;
+
+        void setFastOpen(int queueLength) const;
+
+        void setFastOpenConnect(bool val) const;
+
+        void setNotSentLowWater(int bytes) const;
+
+        int notSentLowWater() const;
+
+        void setKeepAliveProbes(int idleSec, int intervalSec, int count) const;
+
+        void setUserTimeout(int ms) const;
+
+        int userTimeout() const;
+
+        void setZeroCopy(bool val) const;
+
+        bool zeroCopy() const;
+
+        void setBusyPoll(int microseconds) const;
+
+        int busyPoll() const;
+
+        void setReceiveTimestamps(bool val) const;
+
+        bool receiveTimestamps() const;
+
+        void applyProfile(LatencyProfile profile) const;
+
+        void configure(const SocketConfig& config) const;
+
         const PlatformSocket& socket() const;
 
         const AddressFamily& family() const;
@@ -0,0 +1,78 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#pragma once
+#include "Sockets/PlatformSocket.h"
+
+namespace Rt2::Sockets
+{
+    struct SocketConfig
+    {
+        // Kernel buffer sizes in bytes. Zero leaves SO_SNDBUF and
+        // SO_RCVBUF untouched so the kernel can autotune them.
+        int sendBufferSize{0};
+        int receiveBufferSize{0};
+
+        // Blocking send and receive timeouts in milliseconds.
+        int sendTimeout{Default::SocketTimeOut};
+        int receiveTimeout{Default::SocketTimeOut};
+
+        // Keep-alive probing. Zero for any of the probe values keeps
+        // the system default for that value.
+        bool keepAlive{true};
+        int  keepIdle{0};
+        int  keepInterval{0};
+        int  keepCount{0};
+
+        LatencyProfile profile{ProfileDefault};
+
+        // Listen backlog for server sockets, zero sizes it from somaxconn.
+        int32_t backlog{Default::ListenBacklog};
+
+        // TCP fast open. For server sockets this is the pending queue
+        // length, for client sockets any non-zero value enables it.
+        int fastOpen{0};
+
+        // Permits MSG_ZEROCOPY sends where the platform has them.
+        bool zeroCopy{false};
+
+        // SO_BUSY_POLL in microseconds, with SO_PREFER_BUSY_POLL. Zero
+        // leaves both alone. Raising it past net.core.busy_read needs
+        // CAP_NET_ADMIN; see BusyPoller for spinning in user space.
+        int busyPoll{0};
+
+        // SO_TIMESTAMPNS. On a listener it also feeds the accept latency
+        // histograms from each handler's first read.
+        bool receiveTimestamps{false};
+
+        // The fixed buffer sizes used before the configuration existed.
+        static SocketConfig legacy();
+    };
+
+    inline SocketConfig SocketConfig::legacy()
+    {
+        SocketConfig config;
+        config.sendBufferSize    = (int)Default::IoBufferSize;
+        config.receiveBufferSize = (int)Default::IoBufferSize;
+        return config;
+    }
+
+}  // namespace Rt2::Sockets
@@ -20,9 +20,14 @@
 -------------------------------------------------------------------------------
 */
 #pragma once
+#include <cstring>
+#include <functional>
 #include <istream>
 #include <ostream>
+#include <string_view>
 #include "Sockets/PlatformSocket.h"
+#include "Sockets/Simd.h"
+#include "Sockets/Trace.h"
 #include "Utils/Streams/StreamBase.h"
 
 namespace Rt2::Sockets
@@ -31,6 +36,7 @@ namespace Rt2::Sockets
     {
         constexpr size_t ScratchSize = IoBufferSize;
         constexpr int    TimeOut     = SocketTimeOut;
+        constexpr size_t CompactSize = 0x10000;
     }  // namespace Default
 
 
@@ -88,6 +94,11 @@ namespace Rt2::Sockets
         }
     };
 
+    // Decides whether a complete message is buffered. It receives all
+    // of the unread bytes, and returns the length of the first complete
+    // message or zero when more data is needed.
+    using MessageComplete = std::function<size_t(const char* data, size_t size)>;
+
     class InputSocketStream final : public std::istream
     {
     public:
@@ -101,16 +112,33 @@ namespace Rt2::Sockets
         private:
             PlatformSocket _sock{InvalidSocket};
             BufferType     _buffer;
-            PointerType    _begin{nullptr};
-            PointerType    _end{nullptr};
-            std::streampos _total{0};
+            size_t         _read{0};
             Status         _status{OkStatus};
+            bool           _done{false};
+            bool           _closed{false};
             int            _timeout{Default::TimeOut};
             int            _scratch{Default::ScratchSize};
 
             bool canRead() const
             {
-                return _status == OkStatus;
+                return !_done && !_closed;
+            }
+
+            Status receive()
+            {
+                int br = 0;
+                _buffer.reserve(_buffer.size() + _scratch);
+
+                _status = Net::receive(_sock,
+                                       _buffer._end(),
+                                       _scratch,
+                                       br,
+                                       _timeout);
+
+                _buffer.resizeFast(_buffer.size() + br);
+                if (_status == ClosedStatus || _status == ErrorStatus)
+                    _closed = true;
+                return _status;
             }
 
             int_type readMore()
@@ -121,28 +149,17 @@ namespace Rt2::Sockets
                 if (_scratch < 16)  // bare bone minimum to read
                     return traits_type::eof();
 
-                int br = 0;
-                _buffer.reserve(_buffer.size() + _scratch);
-
-                _status = Net::readSocket(_sock,
-                                          _buffer._end(),
-                                          _scratch,
-                                          br,
-                                          _timeout);
-
-                _buffer.resizeFast(_buffer.size() + br);
-                if (br > 0)
-                {
-                    _begin = _buffer.begin() + _total;
-                    _end   = _begin + br;
-                    RT_ASSERT(_end <= _buffer.end())
-                    _total += br;
-                }
-                else
-                {
-                    _begin = _end = nullptr;
-                }
-                return br;
+                const Trace::Tick traced = Trace::start();
+                const size_t      before = _buffer.size();
+                receive();
+
+                // Without a framing rule a short read or a timeout is
+                // the only hint that the message has ended.
+                const size_t br = _buffer.size() - before;
+                Trace::record(TraceRead, traced, (int64_t)br);
+                if (_status != OkStatus || br < (size_t)_scratch)
+                    _done = true;
+                return (int_type)br;
             }
 
         public:
@@ -173,50 +190,109 @@ namespace Rt2::Sockets
                 _scratch = Clamp<int>((int)block, Default::ScratchSize, 0x7FFF);
             }
 
+            bool isClosed() const
+            {
+                return _closed;
+            }
+
+            Status status() const
+            {
+                return _status;
+            }
+
+            void resume()
+            {
+                _done = false;
+            }
+
+            size_t available() const
+            {
+                return _buffer.size() - _read;
+            }
+
+            const char* data() const
+            {
+                return _buffer.data() + _read;
+            }
+
+            void consume(size_t n)
+            {
+                n = n < available() ? n : available();
+                _read += n;
+
+                if (_read == _buffer.size())
+                {
+                    _read = 0;
+                    _buffer.resizeFast(0);
+                }
+                else if (_read >= Default::CompactSize)
+                {
+                    const size_t rem = available();
+                    memmove(_buffer.data(), data(), rem);
+                    _buffer.resizeFast(rem);
+                    _read = 0;
+                }
+            }
+
+            // Receives until complete reports a message, then returns its
+            // length. Returns zero if the peer closes the connection, an
+            // error occurs, or a receive waits longer than the timeout.
+            size_t next(const MessageComplete& complete)
+            {
+                for (;;)
+                {
+                    if (available() > 0)
+                    {
+                        if (const size_t len = complete(data(), available()); len > 0)
+                            return len < available() ? len : available();
+                    }
+                    if (_closed || receive() != OkStatus)
+                        return 0;
+                }
+            }
+
         protected:
             std::streamsize showmanyc() override
             {
-                return _end - _begin;
+                return (std::streamsize)available();
             }
 
             bool isFinished()
             {
-                if (_begin == _end)
+                if (available() == 0)
                 {
                     if (!canRead())
                         return true;
                     readMore();
                 }
-                return false;
+                return available() == 0;
             }
 
             int_type underflow() override
             {
                 if (isFinished())
                     return traits_type::eof();
-                if (_begin)
-                    return traits_type::to_int_type(*_begin);
-                return traits_type::eof();
+                return traits_type::to_int_type(_buffer.data()[_read]);
             }
 
             int_type uflow() override
             {
                 if (isFinished())
                     return traits_type::eof();
-                if (_begin && _begin + 1 <= _end)
-                    return traits_type::to_int_type(*_begin++);
-                return traits_type::eof();
+                return traits_type::to_int_type(_buffer.data()[_read++]);
             }
 
-            int_type pbackfail(int_type) override
+            // Steps back over the last byte read. A character other than
+            // eof replaces that byte, as sputbackc expects.
+            int_type pbackfail(const int_type ch) override
             {
-                if (_total > 0 && _begin)
-                {
-                    _total -= 1;
-                    --_begin;
-                    return 1;
-                }
-                return traits_type::eof();
+                if (_read == 0)
+                    return traits_type::eof();
+
+                --_read;
+                if (!traits_type::eq_int_type(ch, traits_type::eof()))
+                    _buffer.data()[_read] = traits_type::to_char_type(ch);
+                return traits_type::to_int_type(_buffer.data()[_read]);
             }
         };
 
@@ -245,6 +321,20 @@ namespace Rt2::Sockets
             _buffer.setBlockSize(size);
         }
 
+        // True once the peer has shut down its side of the connection.
+        bool isClosed() const
+        {
+            return _buffer.isClosed();
+        }
+
+        // Clears the end of message state left by copyTo or string so
+        // the next message can be streamed.
+        void resume()
+        {
+            _buffer.resume();
+            clear();
+        }
+
         String string()
         {
             String copy;
@@ -266,6 +356,55 @@ namespace Rt2::Sockets
             in.assign(buf.data(), (std::streamsize)buf.size());
         }
 
+        bool readExactly(const size_t n, String& dest)
+        {
+            return readMessage(
+                [n](const char*, const size_t size) -> size_t
+                { return size >= n ? n : 0; },
+                dest);
+        }
+
+        // Reads up to and including the delimiter. The delimiter is
+        // consumed but is not copied into dest.
+        bool readUntil(const String& delimiter, String& dest)
+        {
+            RT_GUARD_RET(!delimiter.empty(), false)
+
+            size_t scanned = 0;
+
+            const size_t len = _buffer.next(
+                [&delimiter, &scanned](const char* data, const size_t size) -> size_t
+                {
+                    const std::string_view view(data, size);
+                    if (const size_t pos = Simd::find(view, delimiter, scanned);
+                        pos != std::string_view::npos)
+                        return pos + delimiter.size();
+
+                    // only rescan the tail that could hold a partial match
+                    if (size >= delimiter.size())
+                        scanned = size - delimiter.size() + 1;
+                    return 0;
+                });
+
+            if (len == 0)
+                return false;
+            dest.assign(_buffer.data(), len - delimiter.size());
+            _buffer.consume(len);
+            return true;
+        }
+
+        bool readMessage(const MessageComplete& complete, String& dest)
+        {
+            RT_GUARD_RET(complete, false)
+
+            const size_t len = _buffer.next(complete);
+            if (len == 0)
+                return false;
+            dest.assign(_buffer.data(), len);
+            _buffer.consume(len);
+            return true;
+        }
+
         template <typename... Args>
         void get(Args&&... args)
         {
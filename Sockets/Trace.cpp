@@ -0,0 +1,260 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#include "Sockets/Trace.h"
+#include <algorithm>
+
+namespace Rt2::Sockets
+{
+    std::atomic<uint32_t> Trace::_rate{0};
+    std::atomic<uint64_t> Trace::_connections{0};
+    thread_local uint64_t Trace::_current{0};
+
+    namespace
+    {
+        static_assert((Default::TraceCapacity & (Default::TraceCapacity - 1)) == 0);
+
+        // A slot's sequence is zero while it is written and the event's
+        // position plus one after, so a reader that sees the same
+        // sequence before and after copying it has a whole event.
+        struct TraceSlot
+        {
+            std::atomic<uint64_t> sequence{0};
+            std::atomic<uint32_t> event{0};
+            std::atomic<uint64_t> connection{0};
+            std::atomic<int64_t>  begin{0};
+            std::atomic<int64_t>  duration{0};
+            std::atomic<int64_t>  bytes{0};
+        };
+
+        // Rings are owned and reused the same way as the metrics
+        // blocks: never freed, and handed to the next new thread.
+        struct TraceRing
+        {
+            TraceSlot             slots[Default::TraceCapacity];
+            std::atomic<uint64_t> head{0};
+            uint32_t              thread{0};
+            std::atomic<bool>     inUse{true};
+            TraceRing*            next{nullptr};
+        };
+
+        std::atomic<TraceRing*> Rings{nullptr};
+        std::atomic<uint32_t>   RingCount{0};
+
+        TraceRing* acquireRing()
+        {
+            for (TraceRing* ring = Rings.load(std::memory_order_acquire);
+                 ring;
+                 ring = ring->next)
+            {
+                bool expected = false;
+                if (ring->inUse.compare_exchange_strong(expected, true, std::memory_order_acquire))
+                    return ring;
+            }
+
+            const auto ring = new TraceRing();
+            ring->thread    = RingCount.fetch_add(1, std::memory_order_relaxed) + 1;
+            ring->next      = Rings.load(std::memory_order_relaxed);
+            while (!Rings.compare_exchange_weak(ring->next,
+                                                ring,
+                                                std::memory_order_release,
+                                                std::memory_order_relaxed))
+            {
+            }
+            return ring;
+        }
+
+        class RingOwner
+        {
+        private:
+            TraceRing* _ring{nullptr};
+
+        public:
+            ~RingOwner()
+            {
+                if (_ring)
+                    _ring->inUse.store(false, std::memory_order_release);
+            }
+
+            TraceRing& ring()
+            {
+                if (!_ring)
+                    _ring = acquireRing();
+                return *_ring;
+            }
+        };
+
+        thread_local RingOwner Owner;
+
+        // Chrome wants microseconds; three decimals keep nanoseconds.
+        void micros(OStream& out, const int64_t nanoseconds)
+        {
+            const int64_t frac = nanoseconds % 1000;
+            out << nanoseconds / 1000 << '.'
+                << char('0' + frac / 100)
+                << char('0' + frac / 10 % 10)
+                << char('0' + frac % 10);
+        }
+    }  // namespace
+
+    void Trace::setSampleRate(const uint32_t oneIn)
+    {
+        _rate.store(oneIn, std::memory_order_relaxed);
+    }
+
+    uint64_t Trace::sample()
+    {
+        const uint32_t rate = sampleRate();
+        if (rate == 0)
+            return 0;
+
+        const uint64_t n = _connections.fetch_add(1, std::memory_order_relaxed);
+        return n % rate == 0 ? n + 1 : 0;
+    }
+
+    void Trace::push(const TraceEvent event,
+                     const uint64_t   connection,
+                     const Tick       begin,
+                     const Tick       end,
+                     const int64_t    bytes)
+    {
+        TraceRing&     ring = Owner.ring();
+        const uint64_t n    = ring.head.load(std::memory_order_relaxed);
+        TraceSlot&     slot = ring.slots[n & (Default::TraceCapacity - 1)];
+
+        slot.sequence.store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        slot.event.store((uint32_t)event, std::memory_order_relaxed);
+        slot.connection.store(connection, std::memory_order_relaxed);
+        slot.begin.store(begin, std::memory_order_relaxed);
+        slot.duration.store(end - begin, std::memory_order_relaxed);
+        slot.bytes.store(bytes, std::memory_order_relaxed);
+
+        slot.sequence.store(n + 1, std::memory_order_release);
+        ring.head.store(n + 1, std::memory_order_release);
+    }
+
+    std::vector<TraceRecord> Trace::collect()
+    {
+        std::vector<TraceRecord> records;
+        for (const TraceRing* ring = Rings.load(std::memory_order_acquire);
+             ring;
+             ring = ring->next)
+        {
+            const uint64_t head  = ring->head.load(std::memory_order_acquire);
+            const uint64_t first = head > Default::TraceCapacity ? head - Default::TraceCapacity : 0;
+
+            for (uint64_t n = first; n < head; ++n)
+            {
+                const TraceSlot& slot = ring->slots[n & (Default::TraceCapacity - 1)];
+
+                const uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+
+                TraceRecord rec;
+                rec.event      = (TraceEvent)slot.event.load(std::memory_order_relaxed);
+                rec.thread     = ring->thread;
+                rec.connection = slot.connection.load(std::memory_order_relaxed);
+                rec.begin      = slot.begin.load(std::memory_order_relaxed);
+                rec.duration   = slot.duration.load(std::memory_order_relaxed);
+                rec.bytes      = slot.bytes.load(std::memory_order_relaxed);
+
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (sequence == n + 1 && slot.sequence.load(std::memory_order_relaxed) == sequence)
+                    records.push_back(rec);
+            }
+        }
+
+        std::sort(records.begin(),
+                  records.end(),
+                  [](const TraceRecord& a, const TraceRecord& b)
+                  { return a.begin < b.begin; });
+        return records;
+    }
+
+    void Trace::toChrome(OStream& out)
+    {
+        const std::vector<TraceRecord> records = collect();
+
+        // relative to the first event, which keeps the numbers short
+        const int64_t origin = records.empty() ? 0 : records.front().begin;
+
+        out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+        for (size_t i = 0; i < records.size(); ++i)
+        {
+            const TraceRecord& rec = records[i];
+            if (i > 0)
+                out << ',';
+
+            out << "\n{\"name\":\"" << toString(rec.event)
+                << "\",\"cat\":\"sockets\",\"ph\":\"X\",\"pid\":1,\"tid\":" << rec.thread
+                << ",\"ts\":";
+            micros(out, rec.begin - origin);
+            out << ",\"dur\":";
+            micros(out, rec.duration > 0 ? rec.duration : 0);
+            out << ",\"args\":{\"connection\":" << rec.connection;
+            if (rec.event == TraceRead || rec.event == TraceWrite)
+                out << ",\"bytes\":" << rec.bytes;
+            out << "}}";
+        }
+        out << "\n]}\n";
+    }
+
+    String Trace::toString(const TraceEvent event)
+    {
+        switch (event)
+        {
+        case TraceAccept:
+            return "accept";
+        case TraceDispatch:
+            return "dispatch";
+        case TraceHandler:
+            return "handler";
+        case TraceRead:
+            return "read";
+        case TraceWrite:
+            return "write";
+        default:
+            return "unknown";
+        }
+    }
+
+    TraceScope::TraceScope(const uint64_t connection, const Trace::Tick queued) :
+        _connection(connection)
+    {
+        if (_connection == 0)
+            return;
+
+        _begin          = Metrics::now();
+        Trace::_current = _connection;
+        Trace::record(TraceDispatch, _connection, queued, _begin);
+    }
+
+    TraceScope::~TraceScope()
+    {
+        if (_connection == 0)
+            return;
+
+        Trace::record(TraceHandler, _connection, _begin, Metrics::now());
+        Trace::_current = 0;
+    }
+
+}  // namespace Rt2::Sockets
@@ -0,0 +1,161 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#pragma once
+#include <atomic>
+#include <vector>
+#include "Sockets/Metrics.h"
+
+namespace Rt2::Sockets
+{
+    namespace Default
+    {
+        // Events kept per thread; a power of two.
+        constexpr size_t TraceCapacity = 0x1000;
+    }  // namespace Default
+
+    enum TraceEvent
+    {
+        TraceAccept,    // the listener's accept call
+        TraceDispatch,  // accept returning to the handler thread starting
+        TraceHandler,   // the handler, from start to return
+        TraceRead,      // one InputSocketStream readMore
+        TraceWrite,     // one blocking write, polls included
+        TraceMax,
+    };
+
+    struct TraceRecord
+    {
+        TraceEvent event{TraceMax};
+        uint32_t   thread{0};
+        uint64_t   connection{0};
+        int64_t    begin{0};
+        int64_t    duration{0};
+        int64_t    bytes{0};
+    };
+
+    // Per-connection tracing. One connection in every sampleRate is
+    // given an id at accept, and the thread that handles it records
+    // into its own fixed ring of Default::TraceCapacity events, so a
+    // record takes no locks and allocates nothing once the ring exists.
+    // Threads without a traced connection only test a thread local.
+    // Times are Metrics::now() nanoseconds.
+    class Trace
+    {
+    public:
+        using Tick = int64_t;
+
+    private:
+        static std::atomic<uint32_t> _rate;
+        static std::atomic<uint64_t> _connections;
+        static thread_local uint64_t _current;
+
+        friend class TraceScope;
+
+        static void push(TraceEvent event,
+                         uint64_t   connection,
+                         Tick       begin,
+                         Tick       end,
+                         int64_t    bytes);
+
+    public:
+        // Traces one connection in oneIn; zero turns tracing off.
+        static void setSampleRate(uint32_t oneIn);
+
+        static uint32_t sampleRate();
+
+        // Returns the id of a new traced connection, or zero when this
+        // one is not sampled.
+        static uint64_t sample();
+
+        // The connection traced by the calling thread, or zero.
+        static uint64_t current();
+
+        // Returns zero when the calling thread is not tracing, so the
+        // matching record call can skip the clock read.
+        static Tick start();
+
+        static void record(TraceEvent event, Tick start, int64_t bytes = 0);
+
+        static void record(TraceEvent event, uint64_t connection, Tick begin, Tick end);
+
+        // Copies every ring, oldest event first. Events overwritten
+        // while they are copied are skipped.
+        static std::vector<TraceRecord> collect();
+
+        // Writes the rings as Chrome trace_event JSON, which loads in
+        // chrome://tracing and Perfetto. A tid is a ring, which passes
+        // to the next thread when its owner exits.
+        static void toChrome(OStream& out);
+
+        static String toString(TraceEvent event);
+    };
+
+    // Marks the calling thread as handling a traced connection, and
+    // records the handler span when it goes out of scope.
+    class TraceScope
+    {
+    private:
+        uint64_t    _connection{0};
+        Trace::Tick _begin{0};
+
+    public:
+        // queued is when the connection was accepted; the time since is
+        // recorded as its dispatch.
+        TraceScope(uint64_t connection, Trace::Tick queued);
+
+        ~TraceScope();
+
+        TraceScope(const TraceScope&)            = delete;
+        TraceScope& operator=(const TraceScope&) = delete;
+    };
+
+    inline uint32_t Trace::sampleRate()
+    {
+        return _rate.load(std::memory_order_relaxed);
+    }
+
+    inline uint64_t Trace::current()
+    {
+        return _current;
+    }
+
+    inline Trace::Tick Trace::start()
+    {
+        return _current != 0 ? Metrics::now() : 0;
+    }
+
+    inline void Trace::record(const TraceEvent event, const Tick start, const int64_t bytes)
+    {
+        if (start != 0)
+            push(event, _current, start, Metrics::now(), bytes);
+    }
+
+    inline void Trace::record(const TraceEvent event,
+                              const uint64_t   connection,
+                              const Tick       begin,
+                              const Tick       end)
+    {
+        if (connection != 0)
+            push(event, connection, begin, end, 0);
+    }
+
+}  // namespace Rt2::Sockets
@@ -0,0 +1,562 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#include "Sockets/WebSocket.h"
+#include <cstring>
+#include <random>
+#include "Sockets/Simd.h"
+
+namespace Rt2::Sockets
+{
+    namespace
+    {
+        constexpr std::string_view Guid = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+
+        // FIPS 180-1; only used to answer the handshake.
+        class Sha1
+        {
+        private:
+            uint32_t _h[5]{0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+            uint8_t  _block[64]{};
+            size_t   _used{0};
+            uint64_t _total{0};
+
+            static uint32_t rol(const uint32_t v, const int n)
+            {
+                return (v << n) | (v >> (32 - n));
+            }
+
+            void process()
+            {
+                uint32_t w[80];
+                for (int i = 0; i < 16; ++i)
+                {
+                    w[i] = (uint32_t)_block[i * 4] << 24 | (uint32_t)_block[i * 4 + 1] << 16 |
+                           (uint32_t)_block[i * 4 + 2] << 8 | (uint32_t)_block[i * 4 + 3];
+                }
+                for (int i = 16; i < 80; ++i)
+                    w[i] = rol(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+
+                uint32_t a = _h[0], b = _h[1], c = _h[2], d = _h[3], e = _h[4];
+                for (int i = 0; i < 80; ++i)
+                {
+                    uint32_t f, k;
+                    if (i < 20)
+                        f = (b & c) | (~b & d), k = 0x5A827999;
+                    else if (i < 40)
+                        f = b ^ c ^ d, k = 0x6ED9EBA1;
+                    else if (i < 60)
+                        f = (b & c) | (b & d) | (c & d), k = 0x8F1BBCDC;
+                    else
+                        f = b ^ c ^ d, k = 0xCA62C1D6;
+
+                    const uint32_t t = rol(a, 5) + f + e + k + w[i];
+
+                    e = d;
+                    d = c;
+                    c = rol(b, 30);
+                    b = a;
+                    a = t;
+                }
+                _h[0] += a;
+                _h[1] += b;
+                _h[2] += c;
+                _h[3] += d;
+                _h[4] += e;
+            }
+
+        public:
+            void update(const std::string_view data)
+            {
+                for (const char ch : data)
+                {
+                    _block[_used++] = (uint8_t)ch;
+                    if (_used == 64)
+                    {
+                        process();
+                        _used = 0;
+                    }
+                }
+                _total += data.size();
+            }
+
+            void final(uint8_t dest[20])
+            {
+                const uint64_t bits = _total * 8;
+
+                _block[_used++] = 0x80;
+                if (_used > 56)
+                {
+                    memset(_block + _used, 0, 64 - _used);
+                    process();
+                    _used = 0;
+                }
+                memset(_block + _used, 0, 56 - _used);
+                for (int i = 0; i < 8; ++i)
+                    _block[56 + i] = (uint8_t)(bits >> (56 - 8 * i));
+                process();
+
+                for (int i = 0; i < 20; ++i)
+                    dest[i] = (uint8_t)(_h[i / 4] >> (24 - 8 * (i % 4)));
+            }
+        };
+
+        String base64(const uint8_t* data, const size_t size)
+        {
+            constexpr char Table[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+            String dest;
+            dest.reserve((size + 2) / 3 * 4);
+            for (size_t i = 0; i < size; i += 3)
+            {
+                uint32_t v = (uint32_t)data[i] << 16;
+                if (i + 1 < size) v |= (uint32_t)data[i + 1] << 8;
+                if (i + 2 < size) v |= (uint32_t)data[i + 2];
+
+                dest.push_back(Table[(v >> 18) & 0x3F]);
+                dest.push_back(Table[(v >> 12) & 0x3F]);
+                dest.push_back(i + 1 < size ? Table[(v >> 6) & 0x3F] : '=');
+                dest.push_back(i + 2 < size ? Table[v & 0x3F] : '=');
+            }
+            return dest;
+        }
+
+        void randomBytes(uint8_t* dest, const size_t size)
+        {
+            thread_local std::mt19937 gen{std::random_device{}()};
+            for (size_t i = 0; i < size; ++i)
+                dest[i] = (uint8_t)gen();
+        }
+
+        bool writeAll(const PlatformSocket& sock, IoVector* vec, const int count, const int timeout)
+        {
+            size_t total = 0;
+            for (int i = 0; i < count; ++i)
+                total += Net::Utils::vectorSize(vec[i]);
+            return Net::writeVector(sock, vec, count, timeout) == (int)total;
+        }
+    }  // namespace
+
+    size_t WsCodec::header(char*          dest,
+                           const WsOpcode opcode,
+                           const size_t   length,
+                           const bool     fin,
+                           const uint8_t* key)
+    {
+        const uint8_t maskBit = key ? 0x80 : 0x00;
+
+        size_t n  = 0;
+        dest[n++] = (char)((fin ? 0x80 : 0x00) | (opcode & 0x0F));
+        if (length < 126)
+            dest[n++] = (char)(maskBit | length);
+        else if (length <= 0xFFFF)
+        {
+            dest[n++] = (char)(maskBit | 126);
+            dest[n++] = (char)(length >> 8);
+            dest[n++] = (char)length;
+        }
+        else
+        {
+            dest[n++] = (char)(maskBit | 127);
+            for (int i = 7; i >= 0; --i)
+                dest[n++] = (char)((uint64_t)length >> (8 * i));
+        }
+        if (key)
+        {
+            memcpy(dest + n, key, 4);
+            n += 4;
+        }
+        return n;
+    }
+
+    void WsCodec::encode(String& dest, const WsOpcode opcode, const std::string_view payload, const bool fin)
+    {
+        char         head[Default::WsMaxHeader];
+        const size_t n = header(head, opcode, payload.size(), fin);
+        dest.reserve(dest.size() + n + payload.size());
+        dest.append(head, n);
+        dest.append(payload);
+    }
+
+    WsDecodeStatus WsCodec::decode(char*        data,
+                                   const size_t size,
+                                   WsFrame&     dest,
+                                   size_t&      consumed,
+                                   const bool   fromClient,
+                                   const size_t maxPayload)
+    {
+        consumed = 0;
+        if (size < 2)
+            return WsIncomplete;
+
+        const auto b0 = (uint8_t)data[0];
+        const auto b1 = (uint8_t)data[1];
+
+        // no extension is negotiated, so the reserved bits stay clear
+        if (b0 & 0x70)
+            return WsProtocolError;
+
+        const auto opcode = (WsOpcode)(b0 & 0x0F);
+        switch (opcode)
+        {
+        case WsContinuation:
+        case WsText:
+        case WsBinary:
+        case WsClose:
+        case WsPing:
+        case WsPong:
+            break;
+        default:
+            return WsProtocolError;
+        }
+
+        const bool fin    = (b0 & 0x80) != 0;
+        const bool masked = (b1 & 0x80) != 0;
+        if (masked != fromClient)
+            return WsProtocolError;
+
+        uint64_t length = b1 & 0x7F;
+        size_t   n      = 2;
+        if (length == 126)
+        {
+            if (size < 4)
+                return WsIncomplete;
+            length = (uint64_t)(uint8_t)data[2] << 8 | (uint8_t)data[3];
+            n      = 4;
+        }
+        else if (length == 127)
+        {
+            if (size < 10)
+                return WsIncomplete;
+            length = 0;
+            for (size_t i = 2; i < 10; ++i)
+                length = length << 8 | (uint8_t)data[i];
+            if (length >> 63)
+                return WsProtocolError;
+            n = 10;
+        }
+
+        if (opcode >= WsClose && (!fin || length > 125))
+            return WsProtocolError;
+        if (length > maxPayload)
+            return WsTooLarge;
+
+        const uint8_t* key = nullptr;
+        if (masked)
+        {
+            if (size < n + 4)
+                return WsIncomplete;
+            key = (const uint8_t*)data + n;
+            n += 4;
+        }
+
+        if (size - n < length)
+            return WsIncomplete;
+
+        char* payload = data + n;
+        if (key)
+            Simd::mask(payload, (size_t)length, key);
+
+        dest.opcode  = opcode;
+        dest.fin     = fin;
+        dest.payload = {payload, (size_t)length};
+        consumed     = n + (size_t)length;
+        return WsComplete;
+    }
+
+    WebSocket::WebSocket(const PlatformSocket& sock, RecvBuffer& buffer, const bool client) :
+        _sock(sock),
+        _buffer(buffer),
+        _client(client)
+    {
+    }
+
+    Status WebSocket::writeFrame(const WsOpcode opcode, const std::string_view payload, const bool fin)
+    {
+        std::lock_guard guard(_write);
+        if (_closeSent)
+            return ClosedStatus;
+
+        char head[Default::WsMaxHeader];
+
+        bool ok;
+        if (_client)
+        {
+            // client frames are masked, which needs a private copy
+            uint8_t key[4];
+            randomBytes(key, 4);
+
+            const size_t hn = WsCodec::header(head, opcode, payload.size(), fin, key);
+
+            String frame(head, hn);
+            frame.append(payload);
+            Simd::mask(frame.data() + hn, payload.size(), key);
+
+            IoVector vec[1];
+            Net::Utils::makeVector(vec[0], frame.data(), frame.size());
+            ok = writeAll(_sock, vec, 1, _sendTimeout);
+        }
+        else
+        {
+            const size_t hn = WsCodec::header(head, opcode, payload.size(), fin);
+
+            IoVector vec[2];
+            int      count = 0;
+            Net::Utils::makeVector(vec[count++], head, hn);
+            if (!payload.empty())
+                Net::Utils::makeVector(vec[count++], payload.data(), payload.size());
+            ok = writeAll(_sock, vec, count, _sendTimeout);
+        }
+
+        if (opcode == WsClose)
+            _closeSent = true;
+        if (!ok)
+        {
+            // a partial frame leaves the stream unusable
+            _closed = true;
+            return ErrorStatus;
+        }
+        return OkStatus;
+    }
+
+    Status WebSocket::fail(const WsCloseCode code)
+    {
+        close(code);
+        _closed = true;
+        return ErrorStatus;
+    }
+
+    Status WebSocket::read(WsMessage& dest, const int timeout)
+    {
+        for (;;)
+        {
+            if (_closed)
+                return ClosedStatus;
+
+            WsFrame              frame;
+            size_t               used = 0;
+            const WsDecodeStatus ds   = WsCodec::decode(_buffer.data(),
+                                                      _buffer.size(),
+                                                      frame,
+                                                      used,
+                                                      !_client,
+                                                      _maxMessage);
+            if (ds == WsIncomplete)
+            {
+                const Status st = _buffer.fill(_sock, timeout);
+                if (st == ClosedStatus)
+                    _closed = true;
+                if (st != OkStatus)
+                    return st;
+                continue;
+            }
+            if (ds == WsProtocolError)
+                return fail(WsCloseProtocol);
+            if (ds == WsTooLarge)
+                return fail(WsCloseTooBig);
+
+            // the payload stays in place until the next fill
+            _buffer.consume(used);
+
+            switch (frame.opcode)
+            {
+            case WsPing:
+                writeFrame(WsPong, frame.payload, true);
+                break;
+            case WsPong:
+                break;
+            case WsClose:
+                if (!_closeSent)
+                    writeFrame(WsClose, frame.payload.substr(0, 2), true);
+                _closed = true;
+                return ClosedStatus;
+            case WsContinuation:
+                if (!_fragmented)
+                    return fail(WsCloseProtocol);
+                if (_message.size() + frame.payload.size() > _maxMessage)
+                    return fail(WsCloseTooBig);
+
+                _message.append(frame.payload);
+                if (frame.fin)
+                {
+                    _fragmented = false;
+                    dest        = {_messageType, _message};
+                    return OkStatus;
+                }
+                break;
+            default:
+                if (_fragmented)
+                    return fail(WsCloseProtocol);
+                if (frame.fin)
+                {
+                    dest = {frame.opcode, frame.payload};
+                    return OkStatus;
+                }
+                _fragmented  = true;
+                _messageType = frame.opcode;
+                _message.assign(frame.payload);
+                break;
+            }
+        }
+    }
+
+    Status WebSocket::send(const std::string_view payload, const WsOpcode opcode)
+    {
+        std::lock_guard guard(_sending);
+
+        if (payload.size() <= Default::WsFragmentSize)
+            return writeFrame(opcode, payload, true);
+
+        WsOpcode op = opcode;
+        for (size_t offs = 0; offs < payload.size(); offs += Default::WsFragmentSize)
+        {
+            const std::string_view part = payload.substr(offs, Default::WsFragmentSize);
+            if (const Status st = writeFrame(op, part, offs + part.size() == payload.size()); st != OkStatus)
+                return st;
+            op = WsContinuation;
+        }
+        return OkStatus;
+    }
+
+    Status WebSocket::sendEncoded(const std::string_view frame)
+    {
+        // encoded frames are unmasked, which only a server may send
+        RT_GUARD_RET(!_client && !frame.empty(), ErrorStatus)
+
+        std::lock_guard sending(_sending);
+        std::lock_guard guard(_write);
+        if (_closeSent || _closed)
+            return ClosedStatus;
+
+        IoVector vec[1];
+        Net::Utils::makeVector(vec[0], frame.data(), frame.size());
+        if (!writeAll(_sock, vec, 1, _sendTimeout))
+        {
+            _closed = true;
+            return ErrorStatus;
+        }
+        return OkStatus;
+    }
+
+    Status WebSocket::ping(const std::string_view payload)
+    {
+        RT_GUARD_RET(payload.size() <= 125, ErrorStatus)
+        return writeFrame(WsPing, payload, true);
+    }
+
+    Status WebSocket::close(const WsCloseCode code)
+    {
+        const char payload[2] = {(char)(code >> 8), (char)code};
+        return writeFrame(WsClose, {payload, 2}, true);
+    }
+
+    String WebSocket::acceptKey(const std::string_view key)
+    {
+        Sha1 sha;
+        sha.update(key);
+        sha.update(Guid);
+
+        uint8_t digest[20];
+        sha.final(digest);
+        return base64(digest, 20);
+    }
+
+    bool WebSocket::upgrade(const HttpRequest&                             request,
+                            HttpResponse&                                  response,
+                            const std::function<void(WebSocket& session)>& session)
+    {
+        const std::string_view key = request.header("Sec-WebSocket-Key");
+        if (request.method != "GET" ||
+            !HttpParser::hasToken(request.header("Upgrade"), "websocket") ||
+            !HttpParser::hasToken(request.header("Connection"), "upgrade") ||
+            key.empty())
+        {
+            response.setStatus(400);
+            return false;
+        }
+
+        if (request.header("Sec-WebSocket-Version") != "13")
+        {
+            response.setStatus(426);
+            response.setHeader("Sec-WebSocket-Version", "13");
+            return false;
+        }
+
+        response.setHeader("Upgrade", "websocket");
+        response.setHeader("Connection", "Upgrade");
+        response.setHeader("Sec-WebSocket-Accept", acceptKey(key));
+        response.upgrade(
+            [session](const PlatformSocket& sock, RecvBuffer& buffer)
+            {
+                WebSocket ws(sock, buffer, false);
+                if (session)
+                    session(ws);
+            });
+        return true;
+    }
+
+    Status WebSocketClient::connect(const String&       ipv4,
+                                    const uint16_t      port,
+                                    const String&       target,
+                                    const SocketConfig& config)
+    {
+        _session.reset();
+        _buffer.clear();
+
+        _socket.open(ipv4, port, config);
+        if (!_socket.isValid())
+            return ErrorStatus;
+
+        uint8_t nonce[16];
+        randomBytes(nonce, sizeof nonce);
+        const String key = base64(nonce, sizeof nonce);
+
+        OutputStringStream oss;
+        oss << "GET " << target << " HTTP/1.1\r\n"
+            << "Host: " << ipv4 << ':' << port << "\r\n"
+            << "Upgrade: websocket\r\n"
+            << "Connection: Upgrade\r\n"
+            << "Sec-WebSocket-Key: " << key << "\r\n"
+            << "Sec-WebSocket-Version: 13\r\n"
+            << "\r\n";
+
+        const String request = oss.str();
+        if (Net::writeSocket(_socket.socket(), request.data(), request.size()) != (int)request.size())
+            return ErrorStatus;
+
+        std::string_view head;
+        if (const Status st = _buffer.readUntil(_socket.socket(), "\r\n\r\n", head); st != OkStatus)
+            return st;
+
+        String raw(head);
+        raw.append("\r\n\r\n");
+
+        HttpResponseHead reply;
+        if (HttpParser::parseResponse(raw, reply) != HttpComplete ||
+            reply.status != 101 ||
+            reply.header("Sec-WebSocket-Accept") != WebSocket::acceptKey(key))
+            return ErrorStatus;
+
+        _session = std::make_unique<WebSocket>(_socket.socket(), _buffer, true);
+        return OkStatus;
+    }
+
+}  // namespace Rt2::Sockets
@@ -0,0 +1,217 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#pragma once
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include "Sockets/ClientSocket.h"
+#include "Sockets/HttpServer.h"
+#include "Sockets/RecvBuffer.h"
+
+namespace Rt2::Sockets
+{
+    namespace Default
+    {
+        constexpr size_t WsMaxMessage   = 0x100000;
+        constexpr size_t WsFragmentSize = 0x10000;
+        constexpr size_t WsMaxHeader    = 14;
+    }  // namespace Default
+
+    enum WsOpcode
+    {
+        WsContinuation = 0x0,
+        WsText         = 0x1,
+        WsBinary       = 0x2,
+        WsClose        = 0x8,
+        WsPing         = 0x9,
+        WsPong         = 0xA,
+    };
+
+    enum WsCloseCode
+    {
+        WsCloseNormal      = 1000,
+        WsCloseGoingAway   = 1001,
+        WsCloseProtocol    = 1002,
+        WsCloseUnsupported = 1003,
+        WsCloseTooBig      = 1009,
+    };
+
+    enum WsDecodeStatus
+    {
+        WsIncomplete,
+        WsComplete,
+        WsProtocolError,
+        WsTooLarge,
+    };
+
+    struct WsFrame
+    {
+        WsOpcode         opcode{WsContinuation};
+        bool             fin{true};
+        std::string_view payload;
+    };
+
+    // A complete data message. The view is valid until the next read.
+    struct WsMessage
+    {
+        WsOpcode         opcode{WsText};
+        std::string_view data;
+    };
+
+    // RFC 6455 framing without extensions.
+    class WsCodec
+    {
+    public:
+        // Writes a frame header into dest, which must hold at least
+        // Default::WsMaxHeader bytes, and returns its length. A non null
+        // key marks the frame as masked.
+        static size_t header(char*          dest,
+                             WsOpcode       opcode,
+                             size_t         length,
+                             bool           fin = true,
+                             const uint8_t* key = nullptr);
+
+        // Appends a complete unmasked frame. The result can be written
+        // to any number of connections as is.
+        static void encode(String& dest, WsOpcode opcode, std::string_view payload, bool fin = true);
+
+        // Decodes the frame at the front of the buffer and unmasks its
+        // payload in place. Frames from clients must be masked, frames
+        // from servers must not be.
+        static WsDecodeStatus decode(char*    data,
+                                     size_t   size,
+                                     WsFrame& dest,
+                                     size_t&  consumed,
+                                     bool     fromClient,
+                                     size_t   maxPayload = Default::WsMaxMessage);
+    };
+
+    // One end of an open WebSocket connection. Reading is meant for a
+    // single thread; sending is safe from any thread, so replies to
+    // pings and messages from a publisher can share the connection.
+    class WebSocket
+    {
+    private:
+        PlatformSocket    _sock{InvalidSocket};
+        RecvBuffer&       _buffer;
+        const bool        _client;
+        String            _message;
+        WsOpcode          _messageType{WsText};
+        bool              _fragmented{false};
+        std::atomic<bool> _closeSent{false};
+        std::atomic<bool> _closed{false};
+        size_t            _maxMessage{Default::WsMaxMessage};
+        int               _sendTimeout{Default::SocketTimeOut};
+        std::mutex        _sending;
+        std::mutex        _write;
+
+        Status writeFrame(WsOpcode opcode, std::string_view payload, bool fin);
+
+        Status fail(WsCloseCode code);
+
+    public:
+        WebSocket(const PlatformSocket& sock, RecvBuffer& buffer, bool client);
+
+        WebSocket(const WebSocket&)            = delete;
+        WebSocket& operator=(const WebSocket&) = delete;
+
+        // Reads the next data message. Pings are answered and a close
+        // is echoed along the way; ClosedStatus ends the session.
+        Status read(WsMessage& dest, int timeout = Default::SocketTimeOut);
+
+        // Sends a message, split into Default::WsFragmentSize frames so
+        // control frames can be interleaved with a large one.
+        Status send(std::string_view payload, WsOpcode opcode = WsText);
+
+        // Writes a frame made by WsCodec::encode. A write that cannot
+        // finish in time leaves the stream unusable, so it closes the
+        // connection.
+        Status sendEncoded(std::string_view frame);
+
+        Status ping(std::string_view payload = {});
+
+        Status close(WsCloseCode code = WsCloseNormal);
+
+        bool isOpen() const;
+
+        void setMaxMessage(size_t bytes);
+
+        void setSendTimeout(int ms);
+
+        // The Sec-WebSocket-Accept value for a Sec-WebSocket-Key.
+        static String acceptKey(std::string_view key);
+
+        // Validates an upgrade request and, when it is one, turns the
+        // response into the 101 that hands the connection to session.
+        static bool upgrade(const HttpRequest&                             request,
+                            HttpResponse&                                  response,
+                            const std::function<void(WebSocket& session)>& session);
+    };
+
+    // Client side connection: opens the socket, runs the handshake and
+    // owns the buffer the session reads from.
+    class WebSocketClient
+    {
+    private:
+        ClientSocket               _socket;
+        RecvBuffer                 _buffer;
+        std::unique_ptr<WebSocket> _session;
+
+    public:
+        WebSocketClient() = default;
+
+        Status connect(const String&       ipv4,
+                       uint16_t            port,
+                       const String&       target = "/",
+                       const SocketConfig& config = {});
+
+        bool isOpen() const;
+
+        WebSocket& session() const;
+    };
+
+    inline bool WebSocket::isOpen() const
+    {
+        return !_closed && _sock != InvalidSocket;
+    }
+
+    inline void WebSocket::setMaxMessage(const size_t bytes)
+    {
+        _maxMessage = bytes;
+    }
+
+    inline void WebSocket::setSendTimeout(const int ms)
+    {
+        _sendTimeout = ms;
+    }
+
+    inline bool WebSocketClient::isOpen() const
+    {
+        return _session && _session->isOpen();
+    }
+
+    inline WebSocket& WebSocketClient::session() const
+    {
+        return *_session;
+    }
+
+}  // namespace Rt2::Sockets
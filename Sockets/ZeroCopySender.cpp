@@ -0,0 +1,203 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#include "Sockets/ZeroCopySender.h"
+#include <algorithm>
+#include <chrono>
+
+namespace Rt2::Sockets
+{
+    namespace
+    {
+        using Clock = std::chrono::steady_clock;
+
+        // Completion ids are 32 bit and wrap, so ordering is by distance.
+        bool before(const uint32_t a, const uint32_t b)
+        {
+            return (int32_t)(a - b) < 0;
+        }
+
+        int remaining(const Clock::time_point& end)
+        {
+            const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+                end - Clock::now());
+            return std::max(0, (int)left.count());
+        }
+    }  // namespace
+
+    ZeroCopySender::ZeroCopySender(const PlatformSocket& sock,
+                                   const size_t          threshold,
+                                   BufferPool&           pool) :
+        _sock(sock),
+        _pool(pool),
+        _threshold(threshold)
+    {
+        if (Net::isZeroCopySupported() && sock != InvalidSocket)
+            _enabled = Net::setOption(_sock, ZeroCopy, true) == OkStatus;
+    }
+
+    ZeroCopySender::~ZeroCopySender()
+    {
+        flush();
+
+        // whatever is left belongs to a connection that is going away
+        for (Pending& p : _pending)
+            _pool.release(p.block);
+        _pending.clear();
+    }
+
+    PoolBlock ZeroCopySender::acquire(const size_t size) const
+    {
+        return _pool.acquire(size);
+    }
+
+    Status ZeroCopySender::copy(PoolBlock& block, const size_t size, const int timeout)
+    {
+        const int sent = Net::writeSocket(_sock, block.data, size, timeout);
+        _pool.release(block);
+        ++_copied;
+        return sent == (int)size ? OkStatus : ErrorStatus;
+    }
+
+    Status ZeroCopySender::send(PoolBlock& block, const size_t size, const int timeout)
+    {
+        RT_GUARD_CHECK_RET(block.data && size <= block.capacity, ErrorStatus)
+
+        if (!_enabled || size < _threshold)
+            return copy(block, size, timeout);
+
+        const auto end = Clock::now() + std::chrono::milliseconds(timeout);
+
+        Pending entry{block, 0};
+        block = {};
+
+        bool   issued = false;
+        size_t offs   = 0;
+        Status status = OkStatus;
+        while (offs < size)
+        {
+            int sent = 0;
+            status   = Net::sendZeroCopy(_sock, entry.block.data + offs, size - offs, sent);
+            if (status == OkStatus)
+            {
+                // each accepted call takes the next completion id
+                entry.last = _next++;
+                issued     = true;
+                offs += (size_t)sent;
+                continue;
+            }
+            if (status == ErrorStatus)
+                break;
+
+            // completions free pinned pages as well as pooled blocks
+            reap();
+
+            const int left = remaining(end);
+            if (left <= 0)
+                break;
+            Net::poll(_sock, std::min(left, Default::SocketTimeOut), Write);
+        }
+
+        if (issued)
+        {
+            _pending.push_back(entry);
+            ++_zeroCopied;
+        }
+        else
+            _pool.release(entry.block);
+
+        reap();
+        return offs == size ? OkStatus : status == OkStatus ? TimeoutStatus : status;
+    }
+
+    void ZeroCopySender::complete(const ZeroCopyCompletion& completion)
+    {
+        if (completion.copied)
+            _deferred += completion.last - completion.first + 1;
+
+        if (before(_done, completion.first))
+        {
+            // TCP reports in order; anything else waits for the gap
+            _early.emplace_back(completion.first, completion.last);
+            return;
+        }
+
+        if (!before(completion.last, _done))
+            _done = completion.last + 1;
+
+        bool merged = true;
+        while (merged)
+        {
+            merged = false;
+            for (auto it = _early.begin(); it != _early.end(); ++it)
+            {
+                if (!before(_done, it->first))
+                {
+                    if (!before(it->second, _done))
+                        _done = it->second + 1;
+                    _early.erase(it);
+                    merged = true;
+                    break;
+                }
+            }
+        }
+    }
+
+    void ZeroCopySender::releaseCompleted()
+    {
+        while (!_pending.empty() && before(_pending.front().last, _done))
+        {
+            _pool.release(_pending.front().block);
+            _pending.pop_front();
+        }
+    }
+
+    size_t ZeroCopySender::reap()
+    {
+        RT_GUARD_RET(!_pending.empty(), 0)
+
+        const size_t       count = _pending.size();
+        ZeroCopyCompletion completion;
+        while (Net::readCompletion(_sock, completion, 0) == OkStatus)
+            complete(completion);
+
+        releaseCompleted();
+        return count - _pending.size();
+    }
+
+    Status ZeroCopySender::flush(const int timeout)
+    {
+        const auto end = Clock::now() + std::chrono::milliseconds(timeout);
+
+        ZeroCopyCompletion completion;
+        while (!_pending.empty())
+        {
+            const Status st = Net::readCompletion(_sock, completion, remaining(end));
+            if (st != OkStatus)
+                return st;
+
+            complete(completion);
+            releaseCompleted();
+        }
+        return OkStatus;
+    }
+
+}  // namespace Rt2::Sockets
@@ -0,0 +1,145 @@
+/*
+-------------------------------------------------------------------------------
+    Copyright (c) Charles Carley.
+
+  This software is provided 'as-is', without any express or implied
+  warranty. In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+-------------------------------------------------------------------------------
+*/
+#pragma once
+#include <deque>
+#include <utility>
+#include <vector>
+#include "Sockets/BufferPool.h"
+#include "Sockets/PlatformSocket.h"
+
+namespace Rt2::Sockets
+{
+    namespace Default
+    {
+        constexpr size_t ZeroCopyThreshold = 0x8000;
+    }  // namespace Default
+
+    // Sends pooled blocks with MSG_ZEROCOPY. The kernel reads straight
+    // from the block, so it stays with the sender until the matching
+    // completion arrives on the error queue, and only then goes back to
+    // the pool. Payloads under the threshold, and every payload where
+    // zero copy is unavailable, are copied by a plain send and released
+    // at once; pinning pages costs more than copying a small buffer.
+    //
+    // Not thread-safe; one sender per socket.
+    class ZeroCopySender
+    {
+    private:
+        struct Pending
+        {
+            PoolBlock block;
+            uint32_t  last{0};
+        };
+
+        using Range = std::pair<uint32_t, uint32_t>;
+
+        PlatformSocket      _sock{InvalidSocket};
+        BufferPool&         _pool;
+        size_t              _threshold;
+        bool                _enabled{false};
+        std::deque<Pending> _pending;
+        std::vector<Range>  _early;
+        uint32_t            _next{0};
+        uint32_t            _done{0};
+        uint64_t            _zeroCopied{0};
+        uint64_t            _deferred{0};
+        uint64_t            _copied{0};
+
+        void complete(const ZeroCopyCompletion& completion);
+
+        void releaseCompleted();
+
+        Status copy(PoolBlock& block, size_t size, int timeout);
+
+    public:
+        explicit ZeroCopySender(const PlatformSocket& sock,
+                                size_t                threshold = Default::ZeroCopyThreshold,
+                                BufferPool&           pool      = BufferPool::global());
+
+        // Waits up to the socket timeout for outstanding completions.
+        ~ZeroCopySender();
+
+        ZeroCopySender(const ZeroCopySender&)            = delete;
+        ZeroCopySender& operator=(const ZeroCopySender&) = delete;
+
+        PoolBlock acquire(size_t size) const;
+
+        // Sends size bytes of the block and takes ownership of it; the
+        // block is left empty. Waits for write readiness up to timeout
+        // milliseconds while the send buffer is full.
+        Status send(PoolBlock& block, size_t size, int timeout = Default::SocketTimeOut);
+
+        // Releases every block the kernel has finished with, without
+        // waiting. Returns the number released.
+        size_t reap();
+
+        // Waits until every block has been released.
+        Status flush(int timeout = Default::SocketTimeOut);
+
+        void setThreshold(size_t bytes);
+
+        bool isEnabled() const;
+
+        size_t pending() const;
+
+        // Payloads sent with MSG_ZEROCOPY.
+        uint64_t zeroCopied() const;
+
+        // Zero-copy send calls the kernel copied anyway. A payload can
+        // take more than one call when the send buffer fills.
+        uint64_t deferredCopies() const;
+
+        // Payloads sent by plain copy.
+        uint64_t copied() const;
+    };
+
+    inline void ZeroCopySender::setThreshold(const size_t bytes)
+    {
+        _threshold = bytes;
+    }
+
+    inline bool ZeroCopySender::isEnabled() const
+    {
+        return _enabled;
+    }
+
+    inline size_t ZeroCopySender::pending() const
+    {
+        return _pending.size();
+    }
+
+    inline uint64_t ZeroCopySender::zeroCopied() const
+    {
+        return _zeroCopied;
+    }
+
+    inline uint64_t ZeroCopySender::deferredCopies() const
+    {
+        return _deferred;
+    }
+
+    inline uint64_t ZeroCopySender::copied() const
+    {
+        return _copied;
+    }
+
+}  // namespace Rt2::Sockets